@@ -0,0 +1,158 @@
+// Arrow files to check against an independent reader: each case is written
+// both with ArrowExporter and with CsvExporter, and check_arrow.py reads the
+// .arrow files with pyarrow, validates them in full and compares every
+// column with the CSV of the same records.
+//
+//   ArrowFixture [--output-dir dir]
+//   python3 bench/check_arrow.py dir
+//
+// Cases: a store with no records and no vocabulary (empty dictionaries,
+// zero batches), a few hand-written records with missing values and
+// non-ASCII text, and enough synthetic records for several batches.
+
+#include "ArrowExporter.hpp"
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr int kManyRecords = 150000; // Three batches of the exporter
+
+RecordStore::Vocabulary vocabulary() {
+    RecordStore::Vocabulary v;
+    v.roles = {"Focal", "Acompañante"};
+    v.behaviours = {"Salto", "Respiración", "Golpe de cola", "Nado en superficie"};
+    v.parentBehaviours = {"Aéreo", "Superficie"};
+    v.groupTypes = {"Madre-cría", "Grupo competitivo"};
+    v.sexes = {"Macho", "Hembra", "Indefinido"};
+    v.stages = {"Adulto", "Cría"};
+    return v;
+}
+
+BehaviorRecord event(double time, const QString& behaviour) {
+    BehaviorRecord r;
+    r.session = 1;
+    r.behaviour = behaviour;
+    r.startTime = time;
+    r.startFrame = static_cast<int>(time * 30.0);
+    r.recordType = "EVENT";
+    return r;
+}
+
+RecordStore handWritten(const RecordStore::Vocabulary& v) {
+    RecordStore store(v);
+
+    BehaviorRecord r = event(1.25, "Salto");
+    r.role = "Focal";
+    r.parentBehaviour = "Aéreo";
+    r.tag = "Ñandú-07";
+    r.groupType = "Madre-cría";
+    r.sex = "Hembra";
+    r.stage = "Adulto";
+    r.groupSize = 2;
+    r.motherAndCalf = 1;
+    r.calves = 1;
+    r.observations = "Observación con coma, \"comillas\"\ny segunda línea";
+    store.append(r);
+
+    // Nothing but the required fields: every optional column is null
+    r = event(2.5, "Respiración");
+    r.startFrame.reset();
+    store.append(r);
+
+    // A state, with characters outside the Basic Multilingual Plane
+    r = event(3.0, "Nado en superficie");
+    r.recordType = "STATE";
+    r.endTime = 12.5;
+    r.endFrame = 375;
+    r.duration = 9.5;
+    r.parentBehaviour = "Superficie";
+    r.tag = "🐋 ballena";
+    r.observations = "日本語 🐳";
+    r.groupSize = 0;
+    store.append(r);
+
+    // Values that are not in the vocabulary
+    r = event(4.0, "Espionaje");
+    r.session = 2;
+    r.role = "Observador";
+    r.sex = "Desconocido";
+    r.calves = -1;
+    store.append(r);
+    return store;
+}
+
+RecordStore synthetic(const RecordStore::Vocabulary& v) {
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto pick = [&random, &unit](const QStringList& values) -> QString {
+        // One field in five is left empty
+        if (unit(random) < 0.2) return QString();
+        return values[std::uniform_int_distribution<int>(0, values.size() - 1)(random)];
+    };
+
+    RecordStore store(v);
+    store.reserve(kManyRecords);
+    double time = 0.0;
+    for (int i = 0; i < kManyRecords; ++i) {
+        time += 0.5 + 4.0 * unit(random);
+        BehaviorRecord r = event(time, v.behaviours[i % v.behaviours.size()]);
+        r.session = 1 + i / 50000;
+        r.role = pick(v.roles);
+        r.parentBehaviour = pick(v.parentBehaviours);
+        r.groupType = pick(v.groupTypes);
+        r.sex = pick(v.sexes);
+        r.stage = pick(v.stages);
+        if (unit(random) < 0.5) r.tag = QString("T%1").arg(static_cast<int>(unit(random) * 500));
+        if (unit(random) < 0.7) r.groupSize = 1 + static_cast<int>(unit(random) * 8);
+        if (unit(random) < 0.2) {
+            r.recordType = "STATE";
+            r.endTime = time + 1.0 + 20.0 * unit(random);
+            r.endFrame = static_cast<int>(*r.endTime * 30.0);
+            r.duration = *r.endTime - r.startTime;
+        }
+        if (unit(random) < 0.03) r.observations = "Observación libre";
+        store.append(r);
+    }
+    return store;
+}
+
+bool write(const QDir& dir, const char* name, const RecordStore& records) {
+    const QString base = dir.filePath(QString::fromUtf8(name));
+    if (!ArrowExporter::exportRecords(base + ".arrow", records)
+        || !CsvExporter::exportRecords(base + ".csv", records)) {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(base));
+        return false;
+    }
+    std::printf("  %-8s %7d records  %s.arrow\n", name, records.size(), qPrintable(base));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QString outputDir = QDir(QDir::tempPath()).filePath("ethowild_arrow_fixture");
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            outputDir = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--output-dir dir]\n", argv[0]);
+            return 1;
+        }
+    }
+    QDir dir(outputDir);
+    dir.mkpath(".");
+
+    const RecordStore::Vocabulary v = vocabulary();
+    const bool ok = write(dir, "empty", RecordStore())
+        && write(dir, "records", handWritten(v))
+        && write(dir, "batches", synthetic(v));
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// Synthetic labels shared by the benches: a vocabulary the size of a real
+// behaviors.json and records shaped like real sessions (a label every 0.5 to
+// 4.5 s, one in five a state, a few with observations, some of those quoted
+// or on two lines).
+
+#include "RecordStore.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <chrono>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+inline QStringList numbered(const char* prefix, int count) {
+    QStringList values;
+    for (int i = 0; i < count; ++i) values << QString("%1 %2").arg(QString::fromUtf8(prefix)).arg(i);
+    return values;
+}
+
+inline RecordStore::Vocabulary vocabulary() {
+    RecordStore::Vocabulary v;
+    v.roles = numbered("Rol", 6);
+    v.behaviours = numbered("Comportamiento de prueba", 45);
+    v.parentBehaviours = numbered("Categoría", 4);
+    v.groupTypes = numbered("Grupo", 5);
+    v.sexes = {"Macho", "Hembra", "Indefinido"};
+    v.stages = numbered("Estadio", 4);
+    return v;
+}
+
+struct RecordShape {
+    unsigned seed = 7;              // Same seed, same records
+    int sessionRecords = 50000;     // Records per session
+    int tags = 40;                  // Distinct tags, T0 to T<tags - 1>
+};
+
+// Calls sink(const BehaviorRecord&) for each record; strings are shared with
+// the vocabulary
+template <typename Sink>
+void generateRecords(int count, const RecordStore::Vocabulary& v, const RecordShape& shape, Sink&& sink) {
+    std::mt19937 random(shape.seed);
+    auto pick = [&random](const QStringList& values) -> const QString& {
+        return values[std::uniform_int_distribution<int>(0, values.size() - 1)(random)];
+    };
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    double time = 0.0;
+    BehaviorRecord r;
+    for (int i = 0; i < count; ++i) {
+        time += 0.5 + 4.0 * unit(random);
+        r.session = 1 + i / shape.sessionRecords;
+        r.role = pick(v.roles);
+        r.behaviour = pick(v.behaviours);
+        r.parentBehaviour = pick(v.parentBehaviours);
+        r.startTime = time;
+        r.startFrame = static_cast<int>(time * 30.0);
+        r.tag = QString("T%1").arg(static_cast<int>(unit(random) * shape.tags));
+        r.groupType = pick(v.groupTypes);
+        r.sex = pick(v.sexes);
+        r.stage = pick(v.stages);
+        r.groupSize = 1 + static_cast<int>(unit(random) * 8);
+        if (unit(random) < 0.2) {
+            r.recordType = "STATE";
+            r.endTime = time + 1.0 + 20.0 * unit(random);
+            r.endFrame = static_cast<int>(*r.endTime * 30.0);
+            r.duration = *r.endTime - r.startTime;
+        } else {
+            r.recordType = "EVENT";
+            r.endTime.reset();
+            r.endFrame.reset();
+            r.duration = 0.0;
+        }
+        const double note = unit(random);
+        if (note < 0.03) {
+            r.observations = "Observación libre, con coma";
+        } else if (note < 0.04) {
+            r.observations = "Dijo \"otra vez\"\nsegunda línea";
+        } else {
+            r.observations.clear();
+        }
+        sink(r);
+    }
+}
+
+inline RecordStore makeRecords(int count, const RecordStore::Vocabulary& v, const RecordShape& shape = RecordShape()) {
+    RecordStore store(v);
+    store.reserve(count);
+    generateRecords(count, v, shape, [&store](const BehaviorRecord& r) { store.append(r); });
+    return store;
+}
@@ -0,0 +1,162 @@
+// CSV export speed of the buffered writer against the QTextStream exporter
+// it replaced, on the same records and with byte-identical output, and of
+// the Arrow (Feather) export for comparison.
+//
+//   CsvExportBench [--records N]... [--output-dir dir]
+//
+// Without --records, 1M and 10M records are written. Records are synthetic
+// and shaped like real sessions (see BenchRecords.hpp); they are held in a
+// RecordStore so ten million fit in memory. The old exporter is reproduced
+// here as it was: a BehaviorRecord per row and QString formatting per field.
+
+#include "ArrowExporter.hpp"
+#include "BenchRecords.hpp"
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// The exporter before the buffered writer
+bool exportWithTextStream(const QString& filePath, const RecordStore& records) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "session,role,behaviour,parent_behaviour,start_time,end_time,"
+        << "duration,record_type,tag,group_type,sex,observations,stage,"
+        << "group_size,mother_and_calf,calves,start_time_str,end_time_str,"
+        << "start_frame,end_frame,start_pts,end_pts\n";
+
+    for (const RecordStore::Row& row : records) {
+        const BehaviorRecord r = row.toRecord();
+        auto escapeField = [](const QString& s) -> QString {
+            if (s.contains(',') || s.contains('"') || s.contains('\n')) {
+                QString escaped = s;
+                escaped.replace("\"", "\"\"");
+                return "\"" + escaped + "\"";
+            }
+            return s;
+        };
+        auto optIntToStr = [](const std::optional<int>& opt) -> QString {
+            return opt.has_value() ? QString::number(opt.value()) : "";
+        };
+        auto optDoubleToStr = [](const std::optional<double>& opt) -> QString {
+            return opt.has_value() ? QString::number(opt.value(), 'f', 3) : "";
+        };
+
+        out << r.session << ","
+            << escapeField(r.role) << ","
+            << escapeField(r.behaviour) << ","
+            << escapeField(r.parentBehaviour) << ","
+            << QString::number(r.startTime, 'f', 3) << ","
+            << optDoubleToStr(r.endTime) << ","
+            << QString::number(r.duration, 'f', 3) << ","
+            << escapeField(r.recordType) << ","
+            << escapeField(r.tag) << ","
+            << escapeField(r.groupType) << ","
+            << escapeField(r.sex) << ","
+            << escapeField(r.observations) << ","
+            << escapeField(r.stage) << ","
+            << optIntToStr(r.groupSize) << ","
+            << optIntToStr(r.motherAndCalf) << ","
+            << optIntToStr(r.calves) << ","
+            << r.startTimeStr() << ","
+            << r.endTimeStr() << ","
+            << optIntToStr(r.startFrame) << ","
+            << optIntToStr(r.endFrame) << ","
+            << QString::number(r.startTime, 'f', 6) << ","
+            << (r.endTime.has_value() ? QString::number(r.endTime.value(), 'f', 6) : QString()) << "\n";
+    }
+
+    file.close();
+    return out.status() == QTextStream::Ok;
+}
+
+bool sameContents(const QString& a, const QString& b) {
+    QFile fa(a);
+    QFile fb(b);
+    if (!fa.open(QIODevice::ReadOnly) || !fb.open(QIODevice::ReadOnly)) return false;
+    if (fa.size() != fb.size()) return false;
+    while (!fa.atEnd()) {
+        if (fa.read(1 << 20) != fb.read(1 << 20)) return false;
+    }
+    return true;
+}
+
+void printRate(const char* name, double seconds, int records, qint64 bytes) {
+    const double megabytes = bytes / (1024.0 * 1024.0);
+    std::printf("  %-12s %10.1f ms %8.2f M records/s %8.1f MB/s\n", name, seconds * 1000.0,
+                seconds > 0 ? records / seconds / 1e6 : 0.0, seconds > 0 ? megabytes / seconds : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<int> counts;
+    QString outputDir = QDir::tempPath();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            counts.push_back(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            outputDir = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--records N]... [--output-dir dir]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (counts.empty()) counts = {1000000, 10000000};
+
+    const RecordStore::Vocabulary v = vocabulary();
+    const QString oldPath = QDir(outputDir).filePath("ethowild_export_textstream.csv");
+    const QString newPath = QDir(outputDir).filePath("ethowild_export_writer.csv");
+    const QString arrowPath = QDir(outputDir).filePath("ethowild_export.arrow");
+    int status = 0;
+
+    for (int count : counts) {
+        const RecordStore store = makeRecords(count, v);
+        std::printf("%d records\n", count);
+
+        auto start = Clock::now();
+        if (!exportWithTextStream(oldPath, store)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(oldPath));
+            return 1;
+        }
+        printRate("QTextStream", secondsSince(start), count, QFileInfo(oldPath).size());
+
+        start = Clock::now();
+        if (!CsvExporter::exportRecords(newPath, store)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(newPath));
+            return 1;
+        }
+        printRate("CsvWriter", secondsSince(start), count, QFileInfo(newPath).size());
+
+        start = Clock::now();
+        if (!ArrowExporter::exportRecords(arrowPath, store)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(arrowPath));
+            return 1;
+        }
+        printRate("Arrow", secondsSince(start), count, QFileInfo(arrowPath).size());
+
+        if (!sameContents(oldPath, newPath)) {
+            std::printf("  MISMATCH: the files differ\n");
+            status = 1;
+        }
+        QFile::remove(oldPath);
+        QFile::remove(newPath);
+        QFile::remove(arrowPath);
+    }
+    return status;
+}
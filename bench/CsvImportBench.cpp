@@ -0,0 +1,101 @@
+// CSV import speed: synthetic sessions are exported with CsvExporter, split
+// over one or more files, and read back with CsvImporter on one thread and
+// on all of them. The records read back are checked against the originals.
+//
+//   CsvImportBench [--records N] [--files K] [--output-dir dir]
+//
+// The default of 6M records makes about 1 GB of CSV.
+
+#include "BenchRecords.hpp"
+#include "CsvExporter.hpp"
+#include "CsvImporter.hpp"
+#include "RecordStore.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Same records back: times to the exported precision, everything else exactly
+bool sameRecords(const RecordStore& a, const RecordStore& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); ++i) {
+        const RecordStore::Row x = a.at(i);
+        const RecordStore::Row y = b.at(i);
+        if (std::abs(x.startTime() - y.startTime()) > 1e-6 || x.behaviour() != y.behaviour() || x.tag() != y.tag()
+            || x.observations() != y.observations() || x.endFrame() != y.endFrame() || x.session() != y.session()) {
+            std::printf("  MISMATCH at record %d\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = 6000000;
+    int files = 1;
+    QString outputDir = QDir::tempPath();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            count = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--files") == 0 && i + 1 < argc) {
+            files = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            outputDir = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--records N] [--files K] [--output-dir dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const RecordStore::Vocabulary v = vocabulary();
+    RecordStore expected(v);
+    QStringList paths;
+    qint64 bytes = 0;
+    for (int f = 0; f < files; ++f) {
+        const int records = count / files + (f < count % files ? 1 : 0);
+        RecordShape shape; // A different seed per file
+        shape.seed = static_cast<unsigned>(f + 1);
+        const RecordStore store = makeRecords(records, v, shape);
+        const QString path = QDir(outputDir).filePath(QString("ethowild_import_bench_%1.csv").arg(f + 1));
+        if (!CsvExporter::exportRecords(path, store)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(path));
+            return 1;
+        }
+        expected.append(store);
+        paths << path;
+        bytes += QFileInfo(path).size();
+    }
+    std::printf("%d records in %d files, %.1f MB\n", count, files, bytes / (1024.0 * 1024.0));
+
+    int status = 0;
+    const int cores = std::max(1, QThread::idealThreadCount());
+    for (int threads : {1, cores}) {
+        const auto start = Clock::now();
+        const CsvImporter::Result result = CsvImporter(v, threads).importFiles(paths);
+        const double seconds = secondsSince(start);
+        std::printf("  %2d threads %10.1f ms %8.1f MB/s %8.2f M records/s\n", threads, seconds * 1000.0,
+                    seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0,
+                    seconds > 0 ? result.records.size() / seconds / 1e6 : 0.0);
+        if (result.issueCount > 0) {
+            std::printf("  %lld problems, first: %s\n", static_cast<long long>(result.issueCount),
+                        result.issues.empty() ? "" : qPrintable(result.issues.front().message));
+            status = 1;
+        }
+        if (!sameRecords(expected, result.records)) status = 1;
+    }
+
+    for (const QString& path : paths) QFile::remove(path);
+    return status;
+}
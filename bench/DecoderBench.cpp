@@ -0,0 +1,80 @@
+// Decoded frames per second of each decode backend on the same files.
+//
+//   DecoderBench [--frames N] [--threads N] video...
+//
+// For every file and backend two passes are timed: "grab" only decodes,
+// "grab+retrieve" also converts each frame into a pooled RGB32 buffer the
+// way the player does.
+
+#include "FramePool.hpp"
+#include "VideoDecoder.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Result {
+    int frames = 0;
+    double seconds = 0.0;
+    double fps() const { return seconds > 0 ? frames / seconds : 0.0; }
+};
+
+Result run(const QString& backend, const VideoDecoder::Options& options, const QString& path,
+           int maxFrames, bool retrieve) {
+    Result result;
+    auto decoder = VideoDecoder::create(backend, options);
+    if (!decoder->open(path)) return result;
+    
+    auto pool = FramePool::create();
+    QImage image;
+    auto start = std::chrono::steady_clock::now();
+    while (result.frames < maxFrames && decoder->grab()) {
+        if (retrieve && decoder->retrieve(*pool, image) == VideoDecoder::Transfer::Failed) break;
+        image = QImage(); // Back to the pool, as when the GUI drops a frame
+        ++result.frames;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int maxFrames = 1000;
+    VideoDecoder::Options options;
+    QStringList files;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            maxFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else {
+            files << QString::fromLocal8Bit(argv[i]);
+        }
+    }
+    if (files.isEmpty()) {
+        std::fprintf(stderr, "usage: %s [--frames N] [--threads N] video...\n", argv[0]);
+        return 1;
+    }
+    
+    std::printf("%-40s %-8s %14s %14s\n", "file", "backend", "grab fps", "retrieve fps");
+    for (const QString& file : files) {
+        for (const QString& backend : VideoDecoder::availableBackends()) {
+            Result grab = run(backend, options, file, maxFrames, false);
+            Result full = run(backend, options, file, maxFrames, true);
+            if (grab.frames == 0) {
+                std::printf("%-40s %-8s %14s %14s\n", qPrintable(file.right(40)), qPrintable(backend), "failed", "-");
+                continue;
+            }
+            std::printf("%-40s %-8s %14.1f %14.1f\n", qPrintable(file.right(40)), qPrintable(backend),
+                        grab.fps(), full.fps());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Query speed of the project database: a season of synthetic labels spread
+// over many videos is indexed, then the questions the Project panel asks
+// (one behavior across the season, one animal, one video, a category in a
+// time window) are timed. Each query is counted and summed, and the first
+// screenful of rows and then all matching rows are fetched.
+//
+//   ProjectQueryBench [--records N] [--videos V] [--output-dir dir]
+//
+// The default is 1M records over 300 videos.
+
+#include "BenchRecords.hpp"
+#include "ProjectDatabase.hpp"
+#include "RecordStore.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr int kFirstScreen = 256; // Rows the table shows before scrolling
+
+void timeQuery(const char* name, const ProjectDatabase& project, const ProjectDatabase::Filter& filter) {
+    const auto start = Clock::now();
+    const ProjectDatabase::Summary summary = project.summarize(filter);
+    QSqlQuery query = project.select(filter);
+    int rows = 0;
+    while (rows < kFirstScreen && query.next()) ++rows;
+    const double firstScreen = secondsSince(start);
+    while (query.next()) ++rows;
+    const double all = secondsSince(start);
+    std::printf("  %-26s %8lld records %9.2f ms first screen %9.2f ms all\n", name,
+                static_cast<long long>(summary.count), firstScreen * 1000.0, all * 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv); // Qt SQL drivers are loaded as plugins
+
+    int count = 1000000;
+    int videos = 300;
+    QString outputDir = QDir::tempPath();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            count = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--videos") == 0 && i + 1 < argc) {
+            videos = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            outputDir = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--records N] [--videos V] [--output-dir dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // A fresh project each run
+    QDir dir(QDir(outputDir).filePath("ethowild_project_bench"));
+    dir.removeRecursively();
+    dir.mkpath(".");
+    ProjectDatabase project;
+    if (!project.open(dir.absolutePath())) {
+        std::fprintf(stderr, "cannot open a project database in %s\n", qPrintable(dir.absolutePath()));
+        return 1;
+    }
+
+    const RecordStore::Vocabulary v = vocabulary();
+    RecordShape shape;
+    shape.tags = 400; // Animals seen over a season
+    auto start = Clock::now();
+    for (int i = 0; i < videos; ++i) {
+        const int records = count / videos + (i < count % videos ? 1 : 0);
+        const QString video = dir.filePath(QString("survey%1.mp4").arg(i, 3, 10, QChar('0')));
+        shape.seed = static_cast<unsigned>(i + 1);
+        ProjectDatabase::appendUnsaved(project.path(), video, makeRecords(records, v, shape));
+    }
+    const double indexing = secondsSince(start);
+    std::printf("%d records over %d videos indexed in %.1f s (%.0f records/s)\n", count, videos, indexing,
+                indexing > 0 ? count / indexing : 0.0);
+
+    ProjectDatabase::Filter filter;
+    filter.behaviour = v.behaviours[3];
+    timeQuery("behavior, whole season", project, filter);
+
+    filter.tag = "t17";
+    timeQuery("behavior and tag", project, filter);
+
+    filter = ProjectDatabase::Filter();
+    filter.tag = "T17";
+    timeQuery("tag", project, filter);
+
+    filter = ProjectDatabase::Filter();
+    filter.video = "survey042.mp4";
+    timeQuery("video", project, filter);
+
+    filter = ProjectDatabase::Filter();
+    filter.parentBehaviour = v.parentBehaviours[1];
+    filter.from = 600.0;
+    filter.to = 900.0;
+    timeQuery("category, 10:00-15:00", project, filter);
+
+    start = Clock::now();
+    const int listed = project.videos().size();
+    std::printf("  %-26s %8d videos   %9.2f ms\n", "video list", listed, secondsSince(start) * 1000.0);
+
+    const QString path = project.path();
+    project.close();
+    QFile::remove(path);
+    QFile::remove(path + "-wal");
+    QFile::remove(path + "-shm");
+    dir.removeRecursively();
+    return 0;
+}
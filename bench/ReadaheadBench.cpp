@@ -0,0 +1,181 @@
+// Input readahead on slow media, simulated by throttling a local file.
+//
+//   ReadaheadBench [--mbps N] [--latency-ms N] [--megabytes N] [--frames N] [--seeks N] video...
+//
+// Every file is read three ways: synchronously on the caller's thread (what
+// the demuxer does without readahead), through the readahead ring, and
+// through a memory mapping. "read" streams the raw file in 32 KB requests,
+// the size the demuxer asks for. With the FFmpeg backend, "decode" grabs
+// frames and "seek" times random seeks up to the first decoded frame.
+// "stall" is the time the reader spent waiting for storage.
+
+#include "ReadaheadFile.hpp"
+#include "VideoDecoder.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Mode {
+    const char* name;
+    int readaheadMegabytes;
+    bool memoryMap;
+};
+
+const Mode MODES[] = {
+    {"sync", 0, false},
+    {"readahead", 32, false},
+    {"mmap", 32, true},
+};
+
+struct Throttle {
+    double megabytesPerSecond = 20.0; // A slow USB hard disk or SD card
+    double latencyMs = 5.0;
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double stallMs(const IoCounters& counters) {
+    return counters.stallNanoseconds.load() / 1e6;
+}
+
+// MB/s delivered to a reader that streams the file in demuxer-sized requests
+void benchRead(const std::string& path, const Mode& mode, const Throttle& throttle, int megabytes) {
+    ReadaheadFile::Options options;
+    options.bufferBytes = static_cast<size_t>(mode.readaheadMegabytes) * 1024 * 1024;
+    options.memoryMap = mode.memoryMap;
+    options.throttleBytesPerSecond = throttle.megabytesPerSecond * 1024 * 1024;
+    options.throttleLatencySeconds = throttle.latencyMs / 1000.0;
+    options.counters = std::make_shared<IoCounters>();
+
+    ReadaheadFile file(options);
+    if (!file.open(path)) {
+        std::printf("  %-10s %-7s %s\n", mode.name, "read", "failed");
+        return;
+    }
+
+    std::vector<uint8_t> buffer(32 * 1024);
+    const int64_t limit = static_cast<int64_t>(megabytes) * 1024 * 1024;
+    int64_t total = 0;
+    auto start = Clock::now();
+    while (total < limit) {
+        int64_t result = file.read(buffer.data(), static_cast<int64_t>(buffer.size()));
+        if (result <= 0) break;
+        total += result;
+    }
+    double seconds = secondsSince(start);
+    std::printf("  %-10s %-7s %10.1f MB/s %12.0f ms stall\n", mode.name, "read",
+                seconds > 0 ? total / (1024.0 * 1024.0) / seconds : 0.0, stallMs(*options.counters));
+}
+
+VideoDecoder::Options decoderOptions(const Mode& mode, const Throttle& throttle) {
+    VideoDecoder::Options options;
+    options.readaheadMegabytes = mode.readaheadMegabytes;
+    options.memoryMap = mode.memoryMap;
+    options.throttleMegabytesPerSecond = throttle.megabytesPerSecond;
+    options.throttleLatencyMs = throttle.latencyMs;
+    options.ioCounters = std::make_shared<IoCounters>();
+    return options;
+}
+
+// Frames per second while grabbing (no color conversion)
+void benchDecode(const QString& path, const Mode& mode, const Throttle& throttle, int maxFrames) {
+    VideoDecoder::Options options = decoderOptions(mode, throttle);
+    auto decoder = VideoDecoder::create("ffmpeg", options);
+    if (!decoder->open(path)) {
+        std::printf("  %-10s %-7s %s\n", mode.name, "decode", "failed");
+        return;
+    }
+
+    int frames = 0;
+    auto start = Clock::now();
+    while (frames < maxFrames && decoder->grab()) {
+        ++frames;
+    }
+    double seconds = secondsSince(start);
+    std::printf("  %-10s %-7s %10.1f fps  %12.0f ms stall\n", mode.name, "decode",
+                seconds > 0 ? frames / seconds : 0.0, stallMs(*options.ioCounters));
+}
+
+// Time from a random seek to the first decoded frame
+void benchSeek(const QString& path, const Mode& mode, const Throttle& throttle, int seeks) {
+    VideoDecoder::Options options = decoderOptions(mode, throttle);
+    auto decoder = VideoDecoder::create("ffmpeg", options);
+    if (!decoder->open(path) || decoder->duration() <= 0) {
+        std::printf("  %-10s %-7s %s\n", mode.name, "seek", "failed");
+        return;
+    }
+
+    // Same targets for every mode
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> position(0.0, decoder->duration());
+    double total = 0.0;
+    double worst = 0.0;
+    for (int i = 0; i < seeks; ++i) {
+        auto start = Clock::now();
+        decoder->seek(position(random));
+        decoder->grab();
+        double ms = secondsSince(start) * 1000.0;
+        total += ms;
+        worst = std::max(worst, ms);
+    }
+    std::printf("  %-10s %-7s %10.1f ms avg %9.1f ms max\n", mode.name, "seek", total / seeks, worst);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Throttle throttle;
+    int megabytes = 64;
+    int maxFrames = 300;
+    int seeks = 20;
+    QStringList files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--mbps") == 0 && i + 1 < argc) {
+            throttle.megabytesPerSecond = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--latency-ms") == 0 && i + 1 < argc) {
+            throttle.latencyMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--megabytes") == 0 && i + 1 < argc) {
+            megabytes = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            maxFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seeks") == 0 && i + 1 < argc) {
+            seeks = std::max(1, std::atoi(argv[++i]));
+        } else {
+            files << QString::fromLocal8Bit(argv[i]);
+        }
+    }
+    if (files.isEmpty()) {
+        std::fprintf(stderr, "usage: %s [--mbps N] [--latency-ms N] [--megabytes N] [--frames N] [--seeks N] video...\n",
+                     argv[0]);
+        return 1;
+    }
+
+    const bool decode = VideoDecoder::availableBackends().contains("ffmpeg");
+    std::printf("Simulated medium: %.1f MB/s, %.1f ms per request%s\n", throttle.megabytesPerSecond,
+                throttle.latencyMs, decode ? "" : " (no FFmpeg backend: read pass only)");
+    for (const QString& file : files) {
+        std::printf("%s\n", qPrintable(file));
+        for (const Mode& mode : MODES) {
+            benchRead(file.toUtf8().toStdString(), mode, throttle, megabytes);
+            if (decode) {
+                benchDecode(file, mode, throttle, maxFrames);
+                benchSeek(file, mode, throttle, seeks);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Memory, CSV export and filter speed of the columnar record store against
+// the plain QVector<BehaviorRecord> it replaced.
+//
+//   RecordStoreBench [--records N] [--output file.csv]
+//
+// Records are synthetic but shaped like real sessions (BenchRecords.hpp): a
+// vocabulary the size of behaviors.json, a few dozen tags, mostly short
+// events and empty observations. "vector (own strings)" counts every string
+// as a separate allocation, as for records read back from files; "vector
+// (shared)" only counts the structs, as when labels share the GUI's strings.
+
+#include "BenchRecords.hpp"
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Records as a plain list, each string its own copy, like strings parsed
+// from a file
+QVector<BehaviorRecord> makeRecordList(int count, const RecordStore::Vocabulary& v) {
+    QVector<BehaviorRecord> records;
+    records.reserve(count);
+    generateRecords(count, v, RecordShape(), [&records](const BehaviorRecord& shared) {
+        BehaviorRecord r = shared;
+        for (QString* s : {&r.role, &r.behaviour, &r.parentBehaviour, &r.recordType, &r.tag, &r.groupType, &r.sex,
+                           &r.observations, &r.stage}) {
+            *s = QString(s->constData(), s->size());
+        }
+        records.append(r);
+    });
+    return records;
+}
+
+size_t stringBytes(const QString& s) {
+    // Qt 6 array header plus UTF-16 payload, rounded like malloc
+    if (s.isEmpty()) return 0;
+    size_t bytes = 16 + (static_cast<size_t>(s.size()) + 1) * sizeof(QChar);
+    return (bytes + 15) & ~size_t(15);
+}
+
+size_t vectorBytes(const QVector<BehaviorRecord>& records, bool ownStrings) {
+    size_t bytes = static_cast<size_t>(records.capacity()) * sizeof(BehaviorRecord);
+    if (!ownStrings) return bytes;
+    for (const BehaviorRecord& r : records) {
+        for (const QString* s : {&r.role, &r.behaviour, &r.parentBehaviour, &r.recordType, &r.tag, &r.groupType,
+                                 &r.sex, &r.observations, &r.stage}) {
+            bytes += stringBytes(*s);
+        }
+    }
+    return bytes;
+}
+
+void printMemory(const char* name, size_t bytes, int records) {
+    std::printf("  %-22s %10.1f MB %8.1f bytes/record\n", name, bytes / (1024.0 * 1024.0),
+                records > 0 ? static_cast<double>(bytes) / records : 0.0);
+}
+
+void printRate(const char* name, double seconds, int records, const char* note = "") {
+    std::printf("  %-22s %10.1f ms %8.1f M records/s %s\n", name, seconds * 1000.0,
+                seconds > 0 ? records / seconds / 1e6 : 0.0, note);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = 1000000;
+    QString output = QDir::temp().filePath("ethowild_record_bench.csv");
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            count = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--records N] [--output file.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const RecordStore::Vocabulary v = vocabulary();
+    const QVector<BehaviorRecord> records = makeRecordList(count, v);
+
+    auto start = Clock::now();
+    RecordStore store(v);
+    store.reserve(count);
+    for (const BehaviorRecord& r : records) store.append(r);
+    std::printf("%d records\n", count);
+    printRate("append to store", secondsSince(start), count);
+
+    std::printf("Memory\n");
+    printMemory("vector (own strings)", vectorBytes(records, true), count);
+    printMemory("vector (shared)", vectorBytes(records, false), count);
+    printMemory("store", store.memoryBytes(), count);
+
+    std::printf("CSV export\n");
+    start = Clock::now();
+    if (!CsvExporter::exportRecords(output, store)) {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(output));
+        return 1;
+    }
+    double seconds = secondsSince(start);
+    const double megabytes = QFileInfo(output).size() / (1024.0 * 1024.0);
+    char note[64];
+    std::snprintf(note, sizeof(note), "(%.1f MB/s)", seconds > 0 ? megabytes / seconds : 0.0);
+    printRate("store", seconds, count, note);
+    QFile::remove(output);
+
+    // Same question both ways: one behavior, then one tag in a time window
+    const QString behaviour = v.behaviours[3];
+    const QString tag = "T7";
+    const double from = records[count / 4].startTime;
+    const double to = records[count / 2].startTime;
+
+    std::printf("Filter by behavior\n");
+    start = Clock::now();
+    int matches = 0;
+    for (const BehaviorRecord& r : records) matches += r.behaviour == behaviour;
+    printRate("vector", secondsSince(start), count);
+
+    RecordStore::Query query;
+    query.behaviour = static_cast<uint32_t>(store.dictionary(RecordStore::Field::Behaviour).find(behaviour));
+    start = Clock::now();
+    std::vector<int> rows = store.select(query);
+    printRate("store", secondsSince(start), count);
+    if (static_cast<int>(rows.size()) != matches) std::printf("  MISMATCH: %d vs %zu\n", matches, rows.size());
+
+    std::printf("Filter by tag and time\n");
+    start = Clock::now();
+    matches = 0;
+    for (const BehaviorRecord& r : records) matches += r.tag == tag && r.startTime >= from && r.startTime <= to;
+    printRate("vector", secondsSince(start), count);
+
+    query = RecordStore::Query();
+    query.tag = static_cast<uint32_t>(store.dictionary(RecordStore::Field::Tag).find(tag));
+    query.from = from;
+    query.to = to;
+    start = Clock::now();
+    rows = store.select(query);
+    printRate("store", secondsSince(start), count);
+    if (static_cast<int>(rows.size()) != matches) std::printf("  MISMATCH: %d vs %zu\n", matches, rows.size());
+
+    std::printf("Count and duration by behavior\n");
+    start = Clock::now();
+    QHash<QString, QPair<int, double>> totals;
+    for (const BehaviorRecord& r : records) {
+        auto& total = totals[r.behaviour];
+        ++total.first;
+        total.second += r.duration;
+    }
+    printRate("vector", secondsSince(start), count);
+
+    start = Clock::now();
+    std::vector<RecordStore::Aggregate> aggregates = store.aggregate(RecordStore::Field::Behaviour);
+    printRate("store", secondsSince(start), count);
+    if (aggregates.size() != static_cast<size_t>(totals.size())) {
+        std::printf("  MISMATCH: %d vs %zu groups\n", static_cast<int>(totals.size()), aggregates.size());
+    }
+    return 0;
+}
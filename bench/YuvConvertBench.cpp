@@ -0,0 +1,124 @@
+// Throughput of the YUV 4:2:0 -> BGRA display conversion per code path.
+//
+//   YuvConvertBench [--threads N] [--iterations N]
+//
+// Converts synthetic 1080p, 4K and 5.3K frames (I420 and NV12) at full size
+// and with the 2x box downscale, once per instruction set the CPU supports.
+
+#include "YuvConverter.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+struct Planes {
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+    YuvFrame frame;
+};
+
+void makeFrame(Planes& planes, int width, int height, YuvFrame::Layout layout) {
+    std::mt19937 random(42);
+    auto fill = [&](std::vector<uint8_t>& plane, size_t size) {
+        plane.resize(size);
+        for (uint8_t& value : plane) value = static_cast<uint8_t>(random());
+    };
+    
+    // Decoder-like strides: rows padded to 64 bytes
+    const int yStride = (width + 63) & ~63;
+    const int chromaWidth = layout == YuvFrame::Layout::NV12 ? width : width / 2;
+    const int chromaStride = (chromaWidth + 63) & ~63;
+    fill(planes.y, static_cast<size_t>(yStride) * height);
+    fill(planes.u, static_cast<size_t>(chromaStride) * (height / 2));
+    fill(planes.v, static_cast<size_t>(chromaStride) * (height / 2));
+    
+    YuvFrame& frame = planes.frame;
+    frame.layout = layout;
+    frame.width = width;
+    frame.height = height;
+    frame.planes[0] = planes.y.data();
+    frame.planes[1] = planes.u.data();
+    frame.planes[2] = layout == YuvFrame::Layout::NV12 ? nullptr : planes.v.data();
+    frame.strides[0] = yStride;
+    frame.strides[1] = chromaStride;
+    frame.strides[2] = layout == YuvFrame::Layout::NV12 ? 0 : chromaStride;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = 1;
+    int iterations = 50;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "usage: %s [--threads N] [--iterations N]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    const Resolution resolutions[] = {
+        {"1080p", 1920, 1080},
+        {"4K", 3840, 2160},
+        {"5.3K", 5312, 2988},
+    };
+    std::vector<YuvConverter::Isa> isas = {YuvConverter::Isa::Scalar};
+    for (YuvConverter::Isa isa : {YuvConverter::Isa::Sse41, YuvConverter::Isa::Avx2, YuvConverter::Isa::Avx512}) {
+        if (isa <= YuvConverter::bestIsa()) isas.push_back(isa);
+    }
+    
+    std::printf("threads: %d, best: %s\n", threads, YuvConverter::isaName(YuvConverter::bestIsa()));
+    std::printf("%-6s %-5s %-6s %-8s %10s %12s\n", "size", "fmt", "scale", "isa", "ms/frame", "Mpix/s in");
+    for (const Resolution& resolution : resolutions) {
+        for (YuvFrame::Layout layout : {YuvFrame::Layout::I420, YuvFrame::Layout::NV12}) {
+            Planes planes;
+            makeFrame(planes, resolution.width, resolution.height, layout);
+            
+            for (int factor : {1, 2}) {
+                const int dstWidth = resolution.width / factor;
+                const int dstHeight = resolution.height / factor;
+                std::vector<uint8_t> output(static_cast<size_t>(dstWidth) * 4 * dstHeight);
+                
+                YuvConverter::Request request;
+                request.frame = &planes.frame;
+                request.width = resolution.width;
+                request.height = resolution.height;
+                request.factor = factor;
+                request.dst = output.data();
+                request.dstStride = dstWidth * 4;
+                request.dstWidth = dstWidth;
+                request.dstHeight = dstHeight;
+                
+                for (YuvConverter::Isa isa : isas) {
+                    YuvConverter::convert(request, threads, isa); // Warm up
+                    auto start = std::chrono::steady_clock::now();
+                    for (int i = 0; i < iterations; ++i) {
+                        YuvConverter::convert(request, threads, isa);
+                    }
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    double perFrame = seconds / iterations;
+                    double megapixels = static_cast<double>(resolution.width) * resolution.height / 1.0e6;
+                    std::printf("%-6s %-5s 1/%-4d %-8s %10.2f %12.0f\n", resolution.name,
+                                layout == YuvFrame::Layout::NV12 ? "NV12" : "I420", factor,
+                                YuvConverter::isaName(isa), perFrame * 1000.0, megapixels / perFrame);
+                }
+            }
+        }
+    }
+    return 0;
+}
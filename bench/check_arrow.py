@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Check the Arrow files written by ArrowFixture with pyarrow.
+
+    python3 bench/check_arrow.py dir
+
+Every <name>.arrow in dir is opened as an Arrow IPC file and as Feather,
+validated in full (buffers, offsets, dictionary indices, UTF-8), and
+compared column by column with <name>.csv, which holds the same records.
+Run it after changing ArrowWriter or the columns of ArrowExporter.
+"""
+
+import csv
+import math
+import sys
+from pathlib import Path
+
+import pyarrow as pa
+import pyarrow.feather as feather
+import pyarrow.ipc as ipc
+
+CATEGORICAL = ["role", "behaviour", "parent_behaviour", "record_type", "tag", "group_type", "sex", "stage"]
+FLOAT = ["start_time", "end_time", "duration"]
+NOT_NULL = ["session", "start_time", "duration"]
+# CSV columns derived from others; not in the Arrow file
+CSV_ONLY = ["start_time_str", "end_time_str", "start_pts", "end_pts"]
+
+TIME_TOLERANCE = 0.0005 + 1e-9  # The CSV rounds seconds to 3 decimals
+
+
+def check_schema(schema, header):
+    expected = [name for name in header if name not in CSV_ONLY]
+    if schema.names != expected:
+        raise AssertionError(f"columns {schema.names}, expected {expected}")
+    for field in schema:
+        if field.name in CATEGORICAL:
+            wanted = pa.dictionary(pa.int32(), pa.utf8())
+        elif field.name in FLOAT:
+            wanted = pa.float64()
+        elif field.name == "observations":
+            wanted = pa.utf8()
+        else:
+            wanted = pa.int32()
+        if field.type != wanted:
+            raise AssertionError(f"{field.name}: type {field.type}, expected {wanted}")
+        if field.nullable == (field.name in NOT_NULL):
+            raise AssertionError(f"{field.name}: nullable is {field.nullable}")
+
+
+def same_value(name, value, text):
+    if value is None:
+        return text == "" and name not in NOT_NULL
+    if name in FLOAT:
+        return text != "" and math.isfinite(value) and abs(value - float(text)) <= TIME_TOLERANCE
+    if name in CATEGORICAL or name == "observations":
+        return value != "" and value == text
+    return text != "" and value == int(text)
+
+
+def check_file(path):
+    with open(path.with_suffix(".csv"), newline="", encoding="utf-8") as f:
+        rows = list(csv.reader(f))
+    header, rows = rows[0], rows[1:]
+
+    reader = ipc.open_file(path)
+    check_schema(reader.schema, header)
+    for i in range(reader.num_record_batches):
+        reader.get_batch(i).validate(full=True)
+    table = reader.read_all()
+    table.validate(full=True)
+    if not feather.read_table(path).equals(table):
+        raise AssertionError("read_feather differs from the IPC reader")
+    if table.num_rows != len(rows):
+        raise AssertionError(f"{table.num_rows} rows, expected {len(rows)}")
+
+    for name in table.column_names:
+        column = header.index(name)
+        for row, value in enumerate(table.column(name).to_pylist()):
+            if not same_value(name, value, rows[row][column]):
+                raise AssertionError(f"row {row + 1}, {name}: {value!r}, CSV has {rows[row][column]!r}")
+    return table.num_rows, reader.num_record_batches
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+    paths = sorted(Path(sys.argv[1]).glob("*.arrow"))
+    if not paths:
+        print(f"no .arrow files in {sys.argv[1]}", file=sys.stderr)
+        return 1
+    failed = 0
+    for path in paths:
+        try:
+            records, batches = check_file(path)
+            print(f"  {path.name:<16} ok: {records} records in {batches} batches")
+        except Exception as error:  # Report every file, not just the first failure
+            print(f"  {path.name:<16} FAILED: {error}")
+            failed += 1
+    print(f"pyarrow {pa.__version__}: {len(paths) - failed} of {len(paths)} files ok")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,193 @@
+#include "ArrowExporter.hpp"
+#include "ArrowWriter.hpp"
+
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kBatchRows = 64 * 1024;
+
+using Field = RecordStore::Field;
+using Type = ArrowColumn::Type;
+
+enum class Source {
+    Session, Text, StartTime, EndTime, Duration, Observations,
+    GroupSize, MotherAndCalf, Calves, StartFrame, EndFrame
+};
+
+struct Column {
+    const char* name;
+    Source source;
+    Field field = Field::FIELD_COUNT; // Source::Text only
+};
+
+// Same order and names as the CSV columns
+const Column kColumns[] = {
+    {"session", Source::Session},
+    {"role", Source::Text, Field::Role},
+    {"behaviour", Source::Text, Field::Behaviour},
+    {"parent_behaviour", Source::Text, Field::ParentBehaviour},
+    {"start_time", Source::StartTime},
+    {"end_time", Source::EndTime},
+    {"duration", Source::Duration},
+    {"record_type", Source::Text, Field::RecordType},
+    {"tag", Source::Text, Field::Tag},
+    {"group_type", Source::Text, Field::GroupType},
+    {"sex", Source::Text, Field::Sex},
+    {"observations", Source::Observations},
+    {"stage", Source::Text, Field::Stage},
+    {"group_size", Source::GroupSize},
+    {"mother_and_calf", Source::MotherAndCalf},
+    {"calves", Source::Calves},
+    {"start_frame", Source::StartFrame},
+    {"end_frame", Source::EndFrame},
+};
+
+ArrowWriter::Field schemaField(const Column& column) {
+    ArrowWriter::Field field;
+    field.name = column.name;
+    switch (column.source) {
+    case Source::Session:
+        field.type = Type::Int32;
+        field.nullable = false;
+        break;
+    case Source::Text:
+        field.type = Type::Utf8;
+        field.dictionary = static_cast<int>(column.field);
+        break;
+    case Source::StartTime:
+    case Source::Duration:
+        field.type = Type::Float64;
+        field.nullable = false;
+        break;
+    case Source::EndTime:
+        field.type = Type::Float64;
+        break;
+    case Source::Observations:
+        field.type = Type::Utf8;
+        break;
+    default:
+        field.type = Type::Int32;
+        break;
+    }
+    return field;
+}
+
+// Batch columns hold dictionary indices, not the text itself
+ArrowColumn batchColumn(const Column& column) {
+    const ArrowWriter::Field field = schemaField(column);
+    return ArrowColumn(field.dictionary >= 0 ? Type::Int32 : field.type);
+}
+
+void appendOptional(ArrowColumn& column, const std::optional<int>& value) {
+    if (value) {
+        column.appendInt32(*value);
+    } else {
+        column.appendNull();
+    }
+}
+
+void appendValue(ArrowColumn& out, const Column& column, const RecordStore::Row& r, QByteArray& utf8) {
+    switch (column.source) {
+    case Source::Session: out.appendInt32(r.session()); break;
+    case Source::Text: {
+        // Code 0 is the empty string, left out of the Arrow dictionary
+        const uint32_t code = r.code(column.field);
+        if (code == 0) {
+            out.appendNull();
+        } else {
+            out.appendInt32(code - 1);
+        }
+        break;
+    }
+    case Source::StartTime: out.appendDouble(r.startTime()); break;
+    case Source::EndTime:
+        if (std::optional<double> end = r.endTime()) {
+            out.appendDouble(*end);
+        } else {
+            out.appendNull();
+        }
+        break;
+    case Source::Duration: out.appendDouble(r.duration()); break;
+    case Source::Observations: {
+        const QStringView text = r.observations();
+        if (text.isEmpty()) {
+            out.appendNull();
+        } else {
+            utf8 = text.toUtf8();
+            out.appendString(std::string_view(utf8.constData(), utf8.size()));
+        }
+        break;
+    }
+    case Source::GroupSize: appendOptional(out, r.groupSize()); break;
+    case Source::MotherAndCalf: appendOptional(out, r.motherAndCalf()); break;
+    case Source::Calves: appendOptional(out, r.calves()); break;
+    case Source::StartFrame: appendOptional(out, r.startFrame()); break;
+    case Source::EndFrame: appendOptional(out, r.endFrame()); break;
+    }
+}
+
+} // namespace
+
+bool ArrowExporter::exportRecords(const QString& filePath,
+                                  const RecordStore& records,
+                                  const CsvExporter::Progress& progress) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    ArrowWriter writer([&file](const char* data, size_t size) {
+        return file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+    });
+    
+    std::vector<ArrowWriter::Field> schema;
+    std::vector<ArrowColumn> columns;
+    for (const Column& column : kColumns) {
+        schema.push_back(schemaField(column));
+        columns.push_back(batchColumn(column));
+    }
+    bool ok = writer.begin(schema);
+    
+    // Dictionaries first: the store's values, without the empty string
+    QByteArray utf8;
+    for (int f = 0; ok && f < static_cast<int>(Field::FIELD_COUNT); ++f) {
+        const StringDictionary& dictionary = records.dictionary(static_cast<Field>(f));
+        ArrowColumn values(Type::Utf8);
+        for (int code = 1; code < dictionary.size(); ++code) {
+            utf8 = dictionary.value(static_cast<uint32_t>(code)).toUtf8();
+            values.appendString(std::string_view(utf8.constData(), utf8.size()));
+        }
+        ok = writer.writeDictionary(f, values);
+    }
+    
+    const qint64 total = records.size();
+    for (int start = 0; ok && start < records.size(); start += kBatchRows) {
+        if (progress.cancel && progress.cancel->load(std::memory_order_relaxed)) {
+            ok = false;
+            break;
+        }
+        const int end = std::min(records.size(), start + kBatchRows);
+        for (ArrowColumn& column : columns) column.clear();
+        for (int i = start; i < end; ++i) {
+            const RecordStore::Row r(records, i);
+            for (size_t c = 0; c < columns.size(); ++c) appendValue(columns[c], kColumns[c], r, utf8);
+        }
+        ok = writer.writeBatch(columns);
+        if (ok && progress.report) progress.report(end, total);
+    }
+    
+    if (!ok || !writer.finish()) {
+        file.cancelWriting();
+        file.commit();
+        return false;
+    }
+    return file.commit();
+}
+
+bool ArrowExporter::isArrowFile(const QString& filePath) {
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    return suffix == "arrow" || suffix == "feather";
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+#include <QString>
+
+// Records as an Apache Arrow IPC file (Feather v2), read directly by
+// pyarrow / pandas (read_feather) and R's arrow package without parsing.
+// Columns follow the CSV, typed: times are float64, counts and frames
+// nullable int32, and the categorical fields dictionary-encoded with the
+// store's own dictionaries. Empty values are nulls. The derived MM:SS and
+// PTS columns of the CSV are left out; start_time and end_time hold the
+// same seconds at full precision.
+class ArrowExporter {
+public:
+    // Written in batches straight from the store's columns; progress and
+    // cancellation as for CsvExporter
+    static bool exportRecords(const QString& filePath,
+                              const RecordStore& records,
+                              const CsvExporter::Progress& progress = CsvExporter::Progress());
+
+    // Paths saved as Arrow rather than CSV (".arrow" or ".feather")
+    static bool isArrowFile(const QString& filePath);
+};
@@ -0,0 +1,436 @@
+#include "ArrowWriter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Arrow files are little-endian, and so is everything written here
+static_assert(std::endian::native == std::endian::little, "ArrowWriter assumes a little-endian host");
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+constexpr int16_t kMetadataV5 = 4;
+constexpr int16_t kPrecisionDouble = 2;
+
+// Union tags and table field ids, from Arrow's Schema.fbs, Message.fbs and File.fbs
+enum class MessageHeader : uint8_t { Schema = 1, DictionaryBatch = 2, RecordBatch = 3 };
+enum class TypeTag : uint8_t { Int = 2, FloatingPoint = 3, Utf8 = 5 };
+
+// Minimal flatbuffer builder. Like the reference one it fills the buffer
+// from the back, so children are always written before the tables that
+// point at them; references are positions counted from the end.
+class FlatBuilder {
+public:
+    using Ref = uint32_t;
+
+    FlatBuilder() : m_buffer(1024), m_head(m_buffer.size()), m_minAlign(1), m_tableStart(0) {}
+
+    Ref createString(std::string_view s) {
+        align(s.size() + 1, 4);
+        uint8_t* data = prepend(s.size() + 1);
+        std::memcpy(data, s.data(), s.size());
+        data[s.size()] = 0;
+        return prependLength(s.size());
+    }
+
+    // Vector of structs given as their little-endian bytes
+    Ref createStructVector(const std::vector<uint8_t>& bytes, size_t count, size_t alignment) {
+        align(bytes.size(), std::max<size_t>(alignment, 4));
+        if (!bytes.empty()) std::memcpy(prepend(bytes.size()), bytes.data(), bytes.size());
+        return prependLength(count);
+    }
+
+    Ref createVector(const std::vector<Ref>& refs) {
+        align(refs.size() * 4, 4);
+        for (auto it = refs.rbegin(); it != refs.rend(); ++it) prependRef(*it);
+        return prependLength(refs.size());
+    }
+
+    void startTable() {
+        m_slots.clear();
+        m_tableStart = size();
+    }
+
+    template <typename T>
+    void add(int field, T value) {
+        align(sizeof(T), sizeof(T));
+        std::memcpy(prepend(sizeof(T)), &value, sizeof(T));
+        m_slots.push_back({field, size()});
+    }
+
+    void addRef(int field, Ref ref) {
+        align(4, 4);
+        prependRef(ref);
+        m_slots.push_back({field, size()});
+    }
+
+    Ref endTable() {
+        // The table starts with the signed offset to its vtable, which is
+        // placed right before it
+        align(4, 4);
+        prepend(4);
+        const uint32_t table = size();
+
+        int fields = 0;
+        for (const Slot& slot : m_slots) fields = std::max(fields, slot.field + 1);
+        std::vector<uint16_t> vtable(2 + fields, 0);
+        vtable[0] = static_cast<uint16_t>(vtable.size() * 2);
+        vtable[1] = static_cast<uint16_t>(table - m_tableStart);
+        for (const Slot& slot : m_slots) vtable[2 + slot.field] = static_cast<uint16_t>(table - slot.position);
+        std::memcpy(prepend(vtable.size() * 2), vtable.data(), vtable.size() * 2);
+
+        const int32_t toVtable = static_cast<int32_t>(size() - table);
+        std::memcpy(at(table), &toVtable, 4);
+        return table;
+    }
+
+    std::vector<uint8_t> finish(Ref root) {
+        align(4, m_minAlign);
+        prependRef(root);
+        return std::vector<uint8_t>(m_buffer.begin() + m_head, m_buffer.end());
+    }
+
+private:
+    struct Slot {
+        int field;
+        uint32_t position;
+    };
+
+    uint32_t size() const { return static_cast<uint32_t>(m_buffer.size() - m_head); }
+    uint8_t* at(uint32_t position) { return m_buffer.data() + m_buffer.size() - position; }
+
+    uint8_t* prepend(size_t bytes) {
+        if (m_head < bytes) {
+            const size_t used = size();
+            const size_t capacity = std::max(m_buffer.size() * 2, used + bytes);
+            std::vector<uint8_t> grown(capacity);
+            std::copy(m_buffer.begin() + m_head, m_buffer.end(), grown.end() - used);
+            m_buffer.swap(grown);
+            m_head = capacity - used;
+        }
+        m_head -= bytes;
+        return m_buffer.data() + m_head;
+    }
+
+    // Pad so that the position is aligned once `bytes` more are prepended
+    void align(size_t bytes, size_t alignment) {
+        m_minAlign = std::max(m_minAlign, alignment);
+        const size_t padding = (0 - (size() + bytes)) & (alignment - 1);
+        if (padding > 0) std::memset(prepend(padding), 0, padding);
+    }
+
+    void prependRef(Ref ref) {
+        const uint32_t offset = size() + 4 - ref;
+        std::memcpy(prepend(4), &offset, 4);
+    }
+
+    Ref prependLength(size_t count) {
+        const uint32_t length = static_cast<uint32_t>(count);
+        std::memcpy(prepend(4), &length, 4);
+        return size();
+    }
+
+    std::vector<uint8_t> m_buffer;
+    size_t m_head;
+    size_t m_minAlign;
+    std::vector<Slot> m_slots;
+    uint32_t m_tableStart;
+};
+
+template <typename T>
+void appendBytes(std::vector<uint8_t>& bytes, T value) {
+    const size_t at = bytes.size();
+    bytes.resize(at + sizeof(T));
+    std::memcpy(bytes.data() + at, &value, sizeof(T));
+}
+
+size_t padTo8(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+FlatBuilder::Ref createIntType(FlatBuilder& b) {
+    b.startTable();
+    b.add<int32_t>(0, 32);    // bitWidth
+    b.add<uint8_t>(1, 1);     // is_signed
+    return b.endTable();
+}
+
+FlatBuilder::Ref createType(FlatBuilder& b, ArrowColumn::Type type) {
+    switch (type) {
+    case ArrowColumn::Type::Int32:
+        return createIntType(b);
+    case ArrowColumn::Type::Float64:
+        b.startTable();
+        b.add<int16_t>(0, kPrecisionDouble);
+        return b.endTable();
+    case ArrowColumn::Type::Utf8:
+        break;
+    }
+    b.startTable();
+    return b.endTable();
+}
+
+TypeTag typeTag(ArrowColumn::Type type) {
+    switch (type) {
+    case ArrowColumn::Type::Int32: return TypeTag::Int;
+    case ArrowColumn::Type::Float64: return TypeTag::FloatingPoint;
+    case ArrowColumn::Type::Utf8: break;
+    }
+    return TypeTag::Utf8;
+}
+
+FlatBuilder::Ref createSchema(FlatBuilder& b, const std::vector<ArrowWriter::Field>& schema) {
+    std::vector<FlatBuilder::Ref> fields;
+    for (const ArrowWriter::Field& field : schema) {
+        const FlatBuilder::Ref name = b.createString(field.name);
+        const FlatBuilder::Ref type = createType(b, field.type);
+        FlatBuilder::Ref dictionary = 0;
+        if (field.dictionary >= 0) {
+            const FlatBuilder::Ref indexType = createIntType(b);
+            b.startTable();
+            b.add<int64_t>(0, field.dictionary); // id
+            b.addRef(1, indexType);
+            b.add<uint8_t>(2, 0);                // isOrdered
+            dictionary = b.endTable();
+        }
+        // Readers insist on a children vector, even an empty one
+        const FlatBuilder::Ref children = b.createVector({});
+
+        b.startTable();
+        b.addRef(0, name);
+        b.add<uint8_t>(1, field.nullable ? 1 : 0);
+        b.add<uint8_t>(2, static_cast<uint8_t>(typeTag(field.type)));
+        b.addRef(3, type);
+        if (dictionary != 0) b.addRef(4, dictionary);
+        b.addRef(5, children);
+        fields.push_back(b.endTable());
+    }
+    const FlatBuilder::Ref fieldVector = b.createVector(fields);
+
+    b.startTable();
+    b.add<int16_t>(0, 0); // Little-endian
+    b.addRef(1, fieldVector);
+    return b.endTable();
+}
+
+std::vector<uint8_t> messageBytes(FlatBuilder& b, MessageHeader type, FlatBuilder::Ref header, int64_t bodyLength) {
+    b.startTable();
+    b.add<int16_t>(0, kMetadataV5);
+    b.add<uint8_t>(1, static_cast<uint8_t>(type));
+    b.addRef(2, header);
+    b.add<int64_t>(3, bodyLength);
+    return b.finish(b.endTable());
+}
+
+// Body of a record batch: the columns' buffers back to back, each padded to
+// 8 bytes, with the node and buffer lists describing them
+struct Body {
+    std::vector<uint8_t> nodes;   // FieldNode structs
+    std::vector<uint8_t> buffers; // Buffer structs
+    size_t nodeCount = 0;
+    size_t bufferCount = 0;
+    std::vector<char> data;
+
+    void addBuffer(const void* bytes, size_t size) {
+        const size_t offset = data.size();
+        appendBytes<int64_t>(buffers, static_cast<int64_t>(offset));
+        appendBytes<int64_t>(buffers, static_cast<int64_t>(size));
+        ++bufferCount;
+        data.resize(offset + padTo8(size), 0);
+        if (size > 0) std::memcpy(data.data() + offset, bytes, size);
+    }
+
+    void addColumn(const ArrowColumn& column, const std::vector<uint8_t>& validity,
+                   const std::vector<char>& values, const std::vector<int32_t>& offsets) {
+        appendBytes<int64_t>(nodes, column.length());
+        appendBytes<int64_t>(nodes, column.nullCount());
+        ++nodeCount;
+        // Without nulls the validity bitmap may be left out
+        addBuffer(validity.data(), column.nullCount() > 0 ? validity.size() : 0);
+        if (column.type() == ArrowColumn::Type::Utf8) {
+            addBuffer(offsets.data(), offsets.size() * sizeof(int32_t));
+        }
+        addBuffer(values.data(), values.size());
+    }
+};
+
+FlatBuilder::Ref createRecordBatch(FlatBuilder& b, int64_t length, const Body& body) {
+    const FlatBuilder::Ref nodes = b.createStructVector(body.nodes, body.nodeCount, 8);
+    const FlatBuilder::Ref buffers = b.createStructVector(body.buffers, body.bufferCount, 8);
+    b.startTable();
+    b.add<int64_t>(0, length);
+    b.addRef(1, nodes);
+    b.addRef(2, buffers);
+    return b.endTable();
+}
+
+} // namespace
+
+ArrowColumn::ArrowColumn(Type type)
+    : m_type(type)
+    , m_length(0)
+    , m_nullCount(0)
+{
+    clear();
+}
+
+void ArrowColumn::appendInt32(int32_t value) {
+    appendValid(true);
+    const size_t at = m_values.size();
+    m_values.resize(at + sizeof(value));
+    std::memcpy(m_values.data() + at, &value, sizeof(value));
+}
+
+void ArrowColumn::appendDouble(double value) {
+    appendValid(true);
+    const size_t at = m_values.size();
+    m_values.resize(at + sizeof(value));
+    std::memcpy(m_values.data() + at, &value, sizeof(value));
+}
+
+void ArrowColumn::appendString(std::string_view utf8) {
+    appendValid(true);
+    m_values.insert(m_values.end(), utf8.begin(), utf8.end());
+    m_offsets.push_back(static_cast<int32_t>(m_values.size()));
+}
+
+void ArrowColumn::appendNull() {
+    appendValid(false);
+    switch (m_type) {
+    case Type::Int32: m_values.resize(m_values.size() + sizeof(int32_t), 0); break;
+    case Type::Float64: m_values.resize(m_values.size() + sizeof(double), 0); break;
+    case Type::Utf8: m_offsets.push_back(static_cast<int32_t>(m_values.size())); break;
+    }
+}
+
+void ArrowColumn::clear() {
+    m_length = 0;
+    m_nullCount = 0;
+    m_validity.clear();
+    m_values.clear();
+    m_offsets.clear();
+    if (m_type == Type::Utf8) m_offsets.push_back(0);
+}
+
+void ArrowColumn::appendValid(bool valid) {
+    if (m_length % 8 == 0) m_validity.push_back(0);
+    if (valid) {
+        m_validity.back() |= static_cast<uint8_t>(1u << (m_length % 8));
+    } else {
+        ++m_nullCount;
+    }
+    ++m_length;
+}
+
+ArrowWriter::ArrowWriter(Sink sink)
+    : m_sink(std::move(sink))
+    , m_offset(0)
+    , m_failed(false)
+{
+}
+
+bool ArrowWriter::begin(const std::vector<Field>& schema) {
+    m_schema = schema;
+    m_dictionaries.clear();
+    m_batches.clear();
+    if (!write(kMagic, sizeof(kMagic))) return false;
+
+    FlatBuilder b;
+    const FlatBuilder::Ref header = createSchema(b, m_schema);
+    return writeMessage(messageBytes(b, MessageHeader::Schema, header, 0), {}, nullptr);
+}
+
+bool ArrowWriter::writeDictionary(int64_t id, const ArrowColumn& values) {
+    Body body;
+    body.addColumn(values, values.m_validity, values.m_values, values.m_offsets);
+
+    FlatBuilder b;
+    const FlatBuilder::Ref data = createRecordBatch(b, values.length(), body);
+    b.startTable();
+    b.add<int64_t>(0, id);
+    b.addRef(1, data);
+    b.add<uint8_t>(2, 0); // isDelta
+    const FlatBuilder::Ref header = b.endTable();
+    return writeMessage(messageBytes(b, MessageHeader::DictionaryBatch, header, static_cast<int64_t>(body.data.size())),
+                        body.data, &m_dictionaries);
+}
+
+bool ArrowWriter::writeBatch(const std::vector<ArrowColumn>& columns) {
+    if (columns.size() != m_schema.size()) return false;
+    const int64_t length = columns.empty() ? 0 : columns.front().length();
+
+    Body body;
+    for (const ArrowColumn& column : columns) {
+        if (column.length() != length) return false;
+        body.addColumn(column, column.m_validity, column.m_values, column.m_offsets);
+    }
+
+    FlatBuilder b;
+    const FlatBuilder::Ref header = createRecordBatch(b, length, body);
+    return writeMessage(messageBytes(b, MessageHeader::RecordBatch, header, static_cast<int64_t>(body.data.size())),
+                        body.data, &m_batches);
+}
+
+bool ArrowWriter::finish() {
+    // End-of-stream marker, then the footer that indexes every block
+    const int32_t endOfStream[2] = {-1, 0};
+    if (!write(reinterpret_cast<const char*>(endOfStream), sizeof(endOfStream))) return false;
+
+    auto blockBytes = [](const std::vector<Block>& blocks) {
+        std::vector<uint8_t> bytes;
+        for (const Block& block : blocks) {
+            appendBytes<int64_t>(bytes, block.offset);
+            appendBytes<int32_t>(bytes, block.metadataLength);
+            appendBytes<int32_t>(bytes, 0);
+            appendBytes<int64_t>(bytes, block.bodyLength);
+        }
+        return bytes;
+    };
+
+    FlatBuilder b;
+    const FlatBuilder::Ref schema = createSchema(b, m_schema);
+    const FlatBuilder::Ref dictionaries = b.createStructVector(blockBytes(m_dictionaries), m_dictionaries.size(), 8);
+    const FlatBuilder::Ref batches = b.createStructVector(blockBytes(m_batches), m_batches.size(), 8);
+    b.startTable();
+    b.add<int16_t>(0, kMetadataV5);
+    b.addRef(1, schema);
+    b.addRef(2, dictionaries);
+    b.addRef(3, batches);
+    const std::vector<uint8_t> footer = b.finish(b.endTable());
+
+    const int32_t footerLength = static_cast<int32_t>(footer.size());
+    return write(reinterpret_cast<const char*>(footer.data()), footer.size())
+        && write(reinterpret_cast<const char*>(&footerLength), sizeof(footerLength))
+        && write(kMagic, 6);
+}
+
+bool ArrowWriter::write(const char* data, size_t size) {
+    if (m_failed) return false;
+    if (size > 0 && !m_sink(data, size)) {
+        m_failed = true;
+        return false;
+    }
+    m_offset += static_cast<int64_t>(size);
+    return true;
+}
+
+bool ArrowWriter::writeMessage(const std::vector<uint8_t>& metadata, const std::vector<char>& body,
+                               std::vector<Block>* blocks) {
+    // Continuation marker, metadata length (padded so the body starts
+    // 8-byte aligned), metadata, body
+    const int64_t start = m_offset;
+    const size_t padded = padTo8(metadata.size());
+    const int32_t prefix[2] = {-1, static_cast<int32_t>(padded)};
+    const char padding[8] = {};
+    if (!write(reinterpret_cast<const char*>(prefix), sizeof(prefix))
+        || !write(reinterpret_cast<const char*>(metadata.data()), metadata.size())
+        || !write(padding, padded - metadata.size())
+        || !write(body.data(), body.size())) {
+        return false;
+    }
+    if (blocks) {
+        blocks->push_back({start, static_cast<int32_t>(sizeof(prefix) + padded), static_cast<int64_t>(body.size())});
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Column of one Arrow record batch (or of a dictionary), filled row by row.
+// Fixed-width values and UTF-8 strings are kept in the layout Arrow stores
+// on disk, so writing a batch is a handful of block copies.
+class ArrowColumn {
+public:
+    enum class Type { Int32, Float64, Utf8 };
+
+    explicit ArrowColumn(Type type);
+
+    Type type() const { return m_type; }
+    int64_t length() const { return m_length; }
+    int64_t nullCount() const { return m_nullCount; }
+
+    void appendInt32(int32_t value);
+    void appendDouble(double value);
+    void appendString(std::string_view utf8);
+    void appendNull();
+    void clear();
+
+private:
+    friend class ArrowWriter;
+
+    void appendValid(bool valid);
+
+    Type m_type;
+    int64_t m_length;
+    int64_t m_nullCount;
+    std::vector<uint8_t> m_validity; // One bit per row, set when not null
+    std::vector<char> m_values;      // Fixed-width values, or UTF-8 bytes
+    std::vector<int32_t> m_offsets;  // Utf8 only: length + 1 offsets into m_values
+};
+
+// Apache Arrow IPC file writer (the format of Feather v2 files), for the
+// few types labels need: int32, float64 and UTF-8 strings, the latter
+// optionally dictionary-encoded with int32 indices. Everything goes through
+// the sink in order, one batch at a time, so no more than a batch is ever
+// held in memory. The flatbuffer metadata is encoded here directly.
+//
+// Usage: begin() with the schema, writeDictionary() once for each dictionary,
+// writeBatch() any number of times, then finish().
+class ArrowWriter {
+public:
+    struct Field {
+        std::string name;
+        ArrowColumn::Type type = ArrowColumn::Type::Int32;
+        bool nullable = true;
+        int64_t dictionary = -1; // Id of the Utf8 dictionary; values are Int32 indices into it
+    };
+
+    // Receives the file's bytes in order; false stops the writer
+    using Sink = std::function<bool(const char* data, size_t size)>;
+
+    explicit ArrowWriter(Sink sink);
+
+    bool begin(const std::vector<Field>& schema);
+    bool writeDictionary(int64_t id, const ArrowColumn& values);
+    // One column per schema field, all of the same length
+    bool writeBatch(const std::vector<ArrowColumn>& columns);
+    bool finish();
+
+private:
+    struct Block {
+        int64_t offset;
+        int32_t metadataLength;
+        int64_t bodyLength;
+    };
+
+    bool write(const char* data, size_t size);
+    bool writeMessage(const std::vector<uint8_t>& metadata, const std::vector<char>& body, std::vector<Block>* blocks);
+
+    Sink m_sink;
+    std::vector<Field> m_schema;
+    std::vector<Block> m_dictionaries;
+    std::vector<Block> m_batches;
+    int64_t m_offset;
+    bool m_failed;
+};
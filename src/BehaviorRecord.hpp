@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 #include <optional>
 
 struct BehaviorRecord {
@@ -8,8 +9,12 @@ struct BehaviorRecord {
     QString role;
     QString behaviour;
     QString parentBehaviour;
+    // PTS in seconds of the frame on screen when the record was started/ended
     double startTime = 0.0;
     std::optional<double> endTime;
+    // Frame numbers in presentation order (unknown if nothing was shown yet)
+    std::optional<int> startFrame;
+    std::optional<int> endFrame;
     double duration = 0.0;
     QString recordType; // "EVENT" or "STATE"
     QString tag;
@@ -31,6 +36,20 @@ struct BehaviorRecord {
             .arg(secs, 2, 10, QChar('0'));
     }
     
+    // Inverse of formatTime; also accepts H:MM:SS and plain seconds
+    static std::optional<double> parseTime(const QString& text) {
+        const QStringList parts = text.trimmed().split(':');
+        if (parts.size() > 3) return std::nullopt;
+        double seconds = 0.0;
+        for (const QString& part : parts) {
+            bool ok = false;
+            double value = part.toDouble(&ok);
+            if (!ok || value < 0.0) return std::nullopt;
+            seconds = seconds * 60.0 + value;
+        }
+        return seconds;
+    }
+    
     QString startTimeStr() const {
         return formatTime(startTime);
     }
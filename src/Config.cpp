@@ -7,6 +7,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QDebug>
+#include <algorithm>
 
 Config& Config::instance() {
     static Config instance;
@@ -119,7 +120,54 @@ bool Config::load(const QString& path) {
         }
     }
     
+    // Parse playback settings
+    m_decoderBackend = VideoDecoder::defaultBackend();
+    m_decoderThreads = 0;
+    m_bufferMegabytes = kDefaultBufferMegabytes;
+    m_frameCacheMegabytes = kDefaultFrameCacheMegabytes;
+    m_readaheadMegabytes = kDefaultReadaheadMegabytes;
+    m_memoryMap = false;
+    m_proxiesEnabled = true;
+    m_proxyHeight = kDefaultProxyHeight;
+    m_proxyMinSourceHeight = kDefaultProxyMinSourceHeight;
+    m_proxyThreads = kDefaultProxyThreads;
+    m_replaySeconds = kDefaultReplaySeconds;
+    if (root.contains("playback") && root["playback"].isObject()) {
+        QJsonObject playback = root["playback"].toObject();
+        QString backend = playback["decoder"].toString().toLower();
+        if (VideoDecoder::availableBackends().contains(backend)) {
+            m_decoderBackend = backend;
+        } else if (!backend.isEmpty()) {
+            qWarning() << "Decoder" << backend << "is not available in this build; using" << m_decoderBackend;
+        }
+        m_decoderThreads = std::max(0, playback["decoder_threads"].toInt(0));
+        m_bufferMegabytes = std::max(kMinBufferMegabytes, playback["buffer_mb"].toInt(kDefaultBufferMegabytes));
+        m_frameCacheMegabytes = std::max(kMinFrameCacheMegabytes, playback["frame_cache_mb"].toInt(kDefaultFrameCacheMegabytes));
+        m_readaheadMegabytes = std::max(0, playback["readahead_mb"].toInt(kDefaultReadaheadMegabytes));
+        m_memoryMap = playback["memory_map"].toBool(false);
+        m_proxiesEnabled = playback["proxies"].toBool(true);
+        m_proxyHeight = std::clamp(playback["proxy_height"].toInt(kDefaultProxyHeight), 144, 2160);
+        m_proxyMinSourceHeight = std::max(0, playback["proxy_min_height"].toInt(kDefaultProxyMinSourceHeight));
+        m_proxyThreads = std::clamp(playback["proxy_threads"].toInt(kDefaultProxyThreads), 1, 8);
+        m_replaySeconds = std::clamp(playback["replay_seconds"].toDouble(kDefaultReplaySeconds), 2.0, 60.0);
+    }
+    
     qDebug() << "Loaded" << m_behaviorCategories.size() << "behavior categories";
     return true;
 }
 
+
+RecordStore::Vocabulary Config::recordVocabulary() const {
+    RecordStore::Vocabulary vocabulary;
+    vocabulary.roles = m_roles;
+    vocabulary.groupTypes = m_groupTypes;
+    vocabulary.sexes = m_sexes;
+    vocabulary.stages = m_stages;
+    for (const BehaviorCategory& category : m_behaviorCategories) {
+        vocabulary.parentBehaviours.append(category.name);
+        for (const BehaviorInfo& behavior : category.behaviors) {
+            vocabulary.behaviours.append(behavior.name);
+        }
+    }
+    return vocabulary;
+}
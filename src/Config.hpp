@@ -5,6 +5,9 @@
 #include <QMap>
 #include <QVector>
 
+#include "RecordStore.hpp"
+#include "VideoDecoder.hpp"
+
 struct BehaviorInfo {
     QString name;
     QString type; // "EVENT" or "STATE"
@@ -27,6 +30,27 @@ public:
     const QStringList& sexes() const { return m_sexes; }
     const QStringList& stages() const { return m_stages; }
     const QStringList& groupTypes() const { return m_groupTypes; }
+    // Dictionaries for a RecordStore, in the order of this file
+    RecordStore::Vocabulary recordVocabulary() const;
+    
+    // Playback settings ("playback" section, optional)
+    const QString& decoderBackend() const { return m_decoderBackend; }
+    void setDecoderBackend(const QString& backend) { m_decoderBackend = backend; }
+    int decoderThreads() const { return m_decoderThreads; }
+    // Memory for decoded frames queued ahead of the display, per open video
+    int bufferMegabytes() const { return m_bufferMegabytes; }
+    // Memory for recently decoded frames kept for replays and steps, per open video
+    int frameCacheMegabytes() const { return m_frameCacheMegabytes; }
+    // Input readahead for videos on slow media (0 = off) and whether to map the file instead
+    int readaheadMegabytes() const { return m_readaheadMegabytes; }
+    bool memoryMap() const { return m_memoryMap; }
+    // Background proxies for heavy (4K/5.3K) sources
+    bool proxiesEnabled() const { return m_proxiesEnabled; }
+    int proxyHeight() const { return m_proxyHeight; }
+    int proxyMinSourceHeight() const { return m_proxyMinSourceHeight; }
+    int proxyThreads() const { return m_proxyThreads; }
+    // Length of the instant replay / A-B loop history
+    double replaySeconds() const { return m_replaySeconds; }
     
     QString lastError() const { return m_lastError; }
 
@@ -40,6 +64,26 @@ private:
     QStringList m_sexes;
     QStringList m_stages;
     QStringList m_groupTypes;
+    QString m_decoderBackend = VideoDecoder::defaultBackend();
+    int m_decoderThreads = 0;
+    static constexpr int kDefaultBufferMegabytes = 256;
+    static constexpr int kMinBufferMegabytes = 16;
+    int m_bufferMegabytes = kDefaultBufferMegabytes;
+    static constexpr int kDefaultFrameCacheMegabytes = 512;
+    static constexpr int kMinFrameCacheMegabytes = 64;
+    int m_frameCacheMegabytes = kDefaultFrameCacheMegabytes;
+    static constexpr int kDefaultReadaheadMegabytes = 32;
+    int m_readaheadMegabytes = kDefaultReadaheadMegabytes;
+    bool m_memoryMap = false;
+    static constexpr int kDefaultProxyHeight = 540;
+    static constexpr int kDefaultProxyMinSourceHeight = 1440;
+    static constexpr int kDefaultProxyThreads = 2;
+    bool m_proxiesEnabled = true;
+    int m_proxyHeight = kDefaultProxyHeight;
+    int m_proxyMinSourceHeight = kDefaultProxyMinSourceHeight;
+    int m_proxyThreads = kDefaultProxyThreads;
+    static constexpr double kDefaultReplaySeconds = 10.0;
+    double m_replaySeconds = kDefaultReplaySeconds;
     QString m_lastError;
 };
 
@@ -1,66 +1,210 @@
 #include "CsvExporter.hpp"
+#include "CsvWriter.hpp"
 
 #include <QFile>
-#include <QTextStream>
 #include <QFileInfo>
 #include <QDir>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr qint64 kProgressRows = 4096; // Rows between progress reports and cancel checks
+
+const char* const kHeader =
+    "session,role,behaviour,parent_behaviour,start_time,end_time,"
+    "duration,record_type,tag,group_type,sex,observations,stage,"
+    "group_size,mother_and_calf,calves,start_time_str,end_time_str,"
+    "start_frame,end_frame,start_pts,end_pts";
+
+// One line of the file. Text fields are escaped UTF-8, either pointing into
+// the escaped dictionaries or filled in per record.
+struct CsvRow {
+    int session = 1;
+    std::string_view role;
+    std::string_view behaviour;
+    std::string_view parentBehaviour;
+    double startTime = 0.0;
+    std::optional<double> endTime;
+    double duration = 0.0;
+    std::string_view recordType;
+    std::string_view tag;
+    std::string_view groupType;
+    std::string_view sex;
+    QStringView observations; // Escaped while writing
+    std::string_view stage;
+    std::optional<int> groupSize;
+    std::optional<int> motherAndCalf;
+    std::optional<int> calves;
+    std::optional<int> startFrame;
+    std::optional<int> endFrame;
+};
+
+void writeHeader(CsvWriter& out) {
+    out.raw(kHeader);
+    out.endRow();
+}
+
+void writeRow(CsvWriter& out, const CsvRow& r) {
+    out.number(r.session); out.separator();
+    out.raw(r.role); out.separator();
+    out.raw(r.behaviour); out.separator();
+    out.raw(r.parentBehaviour); out.separator();
+    out.number(r.startTime, 3); out.separator();
+    out.optionalNumber(r.endTime, 3); out.separator();
+    out.number(r.duration, 3); out.separator();
+    out.raw(r.recordType); out.separator();
+    out.raw(r.tag); out.separator();
+    out.raw(r.groupType); out.separator();
+    out.raw(r.sex); out.separator();
+    out.text(r.observations); out.separator();
+    out.raw(r.stage); out.separator();
+    out.optionalNumber(r.groupSize); out.separator();
+    out.optionalNumber(r.motherAndCalf); out.separator();
+    out.optionalNumber(r.calves); out.separator();
+    out.time(r.startTime); out.separator();
+    if (r.endTime) out.time(*r.endTime);
+    out.separator();
+    out.optionalNumber(r.startFrame); out.separator();
+    out.optionalNumber(r.endFrame); out.separator();
+    out.number(r.startTime, 6); out.separator();
+    out.optionalNumber(r.endTime, 6);
+    out.endRow();
+}
+
+// Report progress every few thousand rows; false once cancelled
+bool checkpoint(const CsvExporter::Progress& progress, qint64 done, qint64 total) {
+    if (done % kProgressRows != 0) return true;
+    if (progress.cancel && progress.cancel->load(std::memory_order_relaxed)) return false;
+    if (progress.report) progress.report(done, total);
+    return true;
+}
+
+bool finish(CsvWriter& out, bool completed, const CsvExporter::Progress& progress, qint64 done, qint64 total) {
+    if (!completed) {
+        out.cancel();
+        return false;
+    }
+    if (!out.commit()) return false;
+    if (progress.report) progress.report(done, total);
+    return true;
+}
+
+} // namespace
 
 bool CsvExporter::exportRecords(const QString& filePath, 
-                                const QVector<BehaviorRecord>& records) {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                                const RecordStore& records,
+                                const Progress& progress) {
+    CsvWriter out;
+    if (!out.open(filePath)) {
         return false;
     }
+    writeHeader(out);
     
-    QTextStream out(&file);
+    // Dictionary values are escaped once, not once per record
+    using Field = RecordStore::Field;
+    std::vector<std::string> escaped[static_cast<int>(Field::FIELD_COUNT)];
+    for (int f = 0; f < static_cast<int>(Field::FIELD_COUNT); ++f) {
+        const StringDictionary& dictionary = records.dictionary(static_cast<Field>(f));
+        escaped[f].reserve(dictionary.size());
+        for (int code = 0; code < dictionary.size(); ++code) {
+            escaped[f].push_back(out.escape(dictionary.value(static_cast<uint32_t>(code))));
+        }
+    }
+    auto field = [&escaped](const RecordStore::Row& r, Field f) -> std::string_view {
+        return escaped[static_cast<int>(f)][r.code(f)];
+    };
     
-    // Write header
-    out << "session,role,behaviour,parent_behaviour,start_time,end_time,"
-        << "duration,record_type,tag,group_type,sex,observations,stage,"
-        << "group_size,mother_and_calf,calves,start_time_str,end_time_str\n";
+    const qint64 total = records.size();
+    qint64 done = 0;
+    bool completed = true;
+    CsvRow row;
+    for (const RecordStore::Row& r : records) {
+        row.session = r.session();
+        row.role = field(r, Field::Role);
+        row.behaviour = field(r, Field::Behaviour);
+        row.parentBehaviour = field(r, Field::ParentBehaviour);
+        row.startTime = r.startTime();
+        row.endTime = r.endTime();
+        row.duration = r.duration();
+        row.recordType = field(r, Field::RecordType);
+        row.tag = field(r, Field::Tag);
+        row.groupType = field(r, Field::GroupType);
+        row.sex = field(r, Field::Sex);
+        row.observations = r.observations();
+        row.stage = field(r, Field::Stage);
+        row.groupSize = r.groupSize();
+        row.motherAndCalf = r.motherAndCalf();
+        row.calves = r.calves();
+        row.startFrame = r.startFrame();
+        row.endFrame = r.endFrame();
+        writeRow(out, row);
+        if (!checkpoint(progress, ++done, total)) {
+            completed = false;
+            break;
+        }
+    }
     
-    // Write records
-    for (const BehaviorRecord& r : records) {
-        // Helper to escape CSV fields
-        auto escapeField = [](const QString& s) -> QString {
-            if (s.contains(',') || s.contains('"') || s.contains('\n')) {
-                QString escaped = s;
-                escaped.replace("\"", "\"\"");
-                return "\"" + escaped + "\"";
-            }
-            return s;
-        };
-        
-        auto optIntToStr = [](const std::optional<int>& opt) -> QString {
-            return opt.has_value() ? QString::number(opt.value()) : "";
-        };
-        
-        auto optDoubleToStr = [](const std::optional<double>& opt) -> QString {
-            return opt.has_value() ? QString::number(opt.value(), 'f', 3) : "";
-        };
-        
-        out << r.session << ","
-            << escapeField(r.role) << ","
-            << escapeField(r.behaviour) << ","
-            << escapeField(r.parentBehaviour) << ","
-            << QString::number(r.startTime, 'f', 3) << ","
-            << optDoubleToStr(r.endTime) << ","
-            << QString::number(r.duration, 'f', 3) << ","
-            << escapeField(r.recordType) << ","
-            << escapeField(r.tag) << ","
-            << escapeField(r.groupType) << ","
-            << escapeField(r.sex) << ","
-            << escapeField(r.observations) << ","
-            << escapeField(r.stage) << ","
-            << optIntToStr(r.groupSize) << ","
-            << optIntToStr(r.motherAndCalf) << ","
-            << optIntToStr(r.calves) << ","
-            << r.startTimeStr() << ","
-            << r.endTimeStr() << "\n";
+    return finish(out, completed, progress, done, total);
+}
+
+bool CsvExporter::exportRecords(const QString& filePath,
+                                const std::function<bool(BehaviorRecord&)>& next,
+                                qint64 total,
+                                const Progress& progress) {
+    CsvWriter out;
+    if (!out.open(filePath)) {
+        return false;
     }
+    writeHeader(out);
     
-    file.close();
-    return true;
+    // Records from a stream repeat the same few values; remember the last
+    // escaped form of each field instead of escaping it every time
+    struct Cached {
+        QString value;
+        std::string escaped;
+    };
+    Cached cache[8];
+    auto field = [&out, &cache](int slot, const QString& value) -> std::string_view {
+        Cached& c = cache[slot];
+        if (c.value != value) {
+            c.value = value;
+            c.escaped = out.escape(value);
+        }
+        return c.escaped;
+    };
+    
+    qint64 done = 0;
+    bool completed = true;
+    BehaviorRecord r;
+    CsvRow row;
+    while (next(r)) {
+        row.session = r.session;
+        row.role = field(0, r.role);
+        row.behaviour = field(1, r.behaviour);
+        row.parentBehaviour = field(2, r.parentBehaviour);
+        row.startTime = r.startTime;
+        row.endTime = r.endTime;
+        row.duration = r.duration;
+        row.recordType = field(3, r.recordType);
+        row.tag = field(4, r.tag);
+        row.groupType = field(5, r.groupType);
+        row.sex = field(6, r.sex);
+        row.observations = r.observations;
+        row.stage = field(7, r.stage);
+        row.groupSize = r.groupSize;
+        row.motherAndCalf = r.motherAndCalf;
+        row.calves = r.calves;
+        row.startFrame = r.startFrame;
+        row.endFrame = r.endFrame;
+        writeRow(out, row);
+        if (!checkpoint(progress, ++done, total)) {
+            completed = false;
+            break;
+        }
+    }
+    
+    return finish(out, completed, progress, done, total);
 }
 
 QString CsvExporter::generateUniqueFilePath(const QString& directory, 
@@ -1,16 +1,31 @@
 #pragma once
 
-#include "BehaviorRecord.hpp"
+#include "RecordStore.hpp"
 #include <QString>
-#include <QVector>
+#include <atomic>
+#include <functional>
 
 class CsvExporter {
 public:
+    // Optional progress reporting and cancellation, for exports run off the
+    // GUI thread. report() is called every few thousand rows from the
+    // exporting thread; a cancelled export leaves no file behind.
+    struct Progress {
+        std::function<void(qint64 done, qint64 total)> report;
+        const std::atomic<bool>* cancel = nullptr;
+    };
+
     static bool exportRecords(const QString& filePath, 
-                              const QVector<BehaviorRecord>& records);
+                              const RecordStore& records,
+                              const Progress& progress = Progress());
+    // Streaming export: next() fills in the following record and returns
+    // false when there are no more; total is only used for progress
+    static bool exportRecords(const QString& filePath,
+                              const std::function<bool(BehaviorRecord&)>& next,
+                              qint64 total = 0,
+                              const Progress& progress = Progress());
     
     // Generate a unique filename (auto-increment if exists)
     static QString generateUniqueFilePath(const QString& directory, 
                                           const QString& baseName);
 };
-
@@ -0,0 +1,578 @@
+#include "CsvImporter.hpp"
+
+#include <QFile>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+// SSE2 is part of every x86-64 CPU, so no dispatch is needed
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ETHOWILD_CSV_SSE2
+#endif
+
+namespace {
+
+constexpr qint64 kMinChunkBytes = 4 * 1024 * 1024;
+constexpr int kChunksPerThread = 4;      // Smaller pieces even out the load
+constexpr int kCancelCheckRows = 16 * 1024;
+
+enum Column {
+    SessionColumn, RoleColumn, BehaviourColumn, ParentBehaviourColumn, StartTimeColumn, EndTimeColumn,
+    DurationColumn, RecordTypeColumn, TagColumn, GroupTypeColumn, SexColumn, ObservationsColumn, StageColumn,
+    GroupSizeColumn, MotherAndCalfColumn, CalvesColumn, StartFrameColumn, EndFrameColumn, StartPtsColumn,
+    EndPtsColumn, COLUMN_COUNT
+};
+
+// Header names, as written by CsvExporter; the MM:SS columns are derived
+// and not read back
+const char* const kColumnNames[COLUMN_COUNT] = {
+    "session", "role", "behaviour", "parent_behaviour", "start_time", "end_time",
+    "duration", "record_type", "tag", "group_type", "sex", "observations", "stage",
+    "group_size", "mother_and_calf", "calves", "start_frame", "end_frame", "start_pts",
+    "end_pts"
+};
+
+using Field = RecordStore::Field;
+using Issue = CsvImporter::Issue;
+
+// First ',', '\n' or '\r' at or after p, or end
+const char* findDelimiter(const char* p, const char* end) {
+#ifdef ETHOWILD_CSV_SSE2
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; end - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, lf)),
+                                          _mm_cmpeq_epi8(v, cr));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0) return p + std::countr_zero(mask);
+    }
+#endif
+    while (p < end && *p != ',' && *p != '\n' && *p != '\r') ++p;
+    return p;
+}
+
+// First '"' or '\n' at or after p, or end
+const char* findQuoteOrNewline(const char* p, const char* end) {
+#ifdef ETHOWILD_CSV_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, lf))));
+        if (mask != 0) return p + std::countr_zero(mask);
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\n') ++p;
+    return p;
+}
+
+const char* findQuote(const char* p, const char* end) {
+    const void* hit = std::memchr(p, '"', static_cast<size_t>(end - p));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+void countQuotesAndNewlines(const char* p, const char* end, qint64& quotes, qint64& newlines) {
+    quotes = 0;
+    newlines = 0;
+#ifdef ETHOWILD_CSV_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        quotes += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote))));
+        newlines += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf))));
+    }
+#endif
+    for (; p < end; ++p) {
+        quotes += *p == '"';
+        newlines += *p == '\n';
+    }
+}
+
+// Start of the first row after p, knowing whether p is inside a quoted
+// field: every quote toggles, and the row starts after a newline outside
+// quotes. Counts the newlines passed.
+const char* nextRowStart(const char* p, const char* end, bool inQuotes, qint64& newlines) {
+    while (p < end) {
+        p = findQuoteOrNewline(p, end);
+        if (p == end) break;
+        if (*p++ == '"') {
+            inQuotes = !inQuotes;
+        } else {
+            ++newlines;
+            if (!inQuotes) return p;
+        }
+    }
+    return end;
+}
+
+std::string_view trimmed(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool parseInt(std::string_view text, std::optional<int>& value) {
+    text = trimmed(text);
+    value.reset();
+    if (text.empty()) return true;
+    int v = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), v);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) return false;
+    value = v;
+    return true;
+}
+
+bool parseDouble(std::string_view text, std::optional<double>& value) {
+    text = trimmed(text);
+    value.reset();
+    if (text.empty()) return true;
+    double v = 0.0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), v);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size() || !std::isfinite(v)) return false;
+    value = v;
+    return true;
+}
+
+// Splits one row into fields, undoing the quoting
+class RowParser {
+public:
+    std::vector<std::string_view> fields;
+    qint64 lines = 0; // Newlines the row spanned
+
+    // Reads the row at p and moves p to the next one; false if the quoting
+    // is broken (the rest of the line is then skipped)
+    bool parse(const char*& p, const char* end) {
+        fields.clear();
+        lines = 0;
+        while (true) {
+            if (p < end && *p == '"') {
+                // Deque: growing it keeps the earlier fields in place
+                if (m_unquoted.size() <= fields.size()) m_unquoted.resize(fields.size() + 1);
+                std::string& value = m_unquoted[fields.size()];
+                value.clear();
+                ++p;
+                while (true) {
+                    const char* quote = findQuote(p, end);
+                    if (quote == end) {
+                        lines += std::count(p, end, '\n');
+                        p = end;
+                        return false;
+                    }
+                    value.append(p, quote);
+                    p = quote + 1;
+                    if (p < end && *p == '"') {
+                        value.push_back('"');
+                        ++p;
+                        continue;
+                    }
+                    break;
+                }
+                // Line breaks in a field read back as "\n", whatever wrote the file
+                const size_t crlf = value.find("\r\n");
+                if (crlf != std::string::npos) {
+                    size_t out = crlf;
+                    for (size_t i = crlf; i < value.size(); ++i) {
+                        if (value[i] == '\r' && i + 1 < value.size() && value[i + 1] == '\n') continue;
+                        value[out++] = value[i];
+                    }
+                    value.resize(out);
+                }
+                lines += std::count(value.begin(), value.end(), '\n');
+                fields.emplace_back(value);
+            } else {
+                const char* delimiter = findDelimiter(p, end);
+                fields.emplace_back(p, static_cast<size_t>(delimiter - p));
+                p = delimiter;
+            }
+
+            if (p >= end) return true;
+            if (*p == ',') {
+                ++p;
+                continue;
+            }
+            if (*p == '\r' || *p == '\n') {
+                if (*p == '\r') ++p;
+                if (p < end && *p == '\n') ++p;
+                ++lines;
+                return true;
+            }
+            // Text after a closing quote
+            const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            p = newline ? static_cast<const char*>(newline) + 1 : end;
+            if (newline) ++lines;
+            return false;
+        }
+    }
+
+private:
+    std::deque<std::string> m_unquoted;
+};
+
+struct SourceFile {
+    QString path;
+    std::unique_ptr<QFile> file;
+    QByteArray contents; // When the file cannot be mapped
+    const char* data = nullptr;
+    qint64 size = 0;
+    qint64 dataStart = 0;     // First byte after the header
+    qint64 dataStartLine = 0; // Its line number
+    int columns[COLUMN_COUNT]; // Field of each known column, -1 if missing
+    int fieldCount = 0;
+    std::vector<Issue> issues; // About the file as a whole
+};
+
+struct Chunk {
+    int file = 0;
+    qint64 begin = 0;
+    qint64 end = 0;
+    qint64 quotes = 0;
+    qint64 newlines = 0;
+    bool inQuotes = false; // At begin
+    qint64 line = 0;       // Line number at begin
+    std::unique_ptr<RecordStore> records;
+    std::vector<Issue> issues;
+    qint64 issueCount = 0;
+    qint64 skippedRows = 0;
+};
+
+// Accepted values of each dictionary-coded field; null for any value
+struct Vocabularies {
+    QSet<QString> values[static_cast<int>(Field::FIELD_COUNT)];
+    bool checked[static_cast<int>(Field::FIELD_COUNT)] = {};
+
+    explicit Vocabularies(const RecordStore::Vocabulary& v) {
+        auto set = [this](Field field, const QStringList& list) {
+            values[static_cast<int>(field)] = QSet<QString>(list.begin(), list.end());
+            checked[static_cast<int>(field)] = !list.isEmpty();
+        };
+        set(Field::Role, v.roles);
+        set(Field::Behaviour, v.behaviours);
+        set(Field::ParentBehaviour, v.parentBehaviours);
+        set(Field::RecordType, {"EVENT", "STATE"});
+        set(Field::GroupType, v.groupTypes);
+        set(Field::Sex, v.sexes);
+        set(Field::Stage, v.stages);
+    }
+};
+
+class ChunkParser {
+public:
+    ChunkParser(const SourceFile& file, Chunk& chunk, const Vocabularies& vocabularies)
+        : m_file(file), m_chunk(chunk), m_vocabularies(vocabularies) {}
+
+    void run(const std::atomic<bool>* cancel) {
+        const char* data = m_file.data;
+        const char* fileEnd = data + m_file.size;
+        const char* p = data + m_chunk.begin;
+        const char* end = data + m_chunk.end;
+        qint64 line = m_chunk.line;
+        // Rows belong to the chunk they start in. Scanning from the byte
+        // before begin keeps a row that starts right at begin.
+        if (m_chunk.begin != m_file.dataStart) {
+            const char* before = p - 1;
+            const bool inQuotes = m_chunk.inQuotes != (*before == '"');
+            if (*before == '\n') --line;
+            p = nextRowStart(before, fileEnd, inQuotes, line);
+        }
+
+        qint64 rows = 0;
+        while (p < end) {
+            const qint64 rowLine = line;
+            // A row may run past the chunk's end
+            const bool wellFormed = m_parser.parse(p, fileEnd);
+            line += m_parser.lines;
+            if (wellFormed) {
+                addRow(rowLine);
+            } else {
+                report(rowLine, 0, QStringLiteral("Unbalanced quotes"), true);
+            }
+            if (++rows % kCancelCheckRows == 0 && cancel && cancel->load(std::memory_order_relaxed)) return;
+        }
+    }
+
+private:
+    struct CachedText {
+        QString value;
+        bool known = true;
+    };
+
+    std::string_view field(Column column) const {
+        const int index = m_file.columns[column];
+        return index < 0 ? std::string_view() : m_parser.fields[index];
+    }
+
+    void report(qint64 line, int column, const QString& message, bool skipped) {
+        ++m_chunk.issueCount;
+        if (static_cast<int>(m_chunk.issues.size()) < CsvImporter::MAX_ISSUES) {
+            m_chunk.issues.push_back({m_file.path, line, column, message, skipped});
+        }
+    }
+
+    void reportValue(qint64 line, Column column, const QString& message, bool skipped) {
+        report(line, m_file.columns[column] + 1,
+               QString("%1: \"%2\" %3").arg(QLatin1String(kColumnNames[column]), QString::fromUtf8(field(column)), message),
+               skipped);
+    }
+
+    // Values repeat, so each distinct one is converted and checked once
+    QString text(Column column, Field dictionary, qint64 line) {
+        const std::string_view value = field(column);
+        if (value.empty()) return QString();
+
+        auto& cache = m_texts[static_cast<int>(dictionary)];
+        auto it = cache.find(value);
+        if (it == cache.end()) {
+            CachedText cached;
+            cached.value = QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
+            const int d = static_cast<int>(dictionary);
+            cached.known = !m_vocabularies.checked[d] || m_vocabularies.values[d].contains(cached.value);
+            // The key must outlive this row
+            m_keys.emplace_back(value);
+            it = cache.emplace(m_keys.back(), std::move(cached)).first;
+        }
+        if (!it->second.known) reportValue(line, column, QStringLiteral("is not in behaviors.json"), false);
+        return it->second.value;
+    }
+
+    void addRow(qint64 line) {
+        const std::vector<std::string_view>& fields = m_parser.fields;
+        if (fields.size() == 1 && fields[0].empty()) return; // Blank line
+        if (static_cast<int>(fields.size()) != m_file.fieldCount) {
+            report(line, 0, QString("Expected %1 fields, found %2").arg(m_file.fieldCount).arg(static_cast<int>(fields.size())),
+                   true);
+            ++m_chunk.skippedRows;
+            return;
+        }
+
+        bool ok = true;
+        auto integer = [&](Column column, std::optional<int>& value) {
+            if (!parseInt(field(column), value)) {
+                reportValue(line, column, QStringLiteral("is not a whole number"), true);
+                ok = false;
+            }
+        };
+        auto real = [&](Column column, std::optional<double>& value) {
+            if (!parseDouble(field(column), value)) {
+                reportValue(line, column, QStringLiteral("is not a number"), true);
+                ok = false;
+            }
+        };
+
+        BehaviorRecord& r = m_record;
+        std::optional<int> session;
+        integer(SessionColumn, session);
+        r.session = session.value_or(1);
+
+        // The PTS columns carry more decimals than the time columns
+        std::optional<double> start;
+        real(StartPtsColumn, start);
+        if (!start) real(StartTimeColumn, start);
+        real(EndPtsColumn, r.endTime);
+        if (!r.endTime) real(EndTimeColumn, r.endTime);
+        std::optional<double> duration;
+        real(DurationColumn, duration);
+        integer(GroupSizeColumn, r.groupSize);
+        integer(MotherAndCalfColumn, r.motherAndCalf);
+        integer(CalvesColumn, r.calves);
+        integer(StartFrameColumn, r.startFrame);
+        integer(EndFrameColumn, r.endFrame);
+        if (ok && !start) {
+            report(line, m_file.columns[StartTimeColumn] + 1, QStringLiteral("No start time"), true);
+            ok = false;
+        }
+        if (!ok) {
+            ++m_chunk.skippedRows;
+            return;
+        }
+        r.startTime = *start;
+        r.duration = duration.value_or(r.endTime ? *r.endTime - r.startTime : 0.0);
+
+        r.role = text(RoleColumn, Field::Role, line);
+        r.behaviour = text(BehaviourColumn, Field::Behaviour, line);
+        r.parentBehaviour = text(ParentBehaviourColumn, Field::ParentBehaviour, line);
+        r.recordType = text(RecordTypeColumn, Field::RecordType, line);
+        r.tag = text(TagColumn, Field::Tag, line);
+        r.groupType = text(GroupTypeColumn, Field::GroupType, line);
+        r.sex = text(SexColumn, Field::Sex, line);
+        r.stage = text(StageColumn, Field::Stage, line);
+        const std::string_view observations = field(ObservationsColumn);
+        r.observations = QString::fromUtf8(observations.data(), static_cast<qsizetype>(observations.size()));
+
+        m_chunk.records->append(r);
+    }
+
+    const SourceFile& m_file;
+    Chunk& m_chunk;
+    const Vocabularies& m_vocabularies;
+    RowParser m_parser;
+    BehaviorRecord m_record;
+    std::unordered_map<std::string_view, CachedText> m_texts[static_cast<int>(Field::FIELD_COUNT)];
+    std::deque<std::string> m_keys;
+};
+
+// Maps the file and reads its header; false (with an issue) if it cannot be imported
+bool openSource(SourceFile& source) {
+    auto fail = [&source](const QString& message) {
+        source.issues.push_back({source.path, 0, 0, message, true});
+        return false;
+    };
+
+    source.file = std::make_unique<QFile>(source.path);
+    if (!source.file->open(QIODevice::ReadOnly)) return fail("Cannot open file: " + source.file->errorString());
+    source.size = source.file->size();
+    if (source.size == 0) return fail(QStringLiteral("The file is empty"));
+    if (uchar* mapped = source.file->map(0, source.size)) {
+        source.data = reinterpret_cast<const char*>(mapped);
+    } else {
+        source.contents = source.file->readAll();
+        source.data = source.contents.constData();
+        source.size = source.contents.size();
+    }
+
+    const char* p = source.data;
+    const char* end = source.data + source.size;
+    if (source.size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3; // UTF-8 BOM
+    RowParser header;
+    if (!header.parse(p, end)) return fail(QStringLiteral("Unbalanced quotes in the header"));
+    source.dataStart = p - source.data;
+    source.dataStartLine = 1 + header.lines;
+    source.fieldCount = static_cast<int>(header.fields.size());
+
+    std::fill(std::begin(source.columns), std::end(source.columns), -1);
+    for (int i = 0; i < source.fieldCount; ++i) {
+        const std::string_view text = trimmed(header.fields[i]);
+        const QString name = QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size())).toLower();
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            if (name == QLatin1String(kColumnNames[c]) && source.columns[c] < 0) source.columns[c] = i;
+        }
+    }
+    if (source.columns[BehaviourColumn] < 0
+        || (source.columns[StartTimeColumn] < 0 && source.columns[StartPtsColumn] < 0)) {
+        return fail(QStringLiteral("Not a records file: no behaviour or start_time column"));
+    }
+    return true;
+}
+
+template <typename Work>
+void parallelFor(int count, int threads, Work&& work) {
+    std::atomic<int> next(0);
+    auto loop = [&] {
+        for (int i = next++; i < count; i = next++) work(i);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < std::min(threads, count); ++t) pool.emplace_back(loop);
+    loop();
+    for (std::thread& thread : pool) thread.join();
+}
+
+} // namespace
+
+CsvImporter::CsvImporter(const RecordStore::Vocabulary& vocabulary, int threads)
+    : m_vocabulary(vocabulary)
+    , m_threads(threads > 0 ? threads : std::max(1, QThread::idealThreadCount()))
+{
+}
+
+CsvImporter::Result CsvImporter::importFiles(const QStringList& paths, const CsvExporter::Progress& progress) const {
+    const Vocabularies vocabularies(m_vocabulary);
+    auto cancelled = [&progress] { return progress.cancel && progress.cancel->load(std::memory_order_relaxed); };
+
+    // Headers first, then every file cut into chunks at arbitrary bytes
+    std::vector<SourceFile> sources(paths.size());
+    std::vector<Chunk> chunks;
+    qint64 totalBytes = 0;
+    for (int f = 0; f < paths.size(); ++f) {
+        SourceFile& source = sources[f];
+        source.path = paths[f];
+        if (!openSource(source)) continue;
+
+        const qint64 bytes = source.size - source.dataStart;
+        const qint64 pieces = std::clamp<qint64>(bytes / kMinChunkBytes, 1, qint64(m_threads) * kChunksPerThread);
+        for (qint64 i = 0; i < pieces; ++i) {
+            Chunk chunk;
+            chunk.file = f;
+            chunk.begin = source.dataStart + bytes * i / pieces;
+            chunk.end = source.dataStart + bytes * (i + 1) / pieces;
+            chunks.push_back(std::move(chunk));
+        }
+        totalBytes += bytes;
+    }
+
+    // Where each chunk starts: inside quotes or not, and on which line
+    parallelFor(static_cast<int>(chunks.size()), m_threads, [&](int i) {
+        Chunk& chunk = chunks[i];
+        const char* data = sources[chunk.file].data;
+        countQuotesAndNewlines(data + chunk.begin, data + chunk.end, chunk.quotes, chunk.newlines);
+    });
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        Chunk& chunk = chunks[i];
+        if (i == 0 || chunks[i - 1].file != chunk.file) {
+            chunk.inQuotes = false;
+            chunk.line = sources[chunk.file].dataStartLine;
+        } else {
+            const Chunk& previous = chunks[i - 1];
+            chunk.inQuotes = previous.inQuotes != (previous.quotes % 2 == 1);
+            chunk.line = previous.line + previous.newlines;
+        }
+    }
+
+    std::mutex progressMutex;
+    qint64 doneBytes = 0;
+    parallelFor(static_cast<int>(chunks.size()), m_threads, [&](int i) {
+        if (cancelled()) return;
+        Chunk& chunk = chunks[i];
+        chunk.records = std::make_unique<RecordStore>(m_vocabulary);
+        ChunkParser(sources[chunk.file], chunk, vocabularies).run(progress.cancel);
+        if (progress.report) {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            doneBytes += chunk.end - chunk.begin;
+            progress.report(doneBytes, totalBytes);
+        }
+    });
+
+    Result result(m_vocabulary);
+    if (cancelled()) {
+        result.cancelled = true;
+        return result;
+    }
+
+    // Chunks in file order, each file's own issues first
+    auto addIssues = [&result](const std::vector<Issue>& issues, qint64 count) {
+        for (const Issue& issue : issues) {
+            if (static_cast<int>(result.issues.size()) >= MAX_ISSUES) break;
+            result.issues.push_back(issue);
+        }
+        result.issueCount += count;
+    };
+    qint64 records = 0;
+    for (const Chunk& chunk : chunks) records += chunk.records->size();
+    result.records.reserve(static_cast<int>(records));
+    size_t next = 0;
+    for (size_t f = 0; f < sources.size(); ++f) {
+        addIssues(sources[f].issues, static_cast<qint64>(sources[f].issues.size()));
+        for (; next < chunks.size() && chunks[next].file == static_cast<int>(f); ++next) {
+            const Chunk& chunk = chunks[next];
+            result.records.append(*chunk.records);
+            addIssues(chunk.issues, chunk.issueCount);
+            result.skippedRows += chunk.skippedRows;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Reads CSV files written by CsvExporter (or edited copies of them) back
+// into records, to correct, extend or merge earlier sessions. Files are
+// memory-mapped and cut into chunks parsed on all cores; delimiters, quotes
+// and newlines are found 16 bytes at a time. Columns are matched by header
+// name, so reordered columns or missing optional ones are fine.
+//
+// Problems are reported with their file, line and column. A row that cannot
+// be read (wrong number of fields, a bad number, no start time) is skipped;
+// values missing from the vocabularies of behaviors.json are kept and
+// reported.
+class CsvImporter {
+public:
+    struct Issue {
+        QString file;
+        qint64 line = 0;      // 1-based; 0 for the whole file
+        int column = 0;       // 1-based; 0 for the whole row
+        QString message;
+        bool skipped = false; // The row (or file) was not imported
+    };
+
+    struct Result {
+        explicit Result(const RecordStore::Vocabulary& vocabulary) : records(vocabulary) {}
+
+        RecordStore records;
+        std::vector<Issue> issues; // The first MAX_ISSUES, in file and line order
+        qint64 issueCount = 0;
+        qint64 skippedRows = 0;
+        bool cancelled = false;
+    };
+
+    static constexpr int MAX_ISSUES = 1000;
+
+    // threads: chunks parsed at the same time (0 = one per core)
+    explicit CsvImporter(const RecordStore::Vocabulary& vocabulary, int threads = 0);
+
+    // Records of all files, in file order and then row order. progress
+    // counts bytes; a cancelled import returns no records.
+    Result importFiles(const QStringList& paths, const CsvExporter::Progress& progress = CsvExporter::Progress()) const;
+
+private:
+    RecordStore::Vocabulary m_vocabulary;
+    int m_threads;
+};
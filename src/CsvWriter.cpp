@@ -0,0 +1,118 @@
+#include "CsvWriter.hpp"
+
+#include <charconv>
+
+CsvWriter::CsvWriter(size_t bufferBytes)
+    : m_encoder(QStringConverter::Utf8)
+    , m_bufferBytes(bufferBytes)
+    , m_written(0)
+#ifdef Q_OS_WIN
+    , m_crlf(true)
+#else
+    , m_crlf(false)
+#endif
+    , m_failed(false)
+{
+    // Room for a full block plus the row that crosses it
+    m_buffer.reserve(m_bufferBytes + 64 * 1024);
+}
+
+bool CsvWriter::open(const QString& path) {
+    m_buffer.clear();
+    m_written = 0;
+    m_failed = false;
+    m_file.setFileName(path);
+    return m_file.open(QIODevice::WriteOnly);
+}
+
+bool CsvWriter::commit() {
+    flush();
+    if (m_failed) {
+        m_file.cancelWriting();
+        m_file.commit();
+        return false;
+    }
+    return m_file.commit();
+}
+
+void CsvWriter::cancel() {
+    m_buffer.clear();
+    m_file.cancelWriting();
+    m_file.commit();
+}
+
+void CsvWriter::text(QStringView value) {
+    if (value.isEmpty()) return;
+    m_scratch.resize(m_encoder.requiredSpace(value.size()));
+    char* end = m_encoder.appendToBuffer(m_scratch.data(), value);
+    appendEscaped(std::string_view(m_scratch.data(), end - m_scratch.data()));
+}
+
+void CsvWriter::number(int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    m_buffer.append(digits, result.ptr - digits);
+}
+
+void CsvWriter::number(double value, int decimals) {
+    // Same digits as QString::number(value, 'f', decimals)
+    char digits[352];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, decimals);
+    m_buffer.append(digits, result.ptr - digits);
+}
+
+void CsvWriter::time(double seconds) {
+    // Two digits at least, like QString::arg(n, 2, 10, '0')
+    auto twoDigits = [this](int n) {
+        if (n >= 0 && n < 10) m_buffer.push_back('0');
+        number(n);
+    };
+    const int totalSeconds = static_cast<int>(seconds);
+    twoDigits(totalSeconds / 60);
+    m_buffer.push_back(':');
+    twoDigits(totalSeconds % 60);
+}
+
+void CsvWriter::endRow() {
+    appendNewline();
+    flushIfFull();
+}
+
+std::string CsvWriter::escape(QStringView value) {
+    std::string saved;
+    saved.swap(m_buffer);
+    text(value);
+    saved.swap(m_buffer);
+    return saved;
+}
+
+void CsvWriter::appendEscaped(std::string_view utf8) {
+    // One scan for the characters that need quoting; they are all ASCII and
+    // never appear inside a multi-byte UTF-8 sequence
+    if (utf8.find_first_of(",\"\n") == std::string_view::npos) {
+        m_buffer.append(utf8);
+        return;
+    }
+
+    m_buffer.push_back('"');
+    for (char c : utf8) {
+        if (c == '"') {
+            m_buffer.append("\"\"", 2);
+        } else if (c == '\n') {
+            appendNewline();
+        } else {
+            m_buffer.push_back(c);
+        }
+    }
+    m_buffer.push_back('"');
+}
+
+void CsvWriter::flush() {
+    if (m_buffer.empty()) return;
+    if (!m_failed && m_file.write(m_buffer.data(), static_cast<qint64>(m_buffer.size()))
+                         != static_cast<qint64>(m_buffer.size())) {
+        m_failed = true;
+    }
+    m_written += static_cast<qint64>(m_buffer.size());
+    m_buffer.clear();
+}
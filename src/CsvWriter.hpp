@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QSaveFile>
+#include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Buffered UTF-8 CSV output. Fields are appended to a large buffer that is
+// written out in blocks; numbers are formatted with std::to_chars and text
+// is escaped in a single pass, so a row costs no allocations. The file is
+// written to a temporary and only replaces the target on commit().
+//
+// Line ends and newlines inside fields follow the platform's text files
+// ("\r\n" on Windows), as QIODevice::Text did.
+class CsvWriter {
+public:
+    explicit CsvWriter(size_t bufferBytes = 1 << 20);
+
+    bool open(const QString& path);
+    // Finish the file; false (and the target untouched) on a write error
+    bool commit();
+    // Drop everything written so far
+    void cancel();
+    QString errorString() const { return m_file.errorString(); }
+    qint64 bytesWritten() const { return m_written + static_cast<qint64>(m_buffer.size()); }
+
+    // Text that still needs escaping
+    void text(QStringView value);
+    // UTF-8 that is already escaped (see escape())
+    void raw(std::string_view utf8) { m_buffer.append(utf8); }
+    void number(int value);
+    void number(double value, int decimals);
+    void optionalNumber(const std::optional<int>& value) { if (value) number(*value); }
+    void optionalNumber(const std::optional<double>& value, int decimals) { if (value) number(*value, decimals); }
+    // MM:SS, as BehaviorRecord::formatTime
+    void time(double seconds);
+    void separator() { m_buffer.push_back(','); }
+    void endRow();
+
+    // Escaped UTF-8 form of a value, for fields repeated on many rows
+    std::string escape(QStringView value);
+
+private:
+    void appendEscaped(std::string_view utf8);
+    void appendNewline() { if (m_crlf) m_buffer.push_back('\r'); m_buffer.push_back('\n'); }
+    void flushIfFull() { if (m_buffer.size() >= m_bufferBytes) flush(); }
+    void flush();
+
+    QSaveFile m_file;
+    QStringEncoder m_encoder;
+    size_t m_bufferBytes;
+    std::string m_buffer;
+    std::string m_scratch; // UTF-8 of the text being escaped
+    qint64 m_written;
+    bool m_crlf;
+    bool m_failed;
+};
@@ -0,0 +1,76 @@
+#include "DecodeRegion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Crop only when most of the frame is off screen
+constexpr double kCropMaxVisibleFraction = 0.6;
+// Extra border converted around the visible part, so small pans stay covered
+constexpr double kCropMargin = 0.125;
+// Crop edges stay on 4:2:0 chroma (and SIMD) boundaries
+constexpr int kCropAlignment = 16;
+// Downscale by powers of two: coarse enough that small zoom changes do not
+// re-render, and exactly what the fused YUV box-filter kernel supports
+constexpr int kFactors[] = {2, 4, 8};
+}
+
+QRect DecodeRegion::sourceRect(const QSize& frameSize) const {
+    const QRect frame(QPoint(0, 0), frameSize);
+    if (source.isEmpty()) return frame;
+    QRect clipped = source.intersected(frame);
+    return clipped.isEmpty() ? frame : clipped;
+}
+
+QSize DecodeRegion::outputSize(const QSize& frameSize) const {
+    return output.isEmpty() ? sourceRect(frameSize).size() : output;
+}
+
+DecodeRegion DecodeRegion::forViewport(const QSize& frameSize, const QRectF& visible, double devicePixelsPerSourcePixel) {
+    DecodeRegion region;
+    if (frameSize.isEmpty() || devicePixelsPerSourcePixel <= 0.0) return region;
+    
+    const QRectF frame(QPointF(0, 0), QSizeF(frameSize));
+    const QRectF shown = visible.intersected(frame);
+    if (shown.isEmpty()) return region;
+    
+    double visibleFraction = (shown.width() * shown.height()) / (frame.width() * frame.height());
+    if (visibleFraction < kCropMaxVisibleFraction) {
+        QRectF padded = shown.adjusted(-shown.width() * kCropMargin, -shown.height() * kCropMargin,
+                                       shown.width() * kCropMargin, shown.height() * kCropMargin);
+        int left = std::max(0, static_cast<int>(std::floor(padded.left())) / kCropAlignment * kCropAlignment);
+        int top = std::max(0, static_cast<int>(std::floor(padded.top())) / kCropAlignment * kCropAlignment);
+        int right = std::min(frameSize.width(),
+                             (static_cast<int>(std::ceil(padded.right())) + kCropAlignment - 1) / kCropAlignment * kCropAlignment);
+        int bottom = std::min(frameSize.height(),
+                              (static_cast<int>(std::ceil(padded.bottom())) + kCropAlignment - 1) / kCropAlignment * kCropAlignment);
+        if (right > left && bottom > top) {
+            region.source = QRect(left, top, right - left, bottom - top);
+        }
+    }
+    
+    // Largest factor that still leaves at least one converted pixel per device pixel
+    int factor = 1;
+    for (int step : kFactors) {
+        if (1.0 / step < devicePixelsPerSourcePixel) break;
+        factor = step;
+    }
+    if (factor > 1) {
+        region.output = shrink(region.sourceRect(frameSize).size(), factor);
+    }
+    return region;
+}
+
+QSize DecodeRegion::shrink(const QSize& size, int factor) {
+    if (factor <= 1) return size;
+    return QSize(std::max(2, (size.width() / factor) & ~1), std::max(2, (size.height() / factor) & ~1));
+}
+
+int DecodeRegion::boxFactor(const QSize& frameSize) const {
+    const QSize source = sourceRect(frameSize).size();
+    const QSize target = outputSize(frameSize);
+    for (int factor : {1, 2, 4, 8}) {
+        if (shrink(source, factor) == target) return factor;
+    }
+    return 0;
+}
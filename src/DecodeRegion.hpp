@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+
+// Part of a decoded frame that is converted for display, and the size it is
+// converted to. Derived from what the view actually shows: a 5K source in a
+// small dock is downscaled, a zoomed-in view only converts the visible crop.
+// Either way the saving happens before color conversion and hand-off.
+struct DecodeRegion {
+    QRect source; // In source pixels; empty means the whole frame
+    QSize output; // Converted size; empty means the source size (no scaling)
+
+    bool isFullFrame() const { return source.isEmpty() && output.isEmpty(); }
+    QRect sourceRect(const QSize& frameSize) const;
+    QSize outputSize(const QSize& frameSize) const;
+
+    // visible: part of the frame on screen, in source pixels.
+    // devicePixelsPerSourcePixel: view zoom times the screen's device pixel ratio.
+    // Never upscales; zooming in far enough returns to full resolution.
+    static DecodeRegion forViewport(const QSize& frameSize, const QRectF& visible, double devicePixelsPerSourcePixel);
+
+    // Outputs are always the source shrunk by a power of two (box filter
+    // friendly): the factor for this region, or 0 if output is arbitrary
+    int boxFactor(const QSize& frameSize) const;
+    static QSize shrink(const QSize& size, int factor);
+
+    bool operator==(const DecodeRegion& other) const = default;
+};
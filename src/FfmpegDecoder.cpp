@@ -0,0 +1,439 @@
+#include "FfmpegDecoder.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <cmath>
+
+FfmpegDecoder::FfmpegDecoder(const Options& options)
+    : m_options(options)
+    , m_io(nullptr)
+    , m_format(nullptr)
+    , m_codec(nullptr)
+    , m_frame(nullptr)
+    , m_cropped(nullptr)
+    , m_sws(nullptr)
+    , m_stream(-1)
+    , m_timeBase(0.0)
+    , m_startTime(0)
+    , m_fps(0.0)
+    , m_duration(0.0)
+    , m_framePts(0.0)
+    , m_grabbed(false)
+    , m_draining(false)
+    , m_queuedBytes(0)
+    , m_endOfStream(false)
+    , m_stopReadahead(false)
+{
+}
+
+FfmpegDecoder::~FfmpegDecoder() {
+    close();
+}
+
+bool FfmpegDecoder::open(const QString& path) {
+    close();
+    
+    m_format = avformat_alloc_context();
+    if (!m_format) return false;
+    m_format->interrupt_callback.callback = &FfmpegDecoder::interrupted;
+    m_format->interrupt_callback.opaque = this;
+    if (!openInput(path)) {
+        close();
+        return false;
+    }
+    
+    // Frees the context on failure
+    if (avformat_open_input(&m_format, path.toUtf8().constData(), nullptr, nullptr) < 0) {
+        close();
+        return false;
+    }
+    if (avformat_find_stream_info(m_format, nullptr) < 0) {
+        close();
+        return false;
+    }
+    
+#if LIBAVFORMAT_VERSION_MAJOR >= 59
+    const AVCodec* decoder = nullptr;
+#else
+    AVCodec* decoder = nullptr;
+#endif
+    m_stream = av_find_best_stream(m_format, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+    if (m_stream < 0 || !decoder) {
+        close();
+        return false;
+    }
+    
+    // Only the video packets are of interest to the demuxer
+    for (unsigned i = 0; i < m_format->nb_streams; ++i) {
+        if (static_cast<int>(i) != m_stream) {
+            m_format->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    
+    AVStream* stream = m_format->streams[m_stream];
+    m_codec = avcodec_alloc_context3(decoder);
+    if (!m_codec || avcodec_parameters_to_context(m_codec, stream->codecpar) < 0) {
+        close();
+        return false;
+    }
+    m_codec->pkt_timebase = stream->time_base;
+    m_codec->thread_count = m_options.threads; // 0 = one per core
+    m_codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    if (avcodec_open2(m_codec, decoder, nullptr) < 0) {
+        close();
+        return false;
+    }
+    
+    m_frame = av_frame_alloc();
+    m_cropped = av_frame_alloc();
+    if (!m_frame || !m_cropped) {
+        close();
+        return false;
+    }
+    
+    // Same clock as FrameIndex: seconds since the stream's first PTS
+    m_timeBase = av_q2d(stream->time_base);
+    m_startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    m_fps = av_q2d(av_guess_frame_rate(m_format, stream, nullptr));
+    if (stream->duration != AV_NOPTS_VALUE) {
+        m_duration = stream->duration * m_timeBase;
+    } else if (m_format->duration != AV_NOPTS_VALUE) {
+        m_duration = m_format->duration / static_cast<double>(AV_TIME_BASE);
+    }
+    m_frameSize = QSize(stream->codecpar->width, stream->codecpar->height);
+    
+    startReadahead();
+    return true;
+}
+
+void FfmpegDecoder::close() {
+    stopReadahead();
+    
+    sws_freeContext(m_sws);
+    m_sws = nullptr;
+    av_frame_free(&m_frame);
+    av_frame_free(&m_cropped);
+    avcodec_free_context(&m_codec);
+    avformat_close_input(&m_format);
+    
+    // A custom I/O context is not freed with the format context
+    if (m_io) {
+        av_freep(&m_io->buffer);
+        avio_context_free(&m_io);
+    }
+    m_input.reset();
+    
+    m_stream = -1;
+    m_fps = 0.0;
+    m_duration = 0.0;
+    m_frameSize = QSize();
+    m_grabbed = false;
+    m_draining = false;
+}
+
+bool FfmpegDecoder::seek(double seconds) {
+    if (!m_codec) return false;
+    
+    // The demuxer is not thread-safe: park the readahead while seeking
+    stopReadahead();
+    int64_t timestamp = m_startTime + std::llround(seconds / m_timeBase);
+    int result = av_seek_frame(m_format, m_stream, timestamp, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(m_codec);
+    m_grabbed = false;
+    m_draining = false;
+    startReadahead();
+    
+    return result >= 0;
+}
+
+bool FfmpegDecoder::grab() {
+    if (!m_codec) return false;
+    m_grabbed = false;
+    
+    while (true) {
+        int result = avcodec_receive_frame(m_codec, m_frame);
+        if (result == 0) {
+            int64_t timestamp = m_frame->best_effort_timestamp;
+            if (timestamp == AV_NOPTS_VALUE) timestamp = m_frame->pts;
+            if (timestamp != AV_NOPTS_VALUE) {
+                m_framePts = (timestamp - m_startTime) * m_timeBase;
+            } else if (m_fps > 0) {
+                m_framePts += 1.0 / m_fps;
+            }
+            m_grabbed = true;
+            return true;
+        }
+        if (result != AVERROR(EAGAIN) || m_draining) {
+            return false; // End of stream or a fatal decoder error
+        }
+        
+        AVPacket* packet = nextPacket();
+        if (!packet) {
+            // Flush the frames still held by the decoder's threads
+            m_draining = true;
+            avcodec_send_packet(m_codec, nullptr);
+            continue;
+        }
+        // A corrupt packet is skipped; the decoder resyncs on its own
+        avcodec_send_packet(m_codec, packet);
+        av_packet_free(&packet);
+    }
+}
+
+VideoDecoder::Transfer FfmpegDecoder::retrieve(FramePool& pool, QImage& out, const DecodeRegion& region) {
+    if (!m_grabbed) return Transfer::Failed;
+    
+    const QSize frameSize(m_frame->width, m_frame->height);
+    const QRect source = region.sourceRect(frameSize);
+    const QSize size = region.outputSize(frameSize);
+    
+    // 8-bit 4:2:0 (nearly all camera footage): crop, box-downscale and
+    // convert in one SIMD pass straight from the decoder's planes
+    YuvFrame yuv;
+    if (describeYuv(m_frame, yuv) && convertYuv(yuv, region, pool, out)) {
+        return Transfer::Converted;
+    }
+    
+    // Anything else goes through swscale. Crop by moving the plane pointers
+    // of a second reference; nothing is copied.
+    AVFrame* input = m_frame;
+    if (source.size() != frameSize && av_frame_ref(m_cropped, m_frame) >= 0) {
+        m_cropped->crop_left = static_cast<size_t>(source.left());
+        m_cropped->crop_top = static_cast<size_t>(source.top());
+        m_cropped->crop_right = static_cast<size_t>(frameSize.width() - source.right() - 1);
+        m_cropped->crop_bottom = static_cast<size_t>(frameSize.height() - source.bottom() - 1);
+        if (av_frame_apply_cropping(m_cropped, AV_FRAME_CROP_UNALIGNED) >= 0) {
+            input = m_cropped;
+        }
+    }
+    
+    // Scaling happens in the same swscale pass as the color conversion
+    const int flags = size == QSize(input->width, input->height) ? SWS_BILINEAR : SWS_AREA;
+    m_sws = sws_getCachedContext(m_sws, input->width, input->height, static_cast<AVPixelFormat>(input->format),
+                                 size.width(), size.height(), AV_PIX_FMT_BGRA, flags, nullptr, nullptr, nullptr);
+    if (!m_sws) {
+        av_frame_unref(m_cropped);
+        return Transfer::Failed;
+    }
+    
+    // Untagged streams: BT.709 for HD and up, BT.601 below
+    int colorspace = input->colorspace;
+    if (colorspace == AVCOL_SPC_UNSPECIFIED) {
+        colorspace = frameSize.height() >= 720 ? SWS_CS_ITU709 : SWS_CS_ITU601;
+    }
+    const int* coefficients = sws_getCoefficients(colorspace);
+    int fullRange = input->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+    sws_setColorspaceDetails(m_sws, coefficients, fullRange, coefficients, 1, 0, 1 << 16, 1 << 16);
+    
+    // Format_RGB32 is BGRA in memory on little-endian hosts
+    out = pool.acquire(size.width(), size.height(), QImage::Format_RGB32);
+    uint8_t* planes[4] = {out.bits(), nullptr, nullptr, nullptr};
+    int strides[4] = {static_cast<int>(out.bytesPerLine()), 0, 0, 0};
+    sws_scale(m_sws, input->data, input->linesize, 0, input->height, planes, strides);
+    av_frame_unref(m_cropped);
+    return Transfer::Converted;
+}
+
+bool FfmpegDecoder::setKeyframesOnly(bool enabled) {
+    if (!m_codec) return false;
+    
+    // Non-key packets are dropped before they reach the decoder's threads
+    m_codec->skip_frame = enabled ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+    return true;
+}
+
+bool FfmpegDecoder::retrieveYuv(YuvFrame& frame) {
+    if (!m_grabbed || !describeYuv(m_frame, frame)) return false;
+    
+    // A new reference, not a copy: the planes stay valid after the next grab()
+    AVFrame* reference = av_frame_clone(m_frame);
+    if (!reference) return false;
+    
+    for (int i = 0; i < 3; ++i) {
+        frame.planes[i] = reference->data[i];
+    }
+    frame.owner = std::shared_ptr<const void>(reference, [](AVFrame* f) { av_frame_free(&f); });
+    return true;
+}
+
+bool FfmpegDecoder::describeYuv(const AVFrame* source, YuvFrame& frame) {
+    const auto format = static_cast<AVPixelFormat>(source->format);
+    if (format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P) {
+        frame.layout = YuvFrame::Layout::I420;
+    } else if (format == AV_PIX_FMT_NV12) {
+        frame.layout = YuvFrame::Layout::NV12;
+    } else {
+        return false;
+    }
+    
+    // Same matrix choice as the swscale path; other matrices (BT.2020) go there
+    if (source->colorspace == AVCOL_SPC_BT709) {
+        frame.matrix = YuvFrame::Matrix::Bt709;
+    } else if (source->colorspace == AVCOL_SPC_BT470BG || source->colorspace == AVCOL_SPC_SMPTE170M) {
+        frame.matrix = YuvFrame::Matrix::Bt601;
+    } else if (source->colorspace == AVCOL_SPC_UNSPECIFIED) {
+        frame.matrix = source->height >= 720 ? YuvFrame::Matrix::Bt709 : YuvFrame::Matrix::Bt601;
+    } else {
+        return false;
+    }
+    
+    frame.width = source->width;
+    frame.height = source->height;
+    frame.fullRange = source->color_range == AVCOL_RANGE_JPEG || format == AV_PIX_FMT_YUVJ420P;
+    for (int i = 0; i < 3; ++i) {
+        frame.planes[i] = source->data[i];
+        frame.strides[i] = source->linesize[i];
+    }
+    frame.owner.reset();
+    return true;
+}
+
+int FfmpegDecoder::interrupted(void* opaque) {
+    return static_cast<FfmpegDecoder*>(opaque)->m_stopReadahead.load() ? 1 : 0;
+}
+
+bool FfmpegDecoder::openInput(const QString& path) {
+    const bool throttled = m_options.throttleMegabytesPerSecond > 0.0 || m_options.throttleLatencyMs > 0.0;
+    if (m_options.readaheadMegabytes <= 0 && !throttled) return true; // Demuxer opens the file itself
+    
+    ReadaheadFile::Options options;
+    options.bufferBytes = static_cast<size_t>(std::max(0, m_options.readaheadMegabytes)) * 1024 * 1024;
+    options.memoryMap = m_options.memoryMap;
+    options.throttleBytesPerSecond = m_options.throttleMegabytesPerSecond * 1024 * 1024;
+    options.throttleLatencySeconds = m_options.throttleLatencyMs / 1000.0;
+    options.counters = m_options.ioCounters;
+    
+    // Not a local file (or not readable): leave it to libavformat
+    auto input = std::make_unique<ReadaheadFile>(options);
+    if (!input->open(path.toUtf8().toStdString())) return true;
+    
+    auto* buffer = static_cast<unsigned char*>(av_malloc(IO_BUFFER_BYTES));
+    if (!buffer) return false;
+    m_io = avio_alloc_context(buffer, IO_BUFFER_BYTES, 0, this, &FfmpegDecoder::readInput, nullptr,
+                              &FfmpegDecoder::seekInput);
+    if (!m_io) {
+        av_free(buffer);
+        return false;
+    }
+    m_input = std::move(input);
+    m_format->pb = m_io;
+    m_format->flags |= AVFMT_FLAG_CUSTOM_IO;
+    return true;
+}
+
+int FfmpegDecoder::readInput(void* opaque, uint8_t* buffer, int size) {
+    auto* self = static_cast<FfmpegDecoder*>(opaque);
+    int64_t result = self->m_input->read(buffer, size);
+    if (result < 0) return self->m_stopReadahead.load() ? AVERROR_EXIT : AVERROR(EIO);
+    if (result == 0) return AVERROR_EOF;
+    return static_cast<int>(result);
+}
+
+int64_t FfmpegDecoder::seekInput(void* opaque, int64_t offset, int whence) {
+    ReadaheadFile& input = *static_cast<FfmpegDecoder*>(opaque)->m_input;
+    if (whence & AVSEEK_SIZE) return input.size();
+    
+    switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET: break;
+    case SEEK_CUR: offset += input.position(); break;
+    case SEEK_END: offset += input.size(); break;
+    default: return AVERROR(EINVAL);
+    }
+    return input.seek(offset) ? offset : AVERROR(EIO);
+}
+
+void FfmpegDecoder::startReadahead() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_endOfStream = false;
+    }
+    m_stopReadahead = false;
+    m_readaheadThread = std::thread(&FfmpegDecoder::readaheadLoop, this);
+}
+
+void FfmpegDecoder::stopReadahead() {
+    if (m_readaheadThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stopReadahead = true;
+        }
+        m_queueChanged.notify_all();
+        if (m_input) m_input->interrupt(); // Wakes a read waiting for slow storage
+        m_readaheadThread.join();
+        if (m_input) m_input->resume();
+    }
+    m_stopReadahead = false;
+    clearPackets();
+}
+
+void FfmpegDecoder::readaheadLoop() {
+    AVPacket* packet = av_packet_alloc();
+    
+    while (packet) {
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueChanged.wait(lock, [this] {
+                return m_stopReadahead || (m_queuedBytes < READAHEAD_BYTES && m_packets.size() < READAHEAD_PACKETS);
+            });
+            if (m_stopReadahead) break;
+        }
+        
+        int result = av_read_frame(m_format, packet);
+        if (result == AVERROR(EAGAIN)) continue;
+        if (result < 0) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_endOfStream = true;
+            m_queueChanged.notify_all();
+            break;
+        }
+        if (packet->stream_index != m_stream) {
+            av_packet_unref(packet);
+            continue;
+        }
+        
+        AVPacket* queued = av_packet_alloc();
+        if (!queued) {
+            av_packet_unref(packet);
+            continue;
+        }
+        av_packet_move_ref(queued, packet);
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_packets.push_back(queued);
+            m_queuedBytes += static_cast<size_t>(queued->size);
+        }
+        m_queueChanged.notify_all();
+    }
+    
+    av_packet_free(&packet);
+}
+
+AVPacket* FfmpegDecoder::nextPacket() {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_queueChanged.wait(lock, [this] {
+        return !m_packets.empty() || m_endOfStream || !m_readaheadThread.joinable();
+    });
+    if (m_packets.empty()) return nullptr;
+    
+    AVPacket* packet = m_packets.front();
+    m_packets.pop_front();
+    m_queuedBytes -= static_cast<size_t>(packet->size);
+    lock.unlock();
+    m_queueChanged.notify_all();
+    return packet;
+}
+
+void FfmpegDecoder::clearPackets() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    for (AVPacket* packet : m_packets) {
+        av_packet_free(&packet);
+    }
+    m_packets.clear();
+    m_queuedBytes = 0;
+    m_endOfStream = false;
+}
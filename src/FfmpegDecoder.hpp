@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ReadaheadFile.hpp"
+#include "VideoDecoder.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVIOContext;
+struct AVFrame;
+struct AVPacket;
+struct SwsContext;
+
+// Decoder that drives libavformat/libavcodec directly.
+// Enables frame and slice threading, takes PTS from the decoded frames
+// themselves and can hand out the native YUV planes. Packets are demuxed
+// ahead on a separate thread so slow storage does not stall the decoder, and
+// the demuxer reads its input from a ReadaheadFile rather than the disk.
+class FfmpegDecoder : public VideoDecoder {
+public:
+    explicit FfmpegDecoder(const Options& options = {});
+    ~FfmpegDecoder() override;
+
+    QString name() const override { return "ffmpeg"; }
+    bool open(const QString& path) override;
+    void close() override;
+    bool isOpened() const override { return m_codec != nullptr; }
+
+    double fps() const override { return m_fps; }
+    double duration() const override { return m_duration; }
+    QSize frameSize() const override { return m_frameSize; }
+
+    bool seek(double seconds) override;
+    bool grab() override;
+    double framePts() const override { return m_framePts; }
+    Transfer retrieve(FramePool& pool, QImage& out, const DecodeRegion& region = {}) override;
+    bool setKeyframesOnly(bool enabled) override;
+    bool retrieveYuv(YuvFrame& frame) override;
+
+private:
+    // Plane layout of an 8-bit 4:2:0 frame the SIMD converter can handle
+    static bool describeYuv(const AVFrame* source, YuvFrame& frame);
+    static int interrupted(void* opaque);
+    bool openInput(const QString& path); // Readahead I/O context for the demuxer
+    static int readInput(void* opaque, uint8_t* buffer, int size);
+    static int64_t seekInput(void* opaque, int64_t offset, int whence);
+    void startReadahead();
+    void stopReadahead();
+    void readaheadLoop();
+    AVPacket* nextPacket(); // Blocks until a packet is queued; nullptr at end of stream
+    void clearPackets();
+
+    Options m_options;
+    static constexpr int IO_BUFFER_BYTES = 256 * 1024;
+    std::unique_ptr<ReadaheadFile> m_input;
+    AVIOContext* m_io;
+    AVFormatContext* m_format;
+    AVCodecContext* m_codec;
+    AVFrame* m_frame;
+    AVFrame* m_cropped; // Reference to m_frame with the decode region's crop applied
+    SwsContext* m_sws;
+    int m_stream;
+    double m_timeBase;
+    int64_t m_startTime;
+    double m_fps;
+    double m_duration;
+    QSize m_frameSize;
+    double m_framePts;
+    bool m_grabbed;
+    bool m_draining; // Demuxer hit the end; the decoder is being flushed
+
+    // Demux readahead, bounded by queued packet bytes
+    static constexpr size_t READAHEAD_BYTES = 32 * 1024 * 1024;
+    static constexpr size_t READAHEAD_PACKETS = 512;
+    std::thread m_readaheadThread;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueChanged;
+    std::deque<AVPacket*> m_packets;
+    size_t m_queuedBytes;
+    bool m_endOfStream;
+    std::atomic<bool> m_stopReadahead; // Also aborts blocking reads
+};
@@ -0,0 +1,87 @@
+#include "FrameCache.hpp"
+
+#include <cstdlib>
+#include <iterator>
+
+FrameCache::FrameCache(qint64 budgetBytes)
+    : m_budget(budgetBytes)
+    , m_bytes(0)
+    , m_focus(0)
+    , m_direction(1)
+    , m_window(0)
+{
+}
+
+void FrameCache::setFocus(int frame, int direction) {
+    m_focus = frame;
+    m_direction = direction < 0 ? -1 : 1;
+}
+
+const VideoFrame* FrameCache::find(int frame) {
+    auto it = m_frames.find(frame);
+    if (it == m_frames.end()) return nullptr;
+    
+    m_recency.splice(m_recency.begin(), m_recency, it->second.use);
+    return &it->second.frame;
+}
+
+void FrameCache::insert(const VideoFrame& frame) {
+    if (frame.frameNumber < 0 || frame.isNull()) return;
+    
+    auto it = m_frames.find(frame.frameNumber);
+    if (it != m_frames.end()) {
+        m_bytes -= it->second.frame.bytes();
+        it->second.frame = frame;
+        m_recency.splice(m_recency.begin(), m_recency, it->second.use);
+    } else {
+        m_recency.push_front(frame.frameNumber);
+        m_frames.emplace(frame.frameNumber, Entry{frame, m_recency.begin()});
+    }
+    m_bytes += frame.bytes();
+    
+    evictOverBudget();
+}
+
+void FrameCache::clear() {
+    m_frames.clear();
+    m_recency.clear();
+    m_bytes = 0;
+}
+
+bool FrameCache::inWindow(int frame) const {
+    return std::abs(frame - m_focus) <= m_window;
+}
+
+qint64 FrameCache::evictionScore(int frame) const {
+    qint64 distance = std::abs(frame - m_focus);
+    bool behind = (frame - m_focus) * m_direction < 0;
+    return behind ? distance * 2 : distance;
+}
+
+void FrameCache::erase(std::map<int, Entry>::iterator it) {
+    m_bytes -= it->second.frame.bytes();
+    m_recency.erase(it->second.use);
+    m_frames.erase(it);
+}
+
+void FrameCache::evictOverBudget() {
+    // Least recently used first; the window's frames were mostly used recently,
+    // so the scan from the back rarely has to skip many
+    auto candidate = m_recency.end();
+    while (m_bytes > m_budget && candidate != m_recency.begin()) {
+        --candidate;
+        if (inWindow(*candidate)) continue;
+        
+        int frame = *candidate;
+        candidate = std::next(candidate);
+        erase(m_frames.find(frame));
+    }
+    
+    // Everything left is near the playhead: the farthest frames are at one
+    // of the two ends of the map
+    while (m_bytes > m_budget && !m_frames.empty()) {
+        auto first = m_frames.begin();
+        auto last = std::prev(m_frames.end());
+        erase(evictionScore(first->first) >= evictionScore(last->first) ? first : last);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VideoFrame.hpp"
+
+#include <list>
+#include <map>
+
+// Memory-budgeted store of decoded frames keyed by frame number.
+// Replaying recently watched footage, single-frame steps and reverse
+// playback are served from here without reseeking the container.
+// When over budget, the least recently used frame outside the protected
+// window around the focus (the playhead) is evicted. Only when every frame
+// lies inside the window are the ones farthest from the focus evicted;
+// frames behind the playback direction count double.
+// Only used from the decoder thread.
+class FrameCache {
+public:
+    explicit FrameCache(qint64 budgetBytes);
+
+    void setFocus(int frame, int direction);
+    // Frames on each side of the focus that LRU eviction leaves alone
+    void setWindow(int frames) { m_window = frames; }
+    int window() const { return m_window; }
+
+    // Marks the frame as recently used
+    const VideoFrame* find(int frame);
+    bool contains(int frame) const { return m_frames.count(frame) > 0; }
+    void insert(const VideoFrame& frame);
+    void clear();
+
+    qint64 bytes() const { return m_bytes; }
+    qint64 budget() const { return m_budget; }
+    int count() const { return static_cast<int>(m_frames.size()); }
+
+private:
+    struct Entry {
+        VideoFrame frame;
+        std::list<int>::iterator use; // Position in m_recency
+    };
+
+    bool inWindow(int frame) const;
+    qint64 evictionScore(int frame) const;
+    void evictOverBudget();
+    void erase(std::map<int, Entry>::iterator it);
+
+    std::map<int, Entry> m_frames;
+    std::list<int> m_recency; // Frame numbers, most recently used first
+    qint64 m_budget;
+    qint64 m_bytes;
+    int m_focus;
+    int m_direction;
+    int m_window;
+};
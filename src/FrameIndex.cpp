@@ -0,0 +1,225 @@
+#include "FrameIndex.hpp"
+#include "SidecarFile.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+
+#ifdef ETHOWILD_WITH_FFMPEG
+extern "C" {
+#include <libavformat/avformat.h>
+}
+#endif
+
+namespace {
+constexpr quint32 kSidecarMagic = 0x45494458; // "EIDX"
+constexpr quint32 kSidecarVersion = 1;
+const QString kSidecarSuffix = QStringLiteral(".ethoidx");
+
+// Keyframe flags of raw packets are only exposed by newer OpenCV builds
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 5)))
+#define ETHOWILD_HAS_LRF_KEY_FRAME 1
+#endif
+
+#ifdef ETHOWILD_WITH_FFMPEG
+// Packet scan through libavformat: exact keyframe flags on every OpenCV version.
+// Timestamps use the same clock as the decoders (seconds since the stream start).
+bool demuxEntries(const QString& videoPath, const std::atomic<bool>& cancel, std::vector<FrameIndex::Entry>& entries) {
+    AVFormatContext* format = nullptr;
+    if (avformat_open_input(&format, videoPath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return false;
+    }
+    
+    int videoStream = -1;
+    if (avformat_find_stream_info(format, nullptr) >= 0) {
+        videoStream = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    }
+    if (videoStream < 0) {
+        avformat_close_input(&format);
+        return false;
+    }
+    
+    for (unsigned i = 0; i < format->nb_streams; ++i) {
+        if (static_cast<int>(i) != videoStream) {
+            format->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    AVStream* stream = format->streams[videoStream];
+    const double timeBase = av_q2d(stream->time_base);
+    const int64_t startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    
+    AVPacket* packet = av_packet_alloc();
+    while (packet && !cancel && av_read_frame(format, packet) >= 0) {
+        if (packet->stream_index == videoStream) {
+            int64_t timestamp = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            FrameIndex::Entry entry;
+            entry.pts = timestamp != AV_NOPTS_VALUE ? (timestamp - startTime) * timeBase : 0.0;
+            entry.keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+            entries.push_back(entry);
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&format);
+    return !entries.empty();
+}
+#endif
+}
+
+FrameIndex FrameIndex::build(const QString& videoPath, const std::atomic<bool>& cancel) {
+    FrameIndex index;
+    
+#ifdef ETHOWILD_WITH_FFMPEG
+    if (demuxEntries(videoPath, cancel, index.m_entries) || cancel) {
+        return finish(std::move(index), cancel);
+    }
+    index.m_entries.clear();
+#endif
+    
+    // Raw mode: grab() only demuxes packets, nothing is decoded
+    cv::VideoCapture cap(videoPath.toStdString(), cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1});
+    if (!cap.isOpened()) {
+        return index;
+    }
+    
+    while (!cancel && cap.grab()) {
+        Entry entry;
+        entry.pts = cap.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
+#ifdef ETHOWILD_HAS_LRF_KEY_FRAME
+        entry.keyframe = cap.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0;
+#else
+        // Unknown: let the capture's own seek find the keyframe
+        entry.keyframe = true;
+#endif
+        index.m_entries.push_back(entry);
+    }
+    
+    return finish(std::move(index), cancel);
+}
+
+FrameIndex FrameIndex::finish(FrameIndex index, const std::atomic<bool>& cancel) {
+    if (cancel) {
+        return FrameIndex();
+    }
+    
+    // Packets arrive in decode order; frames are numbered in presentation order
+    std::stable_sort(index.m_entries.begin(), index.m_entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.pts < b.pts; });
+    index.finalize();
+    return index;
+}
+
+void FrameIndex::finalize() {
+    m_precedingKeyframe.resize(m_entries.size());
+    m_keyframes.clear();
+    int32_t lastKeyframe = 0;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].keyframe) {
+            lastKeyframe = static_cast<int32_t>(i);
+            m_keyframes.push_back(lastKeyframe);
+        }
+        m_precedingKeyframe[i] = lastKeyframe;
+    }
+}
+
+double FrameIndex::duration() const {
+    if (m_entries.empty()) return 0.0;
+    if (m_entries.size() == 1) return m_entries.front().pts;
+    
+    double last = m_entries.back().pts;
+    double previous = m_entries[m_entries.size() - 2].pts;
+    return last + (last - previous);
+}
+
+int FrameIndex::frameAtTime(double seconds) const {
+    if (m_entries.empty()) return 0;
+    
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), seconds,
+                               [](double t, const Entry& e) { return t < e.pts; });
+    if (it == m_entries.begin()) return 0;
+    return static_cast<int>(std::distance(m_entries.begin(), it)) - 1;
+}
+
+int FrameIndex::keyframeAtOrBefore(int frame) const {
+    if (m_precedingKeyframe.empty()) return 0;
+    frame = std::clamp(frame, 0, frameCount() - 1);
+    return m_precedingKeyframe[frame];
+}
+
+int FrameIndex::keyframeBefore(int frame) const {
+    if (frame <= 0 || m_precedingKeyframe.empty()) return -1;
+    frame = std::min(frame, frameCount());
+    return m_precedingKeyframe[frame - 1];
+}
+
+int FrameIndex::keyframeAfter(int frame) const {
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame);
+    return it != m_keyframes.end() ? *it : -1;
+}
+
+bool FrameIndex::load(const QString& videoPath) {
+    return loadFrom(SidecarFile::pathFor(videoPath, kSidecarSuffix), videoPath)
+        || loadFrom(SidecarFile::cachePathFor(videoPath, kSidecarSuffix), videoPath);
+}
+
+bool FrameIndex::save(const QString& videoPath) const {
+    // Prefer a sidecar next to the video; fall back to the cache for read-only media
+    return saveTo(SidecarFile::pathFor(videoPath, kSidecarSuffix), videoPath)
+        || saveTo(SidecarFile::cachePathFor(videoPath, kSidecarSuffix), videoPath);
+}
+
+bool FrameIndex::loadFrom(const QString& sidecar, const QString& videoPath) {
+    QFile file(sidecar);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    
+    if (!SidecarFile::checkStamp(in, kSidecarMagic, kSidecarVersion, videoPath)) {
+        return false;
+    }
+    
+    quint32 count = 0;
+    in >> count;
+    if (static_cast<qint64>(count) * 9 > file.size()) {
+        return false; // Truncated
+    }
+    
+    std::vector<Entry> entries(count);
+    for (Entry& entry : entries) {
+        quint8 flags = 0;
+        in >> entry.pts >> flags;
+        entry.keyframe = (flags & 0x1) != 0;
+    }
+    
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    
+    m_entries = std::move(entries);
+    finalize();
+    return true;
+}
+
+bool FrameIndex::saveTo(const QString& sidecar, const QString& videoPath) const {
+    QSaveFile file(sidecar);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    
+    SidecarFile::writeStamp(out, kSidecarMagic, kSidecarVersion, videoPath);
+    out << static_cast<quint32>(m_entries.size());
+    
+    for (const Entry& entry : m_entries) {
+        out << entry.pts << static_cast<quint8>(entry.keyframe ? 0x1 : 0x0);
+    }
+    
+    return out.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Per-video table of every frame's PTS and keyframe flag, in presentation order.
+// Built once by demuxing the container without decoding, then cached in a
+// sidecar file next to the video (or in the cache directory when the video's
+// folder is read-only) so later opens load it instantly.
+class FrameIndex {
+public:
+    struct Entry {
+        double pts = 0.0;      // Presentation time in seconds
+        bool keyframe = false;
+    };
+
+    FrameIndex() = default;
+
+    // Demux the whole file; returns an empty index on failure or cancellation
+    static FrameIndex build(const QString& videoPath, const std::atomic<bool>& cancel);
+
+    // Sidecar cache; load() rejects files written for a different version of the video
+    bool load(const QString& videoPath);
+    bool save(const QString& videoPath) const;
+
+    bool isEmpty() const { return m_entries.empty(); }
+    int frameCount() const { return static_cast<int>(m_entries.size()); }
+    const Entry& entry(int frame) const { return m_entries[frame]; }
+    double pts(int frame) const { return m_entries[frame].pts; }
+    
+    // Duration from real timestamps (last PTS plus the last frame's duration)
+    double duration() const;
+    
+    // Last frame whose PTS is at or before the given time
+    int frameAtTime(double seconds) const;
+    
+    // Nearest keyframe at or before the given frame (constant time)
+    int keyframeAtOrBefore(int frame) const;
+    
+    // Nearest keyframe strictly before the given frame, or -1
+    int keyframeBefore(int frame) const;
+    
+    // Nearest keyframe strictly after the given frame, or -1
+    int keyframeAfter(int frame) const;
+
+private:
+    static FrameIndex finish(FrameIndex index, const std::atomic<bool>& cancel);
+    void finalize();
+    bool loadFrom(const QString& sidecar, const QString& videoPath);
+    bool saveTo(const QString& sidecar, const QString& videoPath) const;
+
+    std::vector<Entry> m_entries;
+    std::vector<int32_t> m_precedingKeyframe; // Per frame: keyframe to seek to
+    std::vector<int32_t> m_keyframes;         // Keyframe numbers in ascending order
+};
@@ -0,0 +1,62 @@
+#include "FrameItem.hpp"
+
+#include <QPainter>
+
+FrameItem::FrameItem(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+    , m_pendingFrame(-1)
+    , m_pendingPts(0.0)
+    , m_pendingStamp(false)
+    , m_shownFrame(-1)
+    , m_shownPts(0.0)
+{
+}
+
+void FrameItem::setSourceSize(const QSize& size) {
+    if (size == m_sourceSize) return;
+    prepareGeometryChange();
+    m_sourceSize = size;
+}
+
+void FrameItem::setImage(const QImage& image, const QRect& sourceRect) {
+    // Until the video reports its size, follow the frames
+    if (!m_sourceSize.isValid() || m_sourceSize.isEmpty()) {
+        setSourceSize(image.size());
+    }
+    m_image = image;
+    m_imageRect = sourceRect;
+    m_pendingStamp = false;
+    update();
+}
+
+void FrameItem::setFrame(const VideoFrame& frame) {
+    setImage(frame.image, frame.sourceRect);
+    m_pendingFrame = frame.frameNumber;
+    m_pendingPts = frame.pts;
+    m_pendingStamp = true;
+}
+
+void FrameItem::clearShownFrame() {
+    m_pendingStamp = false;
+    m_shownFrame = -1;
+    m_shownPts = 0.0;
+}
+
+QRectF FrameItem::boundingRect() const {
+    return QRectF(QPointF(0, 0), QSizeF(m_sourceSize));
+}
+
+void FrameItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    
+    if (m_image.isNull()) return;
+    painter->drawImage(m_imageRect.isNull() ? boundingRect() : QRectF(m_imageRect), m_image);
+    
+    // Only now is the frame actually in front of the user
+    if (m_pendingStamp) {
+        m_pendingStamp = false;
+        m_shownFrame = m_pendingFrame;
+        m_shownPts = m_pendingPts;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <QImage>
+
+#include "VideoFrame.hpp"
+
+// Scene item that paints decoded frames straight from their QImage.
+// Unlike QGraphicsPixmapItem there is no QPixmap::fromImage conversion per
+// frame: Format_RGB32 images are blitted as-is by the raster paint engine.
+class FrameItem : public QGraphicsItem {
+public:
+    explicit FrameItem(QGraphicsItem* parent = nullptr);
+
+    // Size of the source video in scene coordinates
+    void setSourceSize(const QSize& size);
+    // sourceRect: part of the source the image shows (null = the whole frame);
+    // cropped or downscaled frames are stretched back into place
+    void setImage(const QImage& image, const QRect& sourceRect = QRect());
+    // A decoded frame; its number and PTS become the shown frame once painted
+    void setFrame(const VideoFrame& frame);
+    const QImage& image() const { return m_image; }
+    
+    // The decoded frame last painted to the screen (-1 before the first one).
+    // Previews set through setImage() do not change it.
+    int shownFrame() const { return m_shownFrame; }
+    double shownPts() const { return m_shownPts; }
+    void clearShownFrame(); // A different video is being opened
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    QImage m_image;
+    QRect m_imageRect;
+    QSize m_sourceSize;
+    
+    int m_pendingFrame;
+    double m_pendingPts;
+    bool m_pendingStamp; // The image carries a frame number and PTS not yet painted
+    int m_shownFrame;
+    double m_shownPts;
+};
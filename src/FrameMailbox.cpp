@@ -0,0 +1,33 @@
+#include "FrameMailbox.hpp"
+
+FrameMailbox::FrameMailbox()
+    : m_pending(false)
+    , m_overwritten(0)
+{
+}
+
+void FrameMailbox::post(const VideoFrame& frame) {
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.load(std::memory_order_relaxed)) {
+        m_overwritten.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_frame = frame; // Shares the pixels; only a reference count changes hands
+    m_pending.store(true, std::memory_order_release);
+}
+
+bool FrameMailbox::take(VideoFrame& frame) {
+    if (!m_pending.load(std::memory_order_acquire)) return false;
+    
+    QMutexLocker locker(&m_mutex);
+    if (!m_pending.load(std::memory_order_relaxed)) return false;
+    frame = std::move(m_frame);
+    m_frame = VideoFrame();
+    m_pending.store(false, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameMailbox::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_frame = VideoFrame();
+    m_pending.store(false, std::memory_order_relaxed);
+}
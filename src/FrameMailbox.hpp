@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QMutex>
+#include <atomic>
+
+#include "VideoFrame.hpp"
+
+// Latest-frame hand-off from the presenter to the GUI.
+// The presenter overwrites a single slot with each frame it shows; the GUI
+// takes it once per display tick. However busy the GUI thread gets, at most
+// one frame is pending, so nothing queues up and latency stays bounded.
+// Frames replaced before the GUI took them are counted.
+class FrameMailbox {
+public:
+    FrameMailbox();
+
+    // Presenter thread: replace the pending frame
+    void post(const VideoFrame& frame);
+    // GUI thread: the frame posted since the last take, if any
+    bool take(VideoFrame& frame);
+    // Drop a pending frame (e.g. one left over from before a video switch)
+    void clear();
+
+    qint64 overwrittenFrames() const { return m_overwritten.load(std::memory_order_relaxed); }
+
+private:
+    QMutex m_mutex;
+    VideoFrame m_frame;
+    std::atomic<bool> m_pending; // Lets idle ticks skip the lock
+    std::atomic<qint64> m_overwritten;
+};
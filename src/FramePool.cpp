@@ -0,0 +1,81 @@
+#include "FramePool.hpp"
+
+#include <QMutexLocker>
+#include <new>
+
+namespace {
+constexpr qsizetype kAlignment = 64;
+// Upper bound on idle buffers kept around (in-flight frames are not counted)
+constexpr std::size_t kMaxFreeBuffers = 32;
+}
+
+std::shared_ptr<FramePool> FramePool::create() {
+    return std::shared_ptr<FramePool>(new FramePool());
+}
+
+FramePool::~FramePool() {
+    for (Buffer& buffer : m_free) {
+        freeBuffer(buffer);
+    }
+}
+
+QImage FramePool::acquire(int width, int height, QImage::Format format) {
+    const int depthBytes = QImage::toPixelFormat(format).bitsPerPixel() / 8;
+    const qsizetype bytesPerLine = (static_cast<qsizetype>(width) * depthBytes + kAlignment - 1) / kAlignment * kAlignment;
+    const qsizetype size = bytesPerLine * height;
+    
+    Buffer buffer;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (it->size == size) {
+                buffer = *it;
+                m_free.erase(it);
+                break;
+            }
+        }
+        if (!buffer.data) {
+            buffer.data = static_cast<uchar*>(::operator new(size, std::align_val_t(kAlignment)));
+            buffer.size = size;
+            ++m_allocatedBuffers;
+            m_allocatedBytes += size;
+        }
+    }
+    
+    Lease* lease = new Lease{shared_from_this(), buffer};
+    return QImage(buffer.data, width, height, bytesPerLine, format, &FramePool::releaseBuffer, lease);
+}
+
+int FramePool::allocatedBuffers() const {
+    QMutexLocker locker(&m_mutex);
+    return m_allocatedBuffers;
+}
+
+qsizetype FramePool::allocatedBytes() const {
+    QMutexLocker locker(&m_mutex);
+    return m_allocatedBytes;
+}
+
+void FramePool::releaseBuffer(void* info) {
+    Lease* lease = static_cast<Lease*>(info);
+    {
+        QMutexLocker locker(&lease->pool->m_mutex);
+        if (lease->pool->m_free.size() < kMaxFreeBuffers) {
+            lease->pool->m_free.push_back(lease->buffer);
+            lease->buffer.data = nullptr;
+        } else {
+            --lease->pool->m_allocatedBuffers;
+            lease->pool->m_allocatedBytes -= lease->buffer.size;
+        }
+    }
+    if (lease->buffer.data) {
+        freeBuffer(lease->buffer);
+    }
+    delete lease;
+}
+
+void FramePool::freeBuffer(Buffer& buffer) {
+    ::operator delete(buffer.data, std::align_val_t(kAlignment));
+    buffer.data = nullptr;
+    buffer.size = 0;
+}
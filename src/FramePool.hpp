@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+// Recycled pixel buffers for decoded frames.
+// acquire() hands out a QImage that wraps a pooled buffer directly (no copy);
+// when the last shallow copy of that image is destroyed, on whichever thread,
+// the buffer goes back to the pool instead of being freed.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+    static std::shared_ptr<FramePool> create();
+    ~FramePool();
+
+    // Image backed by a pooled buffer; scanlines are 64-byte aligned
+    QImage acquire(int width, int height, QImage::Format format = QImage::Format_RGB32);
+
+    // Number of buffers ever allocated (stays flat once playback is warm)
+    int allocatedBuffers() const;
+    qsizetype allocatedBytes() const;
+
+private:
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    struct Buffer {
+        uchar* data = nullptr;
+        qsizetype size = 0;
+    };
+
+    struct Lease {
+        std::shared_ptr<FramePool> pool;
+        Buffer buffer;
+    };
+
+    static void releaseBuffer(void* info);
+    static void freeBuffer(Buffer& buffer);
+
+    mutable QMutex m_mutex;
+    std::vector<Buffer> m_free;
+    int m_allocatedBuffers = 0;
+    qsizetype m_allocatedBytes = 0;
+};
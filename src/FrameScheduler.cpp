@@ -0,0 +1,86 @@
+#include "FrameScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Frames presented later than this are counted as late
+constexpr std::chrono::milliseconds kLateThreshold(4);
+// Falling further behind than this re-anchors the clock instead of dropping
+// a long run of frames (e.g. after a disk stall)
+constexpr std::chrono::milliseconds kResyncThreshold(500);
+}
+
+FrameScheduler::FrameScheduler()
+    : m_mediaAnchor(0.0)
+    , m_speed(1.0)
+    , m_anchored(false)
+    , m_droppedFrames(0)
+    , m_lateFrames(0)
+{
+}
+
+void FrameScheduler::reset(double mediaTime) {
+    m_wallAnchor = Clock::now();
+    m_mediaAnchor = mediaTime;
+    m_anchored = true;
+}
+
+void FrameScheduler::setSpeed(double speed) {
+    if (speed == 0.0 || speed == m_speed) return;
+    
+    if (m_anchored) {
+        // Keep the media position continuous across the rate change
+        double now = mediaTimeNow();
+        m_wallAnchor = Clock::now();
+        m_mediaAnchor = now;
+    }
+    m_speed = speed;
+}
+
+double FrameScheduler::mediaTimeNow() const {
+    if (!m_anchored) return m_mediaAnchor;
+    std::chrono::duration<double> elapsed = Clock::now() - m_wallAnchor;
+    return m_mediaAnchor + elapsed.count() * m_speed;
+}
+
+FrameScheduler::Clock::time_point FrameScheduler::deadline(double pts) const {
+    std::chrono::duration<double> offset((pts - m_mediaAnchor) / m_speed);
+    return m_wallAnchor + std::chrono::duration_cast<Clock::duration>(offset);
+}
+
+FrameScheduler::Decision FrameScheduler::schedule(double pts, double frameDuration, bool successorReady) {
+    if (!m_anchored) {
+        reset(pts);
+        return Decision::Present;
+    }
+    
+    Clock::time_point now = Clock::now();
+    Clock::time_point due = deadline(pts);
+    if (now < due) {
+        return Decision::Wait;
+    }
+    
+    Clock::duration lateness = now - due;
+    if (lateness > kResyncThreshold) {
+        reset(pts);
+        ++m_lateFrames;
+        return Decision::Present;
+    }
+    
+    std::chrono::duration<double> frameInterval(std::max(frameDuration, 0.0) / std::abs(m_speed));
+    if (successorReady && lateness > frameInterval) {
+        ++m_droppedFrames;
+        return Decision::Drop;
+    }
+    
+    if (lateness > kLateThreshold) {
+        ++m_lateFrames;
+    }
+    return Decision::Present;
+}
+
+void FrameScheduler::resetStats() {
+    m_droppedFrames = 0;
+    m_lateFrames = 0;
+}
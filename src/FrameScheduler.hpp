@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+
+// Presentation clock for the playback loop.
+// Maps media time (PTS in seconds) onto a monotonic wall clock so that every
+// frame is shown at its own deadline, independent of how long decoding,
+// color conversion or signal delivery took for the previous frame.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Decision {
+        Wait,    // Deadline not reached yet
+        Present, // Show the frame now
+        Drop     // Too late, skip the frame
+    };
+
+    FrameScheduler();
+
+    // Anchor the clock so that mediaTime is "now" (after seek, pause, loop)
+    void reset(double mediaTime);
+    bool isAnchored() const { return m_anchored; }
+    void invalidate() { m_anchored = false; }
+
+    // Change playback rate without jumping: re-anchors at the current media time.
+    // Negative speeds run the media clock backwards (reverse playback).
+    void setSpeed(double speed);
+    double speed() const { return m_speed; }
+
+    // Media time that should be on screen right now
+    double mediaTimeNow() const;
+
+    // Wall-clock time at which the frame with the given PTS is due
+    Clock::time_point deadline(double pts) const;
+
+    // Decide what to do with the frame at pts; frameDuration is the nominal
+    // media-time distance to the next frame (1 / fps). A late frame is only
+    // dropped when a successor is already decoded, otherwise it is shown late.
+    Decision schedule(double pts, double frameDuration, bool successorReady);
+
+    int droppedFrames() const { return m_droppedFrames; }
+    int lateFrames() const { return m_lateFrames; }
+    void resetStats();
+
+private:
+    Clock::time_point m_wallAnchor;
+    double m_mediaAnchor;
+    double m_speed;
+    bool m_anchored;
+
+    int m_droppedFrames;
+    int m_lateFrames;
+};
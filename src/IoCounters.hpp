@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Storage counters of one open video, updated by the reader's threads and
+// read by whoever reports on them. Cumulative since the video was opened.
+struct IoCounters {
+    std::atomic<int64_t> bytesRead{0};        // Read from storage
+    std::atomic<int64_t> readNanoseconds{0};  // Spent inside storage reads
+    std::atomic<int64_t> stallNanoseconds{0}; // The demuxer waited for data
+    std::atomic<int64_t> seeks{0};            // Reads outside the readahead window
+
+    // Throughput of the medium while it was being read
+    double megabytesPerSecond() const {
+        int64_t nanoseconds = readNanoseconds.load(std::memory_order_relaxed);
+        if (nanoseconds <= 0) return 0.0;
+        return bytesRead.load(std::memory_order_relaxed) / (1024.0 * 1024.0) / (nanoseconds * 1e-9);
+    }
+};
@@ -1,28 +1,67 @@
 #include "MainWindow.hpp"
+#include "ArrowExporter.hpp"
 #include "Config.hpp"
 #include "CsvExporter.hpp"
+#include "CsvImporter.hpp"
+#include "RecordsDelegate.hpp"
 #include "ThemeManager.hpp"
 
 #include <QMenuBar>
+#include <QStatusBar>
 #include <QActionGroup>
 #include <QMenu>
 #include <QAction>
 #include <QTime>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QWheelEvent>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHeaderView>
 #include <QDir>
 #include <QFileInfo>
+#include <QScrollBar>
+#include <QScreen>
+#include <QFontMetrics>
+#include <QSignalBlocker>
+#include <QSqlQueryModel>
+#include <QElapsedTimer>
+#include <algorithm>
+
+namespace {
+
+// "from-to", "from-" or "-to" in MM:SS; a single time starts the range.
+// Unreadable ends leave from and to as they are.
+void parseTimeRange(const QString& text, double& from, double& to) {
+    const QString range = text.trimmed();
+    if (range.isEmpty()) return;
+    const int dash = range.indexOf('-');
+    const QString start = dash < 0 ? range : range.left(dash);
+    const QString end = dash < 0 ? QString() : range.mid(dash + 1);
+    if (!start.trimmed().isEmpty()) {
+        from = BehaviorRecord::parseTime(start).value_or(from);
+    }
+    if (!end.trimmed().isEmpty()) {
+        to = BehaviorRecord::parseTime(end).value_or(to);
+    }
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
-    , m_workerThread(nullptr)
+    , m_engine(nullptr)
     , m_worker(nullptr)
     , m_isSliderPressed(false)
     , m_duration(0.0)
     , m_currentPosition(0.0)
+    , m_scrubTarget(-1.0)
+    , m_replayPlayer(nullptr)
+    , m_shownSerial(0)
+    , m_loopStart(0)
+    , m_resumeAfterReplay(false)
+    , m_proxies(nullptr)
+    , m_viewOriginal(false)
     , m_currentVideoIndex(0)
     , m_stateStartTime(0.0)
     , m_stateActive(false)
@@ -36,19 +75,52 @@ MainWindow::MainWindow(QWidget* parent)
     setupUi();
     setupDockWidgets();
     
+    // Playback engine outlives individual videos
+    m_engine = new PlaybackEngine(this);
+    connect(m_engine, &PlaybackEngine::videoOpened, this, &MainWindow::onVideoOpened);
+    connect(m_engine, &PlaybackEngine::durationChanged, this, &MainWindow::onDurationChanged);
+    connect(m_engine, &PlaybackEngine::playbackStats, this, &MainWindow::onPlaybackStats);
+    connect(m_engine, &PlaybackEngine::errorOccurred, this, &MainWindow::onVideoError);
+    connect(m_engine, &PlaybackEngine::videoSwitched, this, &MainWindow::onVideoSwitched);
+    
+    // Pull the latest presented frame once per display refresh. Frames the
+    // GUI was too busy to show are replaced in the worker, never queued here.
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    double refreshRate = std::clamp(screen()->refreshRate(), 30.0, 240.0);
+    m_frameTimer->setInterval(static_cast<int>(1000.0 / refreshRate));
+    connect(m_frameTimer, &QTimer::timeout, this, &MainWindow::pullFrame);
+    m_frameTimer->start();
+    
+    // Shown frames are kept compressed for instant replay and A-B loops
+    m_replayBuffer = std::make_shared<ReplayBuffer>(Config::instance().replaySeconds());
+    m_replayPlayer = new ReplayPlayer(m_replayBuffer, this);
+    connect(m_replayPlayer, &ReplayPlayer::frameReady, this, [this](const VideoFrame& frame) {
+        m_frameItem->setFrame(frame);
+    });
+    connect(m_replayPlayer, &ReplayPlayer::finished, this, &MainWindow::onReplayFinished);
+    
+    // Heavy sources get low-resolution proxies in the background
+    ProxyGenerator::Options proxyOptions;
+    proxyOptions.height = Config::instance().proxyHeight();
+    proxyOptions.minSourceHeight = Config::instance().proxyMinSourceHeight();
+    proxyOptions.threads = Config::instance().proxyThreads();
+    m_proxies = new ProxyGenerator(proxyOptions, this);
+    connect(m_proxies, &ProxyGenerator::progress, this, &MainWindow::onProxyProgress);
+    connect(m_proxies, &ProxyGenerator::proxyReady, this, &MainWindow::onProxyReady);
+    connect(m_proxies, &ProxyGenerator::proxyFailed, this, &MainWindow::onProxyFailed);
+    
     resize(1280, 720);
     setWindowTitle("Behaviour Labeling (C++ Port)");
 }
 
 MainWindow::~MainWindow() {
-    // Clean shutdown of thread
-    if (m_worker) {
-        m_worker->stop();
-    }
-    if (m_workerThread) {
-        m_workerThread->quit();
-        m_workerThread->wait();
-    }
+    // Clean shutdown of all worker threads; an unfinished save is dropped
+    // before the records it reads go away
+    delete m_recordsJob;
+    m_projectModel->clear(); // Its query goes before the connection
+    delete m_proxies;
+    delete m_engine;
 }
 
 void MainWindow::setupUi() {
@@ -72,8 +144,17 @@ void MainWindow::setupUi() {
     // Install event filter for Zooming
     m_view->viewport()->installEventFilter(this);
     
-    m_pixmapItem = new QGraphicsPixmapItem();
-    m_scene->addItem(m_pixmapItem);
+    // Tell the worker what is visible so it only converts what is shown
+    m_viewportTimer = new QTimer(this);
+    m_viewportTimer->setSingleShot(true);
+    m_viewportTimer->setInterval(30);
+    connect(m_viewportTimer, &QTimer::timeout, this, &MainWindow::reportViewport);
+    auto scheduleViewportReport = [this]() { m_viewportTimer->start(); };
+    connect(m_view->horizontalScrollBar(), &QScrollBar::valueChanged, this, scheduleViewportReport);
+    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged, this, scheduleViewportReport);
+    
+    m_frameItem = new FrameItem();
+    m_scene->addItem(m_frameItem);
     
     mainLayout->addWidget(m_view, 1); // Stretch factor 1
     
@@ -84,10 +165,20 @@ void MainWindow::setupUi() {
     m_prevButton->setFixedWidth(40);
     connect(m_prevButton, &QPushButton::clicked, this, &MainWindow::loadPrevVideo);
     
+    m_stepBackButton = new QPushButton("◂");
+    m_stepBackButton->setFixedWidth(30);
+    m_stepBackButton->setToolTip("Step back one frame (,)");
+    connect(m_stepBackButton, &QPushButton::clicked, this, &MainWindow::stepBackward);
+    
     m_playButton = new QPushButton("▶");
     m_playButton->setFixedWidth(40);
     connect(m_playButton, &QPushButton::clicked, this, &MainWindow::togglePlayPause);
     
+    m_stepForwardButton = new QPushButton("▸");
+    m_stepForwardButton->setFixedWidth(30);
+    m_stepForwardButton->setToolTip("Step forward one frame (.)");
+    connect(m_stepForwardButton, &QPushButton::clicked, this, &MainWindow::stepForward);
+    
     m_nextButton = new QPushButton("⏭");
     m_nextButton->setFixedWidth(40);
     connect(m_nextButton, &QPushButton::clicked, this, &MainWindow::loadNextVideo);
@@ -96,19 +187,28 @@ void MainWindow::setupUi() {
     m_timeLabel->setMinimumWidth(100);
     
     m_seekSlider = new QSlider(Qt::Horizontal);
-    m_seekSlider->setRange(0, 1000); // Precision 0.1%
+    m_seekSlider->setRange(0, 0); // Milliseconds, set once the duration is known
     connect(m_seekSlider, &QSlider::sliderPressed, this, &MainWindow::onSliderPressed);
     connect(m_seekSlider, &QSlider::sliderReleased, this, &MainWindow::onSliderReleased);
     connect(m_seekSlider, &QSlider::valueChanged, this, &MainWindow::onSliderMoved);
     
     m_speedCombo = new QComboBox();
-    m_speedCombo->addItems({"0.5x", "0.75x", "1.0x", "1.25x", "1.5x", "2.0x"});
-    m_speedCombo->setCurrentIndex(2); // 1.0x default
+    const QList<QPair<QString, double>> speeds = {
+        {"◀ 1.0x", -1.0}, {"◀ 0.5x", -0.5}, {"◀ 0.25x", -0.25},
+        {"0.5x", 0.5}, {"0.75x", 0.75}, {"1.0x", 1.0}, {"1.25x", 1.25}, {"1.5x", 1.5}, {"2.0x", 2.0},
+        {"4x ⏩", 4.0}, {"8x ⏩", 8.0}, {"16x ⏩", 16.0}, {"32x ⏩", 32.0} // Keyframe skimming
+    };
+    for (const auto& speed : speeds) {
+        m_speedCombo->addItem(speed.first, speed.second);
+    }
+    m_speedCombo->setCurrentIndex(m_speedCombo->findData(1.0)); // 1.0x default
     connect(m_speedCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &MainWindow::onSpeedChanged);
     
     controlsLayout->addWidget(m_prevButton);
+    controlsLayout->addWidget(m_stepBackButton);
     controlsLayout->addWidget(m_playButton);
+    controlsLayout->addWidget(m_stepForwardButton);
     controlsLayout->addWidget(m_nextButton);
     controlsLayout->addWidget(m_timeLabel);
     controlsLayout->addWidget(m_seekSlider, 1);
@@ -116,6 +216,12 @@ void MainWindow::setupUi() {
     
     mainLayout->addLayout(controlsLayout);
     
+    // Playback diagnostics
+    m_playbackStatsLabel = new QLabel();
+    statusBar()->addPermanentWidget(m_playbackStatsLabel);
+    m_proxyStatusLabel = new QLabel();
+    statusBar()->addPermanentWidget(m_proxyStatusLabel);
+    
     // Menu
     QMenu* fileMenu = menuBar()->addMenu("File");
     QAction* openAction = fileMenu->addAction("Open Video...");
@@ -128,6 +234,58 @@ void MainWindow::setupUi() {
     
     QAction* saveAction = fileMenu->addAction("Save Records...");
     connect(saveAction, &QAction::triggered, this, &MainWindow::saveRecords);
+    
+    QAction* importAction = fileMenu->addAction("Import Records...");
+    connect(importAction, &QAction::triggered, this, &MainWindow::importRecords);
+    
+    QMenu* playbackMenu = menuBar()->addMenu("Playback");
+    QAction* stepBackAction = playbackMenu->addAction("Step Back One Frame");
+    stepBackAction->setShortcut(QKeySequence(Qt::Key_Comma));
+    connect(stepBackAction, &QAction::triggered, this, &MainWindow::stepBackward);
+    
+    QAction* stepForwardAction = playbackMenu->addAction("Step Forward One Frame");
+    stepForwardAction->setShortcut(QKeySequence(Qt::Key_Period));
+    connect(stepForwardAction, &QAction::triggered, this, &MainWindow::stepForward);
+    
+    playbackMenu->addSeparator();
+    
+    QAction* replayAction = playbackMenu->addAction("Instant Replay");
+    replayAction->setShortcut(QKeySequence(Qt::Key_R));
+    connect(replayAction, &QAction::triggered, this, &MainWindow::instantReplay);
+    
+    QAction* loopStartAction = playbackMenu->addAction("Set Loop Start (A)");
+    loopStartAction->setShortcut(QKeySequence(Qt::Key_BracketLeft));
+    connect(loopStartAction, &QAction::triggered, this, &MainWindow::setLoopStart);
+    
+    QAction* loopEndAction = playbackMenu->addAction("Set Loop End (B) and Loop");
+    loopEndAction->setShortcut(QKeySequence(Qt::Key_BracketRight));
+    connect(loopEndAction, &QAction::triggered, this, &MainWindow::setLoopEnd);
+    
+    QAction* stopReplayAction = playbackMenu->addAction("Stop Replay");
+    stopReplayAction->setShortcut(QKeySequence(Qt::Key_Escape));
+    connect(stopReplayAction, &QAction::triggered, this, &MainWindow::stopReplay);
+    
+    playbackMenu->addSeparator();
+    
+    m_viewOriginalAction = playbackMenu->addAction("View Original (Full Resolution)");
+    m_viewOriginalAction->setCheckable(true);
+    m_viewOriginalAction->setShortcut(QKeySequence(Qt::Key_O));
+    m_viewOriginalAction->setEnabled(ProxyGenerator::isAvailable() && Config::instance().proxiesEnabled());
+    connect(m_viewOriginalAction, &QAction::toggled, this, &MainWindow::setViewOriginal);
+    
+    // Decoder submenu
+    QMenu* decoderMenu = playbackMenu->addMenu("Decoder");
+    QActionGroup* decoderGroup = new QActionGroup(this);
+    decoderGroup->setExclusive(true);
+    for (const QString& backend : VideoDecoder::availableBackends()) {
+        QAction* action = decoderMenu->addAction(backend == "ffmpeg" ? "FFmpeg" : "OpenCV");
+        action->setCheckable(true);
+        action->setChecked(backend == Config::instance().decoderBackend());
+        decoderGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, backend]() {
+            setDecoderBackend(backend);
+        });
+    }
 }
 
 void MainWindow::setupDockWidgets() {
@@ -152,11 +310,20 @@ void MainWindow::setupDockWidgets() {
     setupRecordsDock();
     addDockWidget(Qt::BottomDockWidgetArea, m_recordsDock);
     
+    // Project Dock (Bottom, tabbed with the records)
+    m_projectDock = new QDockWidget("Project", this);
+    m_projectDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+    setupProjectDock();
+    addDockWidget(Qt::BottomDockWidgetArea, m_projectDock);
+    tabifyDockWidget(m_recordsDock, m_projectDock);
+    m_recordsDock->raise();
+    
     // Add view menu for dock visibility
     QMenu* viewMenu = menuBar()->addMenu("View");
     viewMenu->addAction(m_behaviorDock->toggleViewAction());
     viewMenu->addAction(m_controlsDock->toggleViewAction());
     viewMenu->addAction(m_recordsDock->toggleViewAction());
+    viewMenu->addAction(m_projectDock->toggleViewAction());
     
     viewMenu->addSeparator();
     
@@ -296,18 +463,57 @@ void MainWindow::setupRecordsDock() {
     QWidget* container = new QWidget();
     QVBoxLayout* layout = new QVBoxLayout(container);
     
-    m_recordsTable = new QTableWidget();
-    m_recordsTable->setColumnCount(4);
-    m_recordsTable->setHorizontalHeaderLabels({"Time", "Behavior", "Type", ""});
-    m_recordsTable->horizontalHeader()->setStretchLastSection(false);
-    m_recordsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-    m_recordsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
-    m_recordsTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    m_recordsTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
-    m_recordsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_recordsTable->setAlternatingRowColors(true);
-    
-    layout->addWidget(m_recordsTable);
+    // Filters: behavior, animal tag and start time range
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    m_recordsBehaviorFilter = new QComboBox();
+    m_recordsBehaviorFilter->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_recordsBehaviorFilter->addItem("All behaviors");
+    connect(m_recordsBehaviorFilter, &QComboBox::currentIndexChanged, this, &MainWindow::applyRecordsFilter);
+    filterLayout->addWidget(m_recordsBehaviorFilter);
+    
+    m_recordsTagFilter = new QLineEdit();
+    m_recordsTagFilter->setPlaceholderText("Tag");
+    m_recordsTagFilter->setClearButtonEnabled(true);
+    connect(m_recordsTagFilter, &QLineEdit::textChanged, this, &MainWindow::applyRecordsFilter);
+    filterLayout->addWidget(m_recordsTagFilter);
+    
+    m_recordsTimeFilter = new QLineEdit();
+    m_recordsTimeFilter->setPlaceholderText("Time, e.g. 02:00-05:30");
+    m_recordsTimeFilter->setClearButtonEnabled(true);
+    connect(m_recordsTimeFilter, &QLineEdit::textChanged, this, &MainWindow::applyRecordsFilter);
+    filterLayout->addWidget(m_recordsTimeFilter);
+    layout->addLayout(filterLayout);
+    
+    // Model/view: rows are painted on demand, so long sessions stay cheap
+    m_recordsModel = new RecordsModel(Config::instance().recordVocabulary(), this);
+    connect(m_recordsModel, &RecordsModel::behaviorsChanged, this, &MainWindow::updateBehaviorFilter);
+    
+    m_recordsView = new QTableView();
+    m_recordsView->setModel(m_recordsModel);
+    RecordsDelegate* delegate = new RecordsDelegate(m_recordsView);
+    connect(delegate, &RecordsDelegate::deleteRequested, this, &MainWindow::deleteRecord);
+    m_recordsView->setItemDelegate(delegate);
+    
+    // Fixed row heights and column widths: nothing is measured per row
+    QFontMetrics metrics(m_recordsView->font());
+    QHeaderView* header = m_recordsView->horizontalHeader();
+    header->setStretchLastSection(false);
+    header->setSectionResizeMode(RecordsModel::TimeColumn, QHeaderView::Interactive);
+    header->setSectionResizeMode(RecordsModel::BehaviorColumn, QHeaderView::Stretch);
+    header->setSectionResizeMode(RecordsModel::TypeColumn, QHeaderView::Interactive);
+    header->setSectionResizeMode(RecordsModel::DeleteColumn, QHeaderView::Fixed);
+    header->resizeSection(RecordsModel::TimeColumn, metrics.horizontalAdvance("000:00 - 000:00") + 16);
+    header->resizeSection(RecordsModel::TypeColumn, metrics.horizontalAdvance("STATE") + 24);
+    header->resizeSection(RecordsModel::DeleteColumn, 36);
+    m_recordsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_recordsView->verticalHeader()->setDefaultSectionSize(32);
+    m_recordsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_recordsView->setAlternatingRowColors(true);
+    m_recordsView->setMouseTracking(true);
+    m_recordsView->setSortingEnabled(true);
+    m_recordsView->sortByColumn(RecordsModel::TimeColumn, Qt::AscendingOrder);
+    
+    layout->addWidget(m_recordsView);
     
     // Save button
     QHBoxLayout* buttonLayout = new QHBoxLayout();
@@ -320,6 +526,81 @@ void MainWindow::setupRecordsDock() {
     m_recordsDock->setWidget(container);
 }
 
+void MainWindow::setupProjectDock() {
+    QWidget* container = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    const RecordStore::Vocabulary vocabulary = Config::instance().recordVocabulary();
+    
+    // Filters: video, behavior, category, animal tag and start time range
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    m_projectVideoFilter = new QComboBox();
+    m_projectVideoFilter->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_projectVideoFilter->addItem("All videos");
+    connect(m_projectVideoFilter, &QComboBox::currentIndexChanged, this, &MainWindow::applyProjectQuery);
+    filterLayout->addWidget(m_projectVideoFilter);
+    
+    m_projectBehaviorFilter = new QComboBox();
+    m_projectBehaviorFilter->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_projectBehaviorFilter->addItem("All behaviors");
+    m_projectBehaviorFilter->addItems(vocabulary.behaviours);
+    connect(m_projectBehaviorFilter, &QComboBox::currentIndexChanged, this, &MainWindow::applyProjectQuery);
+    filterLayout->addWidget(m_projectBehaviorFilter);
+    
+    m_projectCategoryFilter = new QComboBox();
+    m_projectCategoryFilter->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_projectCategoryFilter->addItem("All categories");
+    m_projectCategoryFilter->addItems(vocabulary.parentBehaviours);
+    connect(m_projectCategoryFilter, &QComboBox::currentIndexChanged, this, &MainWindow::applyProjectQuery);
+    filterLayout->addWidget(m_projectCategoryFilter);
+    
+    m_projectTagFilter = new QLineEdit();
+    m_projectTagFilter->setPlaceholderText("Tag");
+    m_projectTagFilter->setClearButtonEnabled(true);
+    connect(m_projectTagFilter, &QLineEdit::textChanged, this, &MainWindow::applyProjectQuery);
+    filterLayout->addWidget(m_projectTagFilter);
+    
+    m_projectTimeFilter = new QLineEdit();
+    m_projectTimeFilter->setPlaceholderText("Time, e.g. 02:00-05:30");
+    m_projectTimeFilter->setClearButtonEnabled(true);
+    connect(m_projectTimeFilter, &QLineEdit::textChanged, this, &MainWindow::applyProjectQuery);
+    filterLayout->addWidget(m_projectTimeFilter);
+    layout->addLayout(filterLayout);
+    
+    // Rows are fetched from the database as the table scrolls
+    m_projectModel = new QSqlQueryModel(this);
+    m_projectView = new QTableView();
+    m_projectView->setModel(m_projectModel);
+    m_projectView->horizontalHeader()->setStretchLastSection(true);
+    m_projectView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_projectView->verticalHeader()->setDefaultSectionSize(28);
+    m_projectView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_projectView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_projectView->setAlternatingRowColors(true);
+    layout->addWidget(m_projectView);
+    
+    // Count and total duration of the matches; CSV files changed outside
+    // the app are picked up by a rescan
+    QHBoxLayout* statusLayout = new QHBoxLayout();
+    m_projectSummaryLabel = new QLabel("Open a video directory to search the records of all its videos");
+    statusLayout->addWidget(m_projectSummaryLabel);
+    statusLayout->addStretch();
+    QPushButton* rescanButton = new QPushButton("⟳ Rescan Files");
+    connect(rescanButton, &QPushButton::clicked, this, &MainWindow::syncProject);
+    statusLayout->addWidget(rescanButton);
+    layout->addLayout(statusLayout);
+    
+    // Each label would otherwise query the whole project again
+    m_projectRefreshTimer = new QTimer(this);
+    m_projectRefreshTimer->setSingleShot(true);
+    m_projectRefreshTimer->setInterval(500);
+    connect(m_projectRefreshTimer, &QTimer::timeout, this, &MainWindow::refreshProject);
+    connect(m_projectDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) refreshProject();
+    });
+    
+    m_projectDock->setWidget(container);
+}
+
 bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
     if (obj == m_view->viewport() && event->type() == QEvent::Wheel) {
         QWheelEvent* wheelEvent = static_cast<QWheelEvent*>(event);
@@ -330,24 +611,32 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
                 scaleFactor = 1.0 / scaleFactor;
             }
             m_view->scale(scaleFactor, scaleFactor);
+            m_viewportTimer->start();
             return true; // Consume the event
         }
     }
+    if (obj == m_view->viewport() && event->type() == QEvent::Resize) {
+        m_viewportTimer->start();
+    }
     return QMainWindow::eventFilter(obj, event);
 }
 
 void MainWindow::openVideo() {
+    if (m_recordsJob) return;
     QString path = QFileDialog::getOpenFileName(this, "Open Video", "", 
         "Video Files (*.mp4 *.avi *.mkv *.mov *.wmv)");
     if (!path.isEmpty()) {
         m_videoDir.clear();
         m_videoFiles.clear();
         m_currentVideoIndex = 0;
-        startWorker(path);
+        openProject(QString()); // A single video has no project
+        loadVideo(path);
+        queueProxies();
     }
 }
 
 void MainWindow::openVideoDirectory() {
+    if (m_recordsJob) return;
     QString dir = QFileDialog::getExistingDirectory(this, "Open Video Directory");
     if (!dir.isEmpty()) {
         m_videoDir = dir;
@@ -356,6 +645,8 @@ void MainWindow::openVideoDirectory() {
         QDir qdir(dir);
         QStringList filters = {"*.mp4", "*.avi", "*.mkv", "*.mov", "*.wmv"};
         m_videoFiles = qdir.entryList(filters, QDir::Files, QDir::Name);
+        m_videoFiles.erase(std::remove_if(m_videoFiles.begin(), m_videoFiles.end(), &ProxyGenerator::isProxyFile),
+                           m_videoFiles.end());
         
         if (m_videoFiles.isEmpty()) {
             QMessageBox::information(this, "No Videos", "No video files found in directory.");
@@ -363,88 +654,184 @@ void MainWindow::openVideoDirectory() {
         }
         
         m_currentVideoIndex = 0;
-        m_records.clear();
-        updateRecordsDisplay();
-        clearActiveState();
-        
-        QString videoPath = qdir.filePath(m_videoFiles[m_currentVideoIndex]);
-        startWorker(videoPath);
+        openProject(dir);
+        loadVideo(qdir.filePath(m_videoFiles[m_currentVideoIndex]));
+        queueProxies();
+        syncProject();
+    }
+}
+
+void MainWindow::loadVideo(const QString& path) {
+    m_recordsModel->clear();
+    clearActiveState();
+    
+    // Unsaved labels of this video from an earlier run (or before ⏮/⏭)
+    SessionJournal::Recovered recovered;
+    m_journal.open(path, recovered);
+    m_recordsModel->append(recovered.records);
+    m_project.setUnsaved(path, recovered.records);
+    refreshProject();
+    if (recovered.activeState) {
+        const SessionJournal::ActiveState& state = *recovered.activeState;
+        showActiveState(state.parentBehaviour, state.behaviour, state.startTime, state.startFrame);
+    }
+    
+    startWorker(path);
+    
+    // Continue where the labeling stopped, paused
+    if (recovered.position) {
+        m_worker->seek(*recovered.position);
+        m_worker->setPaused(true);
+        m_playButton->setText("▶");
+    }
+    if (!recovered.records.empty() || recovered.activeState) {
+        statusBar()->showMessage(QString("Restored %1 unsaved records%2")
+            .arg(recovered.records.size())
+            .arg(recovered.activeState ? " and an active state" : ""), 5000);
     }
 }
 
 void MainWindow::startWorker(const QString& path) {
-    // Clean up previous
-    if (m_workerThread) {
-        m_worker->stop();
-        m_workerThread->quit();
-        m_workerThread->wait();
-        delete m_worker;
-        delete m_workerThread;
-    }
-    
-    m_workerThread = new QThread;
-    m_worker = new VideoWorker(path);
-    m_worker->moveToThread(m_workerThread);
-    
-    // Connections
-    connect(m_workerThread, &QThread::started, m_worker, &VideoWorker::process);
-    connect(m_worker, &VideoWorker::frameReady, this, &MainWindow::updateFrame);
-    connect(m_worker, &VideoWorker::videoOpened, this, &MainWindow::onVideoOpened);
-    connect(m_worker, &VideoWorker::positionChanged, this, &MainWindow::onPositionChanged);
-    connect(m_worker, &VideoWorker::errorOccurred, this, &MainWindow::onVideoError);
-    connect(m_worker, &VideoWorker::finished, m_workerThread, &QThread::quit);
-    
-    // Start
-    m_workerThread->start();
+    m_replayPlayer->stop();
+    m_replayBuffer->clear();
+    m_lastFrame = VideoFrame();
+    m_loopStart = 0;
+    m_frameItem->clearShownFrame();
+    m_videoPath = path;
+    m_proxies->prioritize(path);
+    QString playedPath = playbackPath(path);
+    m_engine->open(playedPath);
+    m_worker = m_engine->activeWorker();
+    m_worker->setSpeed(m_speedCombo->currentData().toDouble());
+    
+    // Prime the neighbouring files so ⏮/⏭ switch instantly
+    QStringList prefetch;
+    if (m_videoFiles.size() > 1) {
+        QDir dir(m_videoDir);
+        int count = m_videoFiles.size();
+        prefetch << playbackPath(dir.filePath(m_videoFiles[(m_currentVideoIndex + 1) % count]));
+        if (count > 2) {
+            prefetch << playbackPath(dir.filePath(m_videoFiles[(m_currentVideoIndex - 1 + count) % count]));
+        }
+    }
+    m_engine->setPrefetch(prefetch);
+    
     m_playButton->setText("⏸");
+    m_playbackStatsLabel->clear();
     
     // Update window title
     QFileInfo fileInfo(path);
-    setWindowTitle(QString("Behaviour Labeling - %1").arg(fileInfo.fileName()));
+    setWindowTitle(QString("Behaviour Labeling - %1%2").arg(fileInfo.fileName(),
+                   playedPath != path ? " (proxy)" : ""));
+}
+
+void MainWindow::reopenCurrentVideo(bool restartWorkers) {
+    // Same position and pause state; proxy and original share one timeline
+    if (m_videoPath.isEmpty()) return;
+    double position = m_currentPosition;
+    bool paused = m_playButton->text() == "▶";
+    if (restartWorkers) m_engine->closeAll();
+    startWorker(m_videoPath);
+    m_worker->seek(position);
+    if (paused) {
+        m_worker->setPaused(true);
+        m_playButton->setText("▶");
+    }
+}
+
+void MainWindow::keepVisibleArea() {
+    QRectF scene = m_scene->sceneRect();
+    if (scene.isEmpty()) return;
+    QRectF visible = m_view->mapToScene(m_view->viewport()->rect()).boundingRect().intersected(scene);
+    m_pendingView = QRectF((visible.x() - scene.x()) / scene.width(), (visible.y() - scene.y()) / scene.height(),
+                           visible.width() / scene.width(), visible.height() / scene.height());
+}
+
+QString MainWindow::playbackPath(const QString& videoPath) const {
+    if (m_viewOriginal || !Config::instance().proxiesEnabled()) return videoPath;
+    QString proxy = ProxyGenerator::proxyFor(videoPath);
+    return proxy.isEmpty() ? videoPath : proxy;
+}
+
+void MainWindow::queueProxies() {
+    if (!Config::instance().proxiesEnabled()) return;
+    
+    // Current video first, then onwards in the order they will be watched
+    QStringList queue{m_videoPath};
+    QDir dir(m_videoDir);
+    for (int i = 1; i < m_videoFiles.size(); ++i) {
+        queue << dir.filePath(m_videoFiles[(m_currentVideoIndex + i) % m_videoFiles.size()]);
+    }
+    m_proxies->setQueue(queue);
 }
 
 void MainWindow::loadNextVideo() {
-    if (m_videoFiles.isEmpty()) return;
+    if (m_videoFiles.isEmpty() || m_recordsJob) return;
     
     m_currentVideoIndex = (m_currentVideoIndex + 1) % m_videoFiles.size();
-    QString videoPath = QDir(m_videoDir).filePath(m_videoFiles[m_currentVideoIndex]);
-    
-    m_records.clear();
-    updateRecordsDisplay();
-    clearActiveState();
-    
-    startWorker(videoPath);
+    loadVideo(QDir(m_videoDir).filePath(m_videoFiles[m_currentVideoIndex]));
 }
 
 void MainWindow::loadPrevVideo() {
-    if (m_videoFiles.isEmpty()) return;
+    if (m_videoFiles.isEmpty() || m_recordsJob) return;
     
     m_currentVideoIndex = (m_currentVideoIndex - 1 + m_videoFiles.size()) % m_videoFiles.size();
-    QString videoPath = QDir(m_videoDir).filePath(m_videoFiles[m_currentVideoIndex]);
+    loadVideo(QDir(m_videoDir).filePath(m_videoFiles[m_currentVideoIndex]));
+}
+
+void MainWindow::pullFrame() {
+    // A replay owns the display; playback is paused and its frame waits
+    if (m_replayPlayer->isPlaying()) return;
     
-    m_records.clear();
-    updateRecordsDisplay();
-    clearActiveState();
+    VideoFrame frame;
+    if (!m_engine->takeFrame(frame)) return;
+    
+    // Drawn directly from the pooled buffer, no QPixmap conversion
+    m_frameItem->setFrame(frame);
+    onPositionChanged(frame.pts);
     
-    startWorker(videoPath);
+    m_lastFrame = frame;
+    m_shownSerial = m_replayBuffer->record(frame);
 }
 
-void MainWindow::updateFrame(const QImage& frame) {
-    // Convert to Pixmap (must be done in GUI thread)
-    m_pixmapItem->setPixmap(QPixmap::fromImage(frame));
+void MainWindow::reportViewport() {
+    if (!m_worker) return;
+    
+    QRectF visible = m_frameItem->mapFromScene(m_view->mapToScene(m_view->viewport()->rect())).boundingRect();
+    double scale = m_view->transform().m11() * m_view->devicePixelRatioF();
+    m_worker->setViewport(visible, scale);
 }
 
 void MainWindow::onVideoOpened(double duration, double fps, int width, int height) {
-    m_duration = duration;
+    onDurationChanged(duration);
     m_scene->setSceneRect(0, 0, width, height);
-    m_view->fitInView(m_pixmapItem, Qt::KeepAspectRatio);
+    m_frameItem->setSourceSize(QSize(width, height));
+    if (!m_pendingView.isNull()) {
+        // Same part of the picture after switching between proxy and original
+        m_view->fitInView(QRectF(m_pendingView.x() * width, m_pendingView.y() * height,
+                                 m_pendingView.width() * width, m_pendingView.height() * height),
+                          Qt::KeepAspectRatio);
+        m_pendingView = QRectF();
+    } else {
+        m_view->fitInView(m_frameItem, Qt::KeepAspectRatio);
+    }
+    reportViewport();
+}
+
+void MainWindow::onDurationChanged(double duration) {
+    // The slider works in milliseconds of real PTS
+    m_duration = duration;
+    m_seekSlider->blockSignals(true);
+    m_seekSlider->setRange(0, static_cast<int>(duration * 1000.0));
+    m_seekSlider->blockSignals(false);
 }
 
 void MainWindow::onPositionChanged(double pos) {
     m_currentPosition = pos;
+    m_journal.setPosition(pos);
     
     if (!m_isSliderPressed) {
-        int sliderVal = static_cast<int>((pos / m_duration) * 1000.0);
+        int sliderVal = static_cast<int>(pos * 1000.0);
         m_seekSlider->blockSignals(true);
         m_seekSlider->setValue(sliderVal);
         m_seekSlider->blockSignals(false);
@@ -458,11 +845,39 @@ void MainWindow::onPositionChanged(double pos) {
     }
 }
 
+void MainWindow::onPlaybackStats(const PlaybackStats& stats) {
+    int cacheHitPercent = stats.cacheLookups > 0 ? static_cast<int>(stats.cacheHits * 100 / stats.cacheLookups) : 0;
+    m_playbackStatsLabel->setText(QString("Dropped: %1  Late: %2  Unshown: %3  Copied: %4 KB/frame  Buffer: %5 frames, %6/%7 MB  Cache hits: %8%")
+        .arg(stats.droppedFrames)
+        .arg(stats.lateFrames)
+        .arg(stats.overwrittenFrames)
+        .arg(stats.bytesCopiedPerFrame / 1024)
+        .arg(stats.bufferedFrames)
+        .arg(stats.bufferedBytes / (1024 * 1024))
+        .arg(stats.bufferBudget / (1024 * 1024))
+        .arg(cacheHitPercent));
+    if (stats.ioBytesRead > 0) {
+        m_playbackStatsLabel->setText(m_playbackStatsLabel->text() + QString("  Disk: %1 MB/s, waited %2 ms")
+            .arg(stats.ioMegabytesPerSecond, 0, 'f', 1)
+            .arg(stats.ioStallMs));
+    }
+}
+
+void MainWindow::onVideoSwitched(const QString& path, double timeToFirstFrameMs) {
+    statusBar()->showMessage(QString("%1: first frame in %2 ms")
+        .arg(QFileInfo(path).fileName())
+        .arg(timeToFirstFrameMs, 0, 'f', 1), 5000);
+}
+
 void MainWindow::onVideoError(const QString& message) {
     QMessageBox::critical(this, "Video Error", message);
 }
 
 void MainWindow::togglePlayPause() {
+    if (m_replayPlayer->isPlaying()) {
+        stopReplay();
+        return;
+    }
     if (m_worker) {
         bool isPaused = (m_playButton->text() == "▶");
         m_worker->setPaused(!isPaused);
@@ -471,16 +886,20 @@ void MainWindow::togglePlayPause() {
 }
 
 void MainWindow::onSliderPressed() {
+    stopReplay();
     m_isSliderPressed = true;
+    m_scrubTarget = -1.0;
     if (m_worker) m_worker->setPaused(true);
 }
 
 void MainWindow::onSliderReleased() {
     m_isSliderPressed = false;
     if (m_worker) {
-        // Seek to position
-        double pct = m_seekSlider->value() / 1000.0;
-        m_worker->seek(pct * m_duration);
+        // Seek to position (unless live scrubbing already did)
+        double target = m_seekSlider->value() / 1000.0;
+        if (target != m_scrubTarget) {
+            m_worker->seek(target);
+        }
         m_worker->setPaused(false);
         m_playButton->setText("⏸");
     }
@@ -489,24 +908,158 @@ void MainWindow::onSliderReleased() {
 void MainWindow::onSliderMoved(int value) {
     // Update time label during drag
     if (m_isSliderPressed && m_duration > 0) {
-        double pos = (value / 1000.0) * m_duration;
+        double pos = value / 1000.0;
         QTime c(0,0);
         c = c.addSecs(static_cast<int>(pos));
         QTime t(0,0);
         t = t.addSecs(static_cast<int>(m_duration));
         m_timeLabel->setText(c.toString("mm:ss") + " / " + t.toString("mm:ss"));
+        
+        if (m_worker) {
+            // Instant preview from the thumbnail strip, then the exact frame
+            // once the worker's (coalesced) seek lands
+            QImage thumbnail = m_worker->thumbnails()->thumbnailAt(pos);
+            if (!thumbnail.isNull()) {
+                m_frameItem->setImage(thumbnail);
+            }
+            m_scrubTarget = pos;
+            m_worker->seek(pos);
+        }
     }
 }
 
 void MainWindow::onSpeedChanged(int index) {
+    if (!m_worker || index < 0) return;
+    
+    m_worker->setSpeed(m_speedCombo->itemData(index).toDouble());
+}
+
+void MainWindow::stepForward() {
     if (!m_worker) return;
+    stopReplay();
     
-    static const double speeds[] = {0.5, 0.75, 1.0, 1.25, 1.5, 2.0};
-    if (index >= 0 && index < 6) {
-        m_worker->setSpeed(speeds[index]);
+    // Stepping implies pausing
+    m_worker->setPaused(true);
+    m_playButton->setText("▶");
+    m_worker->stepForward();
+}
+
+void MainWindow::stepBackward() {
+    if (!m_worker) return;
+    stopReplay();
+    
+    m_worker->setPaused(true);
+    m_playButton->setText("▶");
+    m_worker->stepBackward();
+}
+
+void MainWindow::setDecoderBackend(const QString& backend) {
+    if (backend == Config::instance().decoderBackend()) return;
+    Config::instance().setDecoderBackend(backend);
+    
+    // Reopen the current video with the new decoder at the same position
+    reopenCurrentVideo(true);
+}
+
+void MainWindow::setViewOriginal(bool original) {
+    if (original == m_viewOriginal) return;
+    m_viewOriginal = original;
+    
+    // Only worth reopening if a proxy is (or was) playing
+    if (!m_videoPath.isEmpty() && !ProxyGenerator::proxyFor(m_videoPath).isEmpty()) {
+        keepVisibleArea();
+        reopenCurrentVideo(false);
     }
 }
 
+void MainWindow::onProxyProgress(const QString& videoPath, double fraction) {
+    m_proxyStatusLabel->setText(QString("Proxy: %1 %2%")
+        .arg(QFileInfo(videoPath).fileName())
+        .arg(static_cast<int>(fraction * 100)));
+}
+
+void MainWindow::onProxyReady(const QString& videoPath, const QString& proxyPath) {
+    Q_UNUSED(proxyPath);
+    m_proxyStatusLabel->clear();
+    statusBar()->showMessage(QString("Proxy ready: %1").arg(QFileInfo(videoPath).fileName()), 3000);
+    
+    // Switch over without losing the place
+    if (videoPath == m_videoPath && !m_viewOriginal && !m_replayPlayer->isPlaying()) {
+        keepVisibleArea();
+        reopenCurrentVideo(false);
+    }
+}
+
+void MainWindow::onProxyFailed(const QString& videoPath, const QString& reason) {
+    m_proxyStatusLabel->clear();
+    statusBar()->showMessage(QString("No proxy for %1: %2").arg(QFileInfo(videoPath).fileName(), reason), 5000);
+}
+
+bool MainWindow::beginReplay() {
+    if (!m_worker) return false;
+    
+    // Hold playback where it is; it resumes from the same frame afterwards
+    if (!m_replayPlayer->isPlaying()) {
+        m_resumeAfterReplay = m_playButton->text() == "⏸";
+        m_worker->setPaused(true);
+        m_playButton->setText("▶");
+    }
+    return true;
+}
+
+void MainWindow::instantReplay() {
+    if (!beginReplay()) return;
+    
+    if (!m_replayPlayer->playLast(m_replayBuffer->seconds())) {
+        statusBar()->showMessage("Nothing to replay yet", 3000);
+        onReplayFinished();
+        return;
+    }
+    statusBar()->showMessage(QString("Replaying the last %1 s").arg(m_replayBuffer->seconds(), 0, 'f', 0));
+}
+
+void MainWindow::setLoopStart() {
+    m_loopStart = m_replayPlayer->isPlaying() ? m_replayPlayer->currentSerial() : m_shownSerial;
+    if (m_loopStart > 0) {
+        statusBar()->showMessage("Loop start (A) set; press ] at the end point", 3000);
+    }
+}
+
+void MainWindow::setLoopEnd() {
+    if (m_loopStart == 0) {
+        statusBar()->showMessage("Set the loop start (A) first with [", 3000);
+        return;
+    }
+    quint64 loopEnd = m_replayPlayer->isPlaying() ? m_replayPlayer->currentSerial() : m_shownSerial;
+    if (!beginReplay()) return;
+    
+    if (!m_replayPlayer->playLoop(m_loopStart, loopEnd)) {
+        statusBar()->showMessage(QString("The loop is no longer in memory (last %1 s are kept)")
+            .arg(m_replayBuffer->seconds(), 0, 'f', 0), 3000);
+        onReplayFinished();
+        return;
+    }
+    statusBar()->showMessage("Looping A-B; press Esc to return to playback");
+}
+
+void MainWindow::stopReplay() {
+    m_replayPlayer->stop();
+}
+
+void MainWindow::onReplayFinished() {
+    statusBar()->clearMessage();
+    
+    // Back to the playback frame, and to playing if it was
+    if (!m_lastFrame.image.isNull()) {
+        m_frameItem->setFrame(m_lastFrame);
+    }
+    if (m_resumeAfterReplay && m_worker) {
+        m_worker->setPaused(false);
+        m_playButton->setText("⏸");
+    }
+    m_resumeAfterReplay = false;
+}
+
 void MainWindow::onBehaviorDoubleClicked(QTreeWidgetItem* item, int column) {
     Q_UNUSED(column);
     
@@ -524,6 +1077,8 @@ void MainWindow::onBehaviorDoubleClicked(QTreeWidgetItem* item, int column) {
 }
 
 void MainWindow::toggleBehavior(const QString& parentCategory, const QString& behavior, const QString& type) {
+    if (m_recordsJob) return; // The records are being saved
+    
     // Get current values from controls
     QString role = m_roleCombo->currentText();
     QString groupType = m_groupTypeCombo->currentText();
@@ -539,6 +1094,12 @@ void MainWindow::toggleBehavior(const QString& parentCategory, const QString& be
     std::optional<int> calves = m_calvesSpin->value() > 0 ? 
         std::optional<int>(m_calvesSpin->value()) : std::nullopt;
     
+    // Stamp with the frame that was on screen when the click or key press
+    // arrived, not with the decoder's position
+    double shownPts = m_frameItem->shownPts();
+    std::optional<int> shownFrame = m_frameItem->shownFrame() >= 0 ?
+        std::optional<int>(m_frameItem->shownFrame()) : std::nullopt;
+    
     if (type == "EVENT") {
         // Instant recording
         BehaviorRecord record;
@@ -546,7 +1107,8 @@ void MainWindow::toggleBehavior(const QString& parentCategory, const QString& be
         record.role = role;
         record.behaviour = behavior;
         record.parentBehaviour = parentCategory;
-        record.startTime = m_currentPosition;
+        record.startTime = shownPts;
+        record.startFrame = shownFrame;
         record.duration = 0.0;
         record.recordType = "EVENT";
         record.tag = tag;
@@ -558,33 +1120,20 @@ void MainWindow::toggleBehavior(const QString& parentCategory, const QString& be
         record.motherAndCalf = motherCalves;
         record.calves = calves;
         
-        m_records.append(record);
-        updateRecordsDisplay();
+        m_recordsModel->append(record);
+        m_journal.appendRecord(record);
+        m_project.appendUnsaved(m_videoPath, record);
+        m_projectRefreshTimer->start();
         
     } else if (type == "STATE") {
         if (!m_stateActive) {
             // Start state
-            m_stateActive = true;
-            m_currentStateBehavior = behavior;
-            m_currentStateParent = parentCategory;
-            m_stateStartTime = m_currentPosition;
-            
-            m_stateFeedbackLabel->setText(QString("🔄 Active: %1").arg(behavior));
-            
-            // Disable other behaviors in tree
-            for (int i = 0; i < m_behaviorTree->topLevelItemCount(); ++i) {
-                QTreeWidgetItem* category = m_behaviorTree->topLevelItem(i);
-                for (int j = 0; j < category->childCount(); ++j) {
-                    QTreeWidgetItem* child = category->child(j);
-                    if (child->text(0) != behavior) {
-                        child->setDisabled(true);
-                    }
-                }
-            }
+            showActiveState(parentCategory, behavior, shownPts, shownFrame);
+            m_journal.beginState({parentCategory, behavior, shownPts, shownFrame});
             
         } else {
             // End state
-            double endTime = m_currentPosition;
+            double endTime = shownPts;
             double duration = endTime - m_stateStartTime;
             
             BehaviorRecord record;
@@ -594,6 +1143,8 @@ void MainWindow::toggleBehavior(const QString& parentCategory, const QString& be
             record.parentBehaviour = m_currentStateParent;
             record.startTime = m_stateStartTime;
             record.endTime = endTime;
+            record.startFrame = m_stateStartFrame;
+            record.endFrame = shownFrame;
             record.duration = duration;
             record.recordType = "STATE";
             record.tag = tag;
@@ -605,19 +1156,45 @@ void MainWindow::toggleBehavior(const QString& parentCategory, const QString& be
             record.motherAndCalf = motherCalves;
             record.calves = calves;
             
-            m_records.append(record);
-            updateRecordsDisplay();
+            m_recordsModel->append(record);
+            m_journal.appendRecord(record);
+            m_journal.endState();
+            m_project.appendUnsaved(m_videoPath, record);
+            m_projectRefreshTimer->start();
             
             clearActiveState();
         }
     }
 }
 
+void MainWindow::showActiveState(const QString& parentCategory, const QString& behavior,
+                                 double startTime, std::optional<int> startFrame) {
+    m_stateActive = true;
+    m_currentStateBehavior = behavior;
+    m_currentStateParent = parentCategory;
+    m_stateStartTime = startTime;
+    m_stateStartFrame = startFrame;
+    
+    m_stateFeedbackLabel->setText(QString("🔄 Active: %1").arg(behavior));
+    
+    // Disable other behaviors in tree
+    for (int i = 0; i < m_behaviorTree->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* category = m_behaviorTree->topLevelItem(i);
+        for (int j = 0; j < category->childCount(); ++j) {
+            QTreeWidgetItem* child = category->child(j);
+            if (child->text(0) != behavior) {
+                child->setDisabled(true);
+            }
+        }
+    }
+}
+
 void MainWindow::clearActiveState() {
     m_stateActive = false;
     m_currentStateBehavior.clear();
     m_currentStateParent.clear();
     m_stateStartTime = 0.0;
+    m_stateStartFrame.reset();
     m_stateFeedbackLabel->clear();
     
     // Re-enable all behaviors
@@ -629,54 +1206,121 @@ void MainWindow::clearActiveState() {
     }
 }
 
-void MainWindow::updateRecordsDisplay() {
-    m_recordsTable->setRowCount(m_records.size());
+void MainWindow::deleteRecord(int row) {
+    if (m_recordsJob) return;
+    if (row < 0 || row >= m_recordsModel->rowCount()) return;
+    const int index = m_recordsModel->recordIndex(row);
+    m_journal.deleteRecord(index);
+    m_project.deleteUnsaved(m_videoPath, index);
+    m_recordsModel->removeRow(row);
+    m_projectRefreshTimer->start();
+}
+
+void MainWindow::applyRecordsFilter() {
+    RecordsModel::Filter filter;
+    if (m_recordsBehaviorFilter->currentIndex() > 0) {
+        filter.behavior = m_recordsBehaviorFilter->currentText();
+    }
+    filter.tag = m_recordsTagFilter->text();
+    parseTimeRange(m_recordsTimeFilter->text(), filter.from, filter.to);
     
-    for (int i = 0; i < m_records.size(); ++i) {
-        const BehaviorRecord& r = m_records[i];
-        
-        // Time column
-        QString timeStr = r.startTimeStr();
-        if (r.endTime.has_value()) {
-            timeStr += " - " + r.endTimeStr();
-        }
-        QTableWidgetItem* timeItem = new QTableWidgetItem(timeStr);
-        timeItem->setFlags(timeItem->flags() & ~Qt::ItemIsEditable);
-        m_recordsTable->setItem(i, 0, timeItem);
-        
-        // Behavior column
-        QString behaviorStr = r.parentBehaviour + " / " + r.behaviour;
-        QTableWidgetItem* behaviorItem = new QTableWidgetItem(behaviorStr);
-        behaviorItem->setFlags(behaviorItem->flags() & ~Qt::ItemIsEditable);
-        behaviorItem->setToolTip(r.asDisplayString());
-        m_recordsTable->setItem(i, 1, behaviorItem);
-        
-        // Type column
-        QTableWidgetItem* typeItem = new QTableWidgetItem(r.recordType);
-        typeItem->setFlags(typeItem->flags() & ~Qt::ItemIsEditable);
-        m_recordsTable->setItem(i, 2, typeItem);
-        
-        // Delete button
-        QPushButton* deleteBtn = new QPushButton("✕");
-        deleteBtn->setObjectName("deleteButton");
-        deleteBtn->setFixedSize(28, 28);
-        deleteBtn->setToolTip("Delete record");
-        connect(deleteBtn, &QPushButton::clicked, this, [this, i]() {
-            deleteRecord(i);
-        });
-        m_recordsTable->setCellWidget(i, 3, deleteBtn);
+    m_recordsModel->setFilter(filter);
+}
+
+void MainWindow::updateBehaviorFilter() {
+    // Keep the chosen behavior while it still has records
+    const QString current = m_recordsBehaviorFilter->currentIndex() > 0 ?
+        m_recordsBehaviorFilter->currentText() : QString();
+    const QStringList behaviors = m_recordsModel->behaviors();
+    
+    QSignalBlocker blocker(m_recordsBehaviorFilter);
+    m_recordsBehaviorFilter->clear();
+    m_recordsBehaviorFilter->addItem("All behaviors");
+    m_recordsBehaviorFilter->addItems(behaviors);
+    const int index = behaviors.indexOf(current);
+    m_recordsBehaviorFilter->setCurrentIndex(index + 1);
+    
+    if (!current.isEmpty() && index < 0) applyRecordsFilter();
+}
+
+void MainWindow::applyProjectQuery() {
+    if (!m_project.isOpen()) {
+        m_projectModel->clear();
+        m_projectSummaryLabel->setText("Open a video directory to search the records of all its videos");
+        return;
+    }
+    
+    ProjectDatabase::Filter filter;
+    if (m_projectVideoFilter->currentIndex() > 0) {
+        filter.video = m_projectVideoFilter->currentText();
+    }
+    if (m_projectBehaviorFilter->currentIndex() > 0) {
+        filter.behaviour = m_projectBehaviorFilter->currentText();
+    }
+    if (m_projectCategoryFilter->currentIndex() > 0) {
+        filter.parentBehaviour = m_projectCategoryFilter->currentText();
     }
+    filter.tag = m_projectTagFilter->text().trimmed();
+    parseTimeRange(m_projectTimeFilter->text(), filter.from, filter.to);
+    
+    QElapsedTimer timer;
+    timer.start();
+    const ProjectDatabase::Summary summary = m_project.summarize(filter);
+    m_projectModel->setQuery(m_project.select(filter));
+    m_projectSummaryLabel->setText(QString("%1 records, %2 in total (%3 ms)")
+        .arg(summary.count)
+        .arg(BehaviorRecord::formatTime(summary.totalDuration))
+        .arg(timer.elapsed()));
 }
 
-void MainWindow::deleteRecord(int index) {
-    if (index >= 0 && index < m_records.size()) {
-        m_records.removeAt(index);
-        updateRecordsDisplay();
+void MainWindow::openProject(const QString& directory) {
+    m_projectModel->clear(); // Its query runs on the previous project's connection
+    m_project.close();
+    if (!directory.isEmpty() && !m_project.open(directory)) {
+        statusBar()->showMessage("The records of this directory cannot be indexed", 5000);
     }
 }
 
+void MainWindow::syncProject() {
+    if (!m_project.isOpen() || m_recordsJob) return;
+    
+    // New and changed CSV files are read on the job's own connection
+    RecordsJob::Work work = [path = m_project.path(), directory = m_project.directory(),
+                             vocabulary = Config::instance().recordVocabulary()](const CsvExporter::Progress& progress) {
+        return ProjectDatabase::sync(path, directory, vocabulary, progress);
+    };
+    runRecordsJob("Indexing the directory's records...", std::move(work), [this](bool synced, bool cancelled) {
+        if (!synced && !cancelled) {
+            statusBar()->showMessage("Some CSV files could not be indexed", 5000);
+        }
+        refreshProject();
+    });
+}
+
+void MainWindow::updateProjectVideos() {
+    // Keep the chosen video while it still has records
+    const QString current = m_projectVideoFilter->currentIndex() > 0 ?
+        m_projectVideoFilter->currentText() : QString();
+    const QStringList videos = m_project.isOpen() ? m_project.videos() : QStringList();
+    
+    QSignalBlocker blocker(m_projectVideoFilter);
+    m_projectVideoFilter->clear();
+    m_projectVideoFilter->addItem("All videos");
+    m_projectVideoFilter->addItems(videos);
+    m_projectVideoFilter->setCurrentIndex(videos.indexOf(current) + 1);
+}
+
+void MainWindow::refreshProject() {
+    m_projectRefreshTimer->stop();
+    // A hidden panel catches up when it is shown
+    if (!m_projectDock->isVisible()) return;
+    updateProjectVideos();
+    applyProjectQuery();
+}
+
 void MainWindow::saveRecords() {
-    if (m_records.isEmpty()) {
+    if (m_recordsJob) return;
+    if (m_recordsModel->isEmpty()) {
         QMessageBox::information(this, "No Records", "There are no records to save.");
         return;
     }
@@ -689,17 +1333,130 @@ void MainWindow::saveRecords() {
         suggestedPath = QDir::homePath() + "/behavior_records.csv";
     }
     
+    const QString arrowFilter = "Arrow / Feather Files (*.arrow *.feather)";
+    QString selectedFilter;
     QString filePath = QFileDialog::getSaveFileName(this, "Save Records", 
-        suggestedPath, "CSV Files (*.csv)");
+        suggestedPath, "CSV Files (*.csv);;" + arrowFilter, &selectedFilter);
     
     if (filePath.isEmpty()) return;
+    if (selectedFilter == arrowFilter && !ArrowExporter::isArrowFile(filePath)) {
+        filePath = QFileInfo(filePath).dir().filePath(QFileInfo(filePath).completeBaseName() + ".arrow");
+    }
     
-    if (CsvExporter::exportRecords(filePath, m_records)) {
-        QMessageBox::information(this, "Saved", 
-            QString("Saved %1 records to:\n%2").arg(m_records.size()).arg(filePath));
-        m_records.clear();
-        updateRecordsDisplay();
+    // CSV is streamed from the journal, which then starts over; Arrow, and
+    // CSV when the video's labels could not be journaled, straight from
+    // memory. The file is written on a background thread while labeling is
+    // held back.
+    const RecordStore& records = m_recordsModel->records();
+    const int count = records.size();
+    RecordsJob::Work work;
+    if (ArrowExporter::isArrowFile(filePath)) {
+        work = [&records, filePath](const CsvExporter::Progress& progress) {
+            return ArrowExporter::exportRecords(filePath, records, progress);
+        };
+    } else if (m_journal.isOpen()) {
+        work = [snapshot = m_journal.snapshot(), filePath](const CsvExporter::Progress& progress) {
+            return SessionJournal::exportCsv(snapshot, filePath, progress);
+        };
     } else {
-        QMessageBox::critical(this, "Error", "Failed to save records.");
+        work = [&records, filePath](const CsvExporter::Progress& progress) {
+            return CsvExporter::exportRecords(filePath, records, progress);
+        };
     }
+    
+    runRecordsJob("Saving records...", std::move(work), [this, count, filePath](bool saved, bool cancelled) {
+        if (saved) {
+            m_journal.clearRecords();
+            m_recordsModel->clear();
+            // The saved file takes over the unsaved labels, CSV and Arrow
+            // alike; saved outside the project, they are no longer part of it
+            if (!m_project.saveUnsaved(m_videoPath, filePath)) {
+                m_project.setUnsaved(m_videoPath, {});
+            }
+            refreshProject();
+            QMessageBox::information(this, "Saved", 
+                QString("Saved %1 records to:\n%2").arg(count).arg(filePath));
+        } else if (cancelled) {
+            statusBar()->showMessage("Save cancelled", 3000);
+        } else {
+            QMessageBox::critical(this, "Error", "Failed to save records.");
+        }
+    });
+}
+
+void MainWindow::importRecords() {
+    if (m_recordsJob) return;
+    
+    const QStringList paths = QFileDialog::getOpenFileNames(this, "Import Records", 
+        m_videoDir.isEmpty() ? QDir::homePath() : m_videoDir, "CSV Files (*.csv)");
+    if (paths.isEmpty()) return;
+    
+    // Parsed, journaled (so they are saved with the current records) and
+    // added to the project index in the background, then added to the
+    // records on screen. Labeling waits for the job, so nothing else touches
+    // the journal meanwhile; the index is written on the job's own connection.
+    const RecordStore::Vocabulary vocabulary = Config::instance().recordVocabulary();
+    auto result = std::make_shared<CsvImporter::Result>(vocabulary);
+    SessionJournal* journal = &m_journal;
+    RecordsJob::Work work = [result, paths, vocabulary, journal, projectPath = m_project.path(),
+                             videoPath = m_videoPath](const CsvExporter::Progress& progress) {
+        *result = CsvImporter(vocabulary).importFiles(paths, progress);
+        if (result->cancelled) return false;
+        // Not cancelled past this point: the journal must match the records
+        journal->appendRecords(result->records);
+        if (!projectPath.isEmpty()) ProjectDatabase::appendUnsaved(projectPath, videoPath, result->records);
+        return true;
+    };
+    
+    runRecordsJob("Importing records...", std::move(work), [this, result, paths](bool imported, bool) {
+        if (!imported) {
+            statusBar()->showMessage("Import cancelled", 3000);
+            return;
+        }
+        m_recordsModel->append(result->records);
+        refreshProject();
+        
+        QString summary = QString("Imported %1 records from %2 files.")
+            .arg(result->records.size()).arg(paths.size());
+        if (result->issueCount == 0) {
+            QMessageBox::information(this, "Imported", summary);
+            return;
+        }
+        summary += QString("\n%1 problems found; %2 rows skipped.")
+            .arg(result->issueCount).arg(result->skippedRows);
+        QStringList details;
+        for (const CsvImporter::Issue& issue : result->issues) {
+            QString where = QFileInfo(issue.file).fileName();
+            if (issue.line > 0) where += QString(":%1").arg(issue.line);
+            if (issue.column > 0) where += QString(":%1").arg(issue.column);
+            details << QString("%1: %2%3").arg(where, issue.message, issue.skipped ? " (skipped)" : "");
+        }
+        if (result->issueCount > static_cast<qint64>(result->issues.size())) {
+            details << QString("... and %1 more").arg(result->issueCount - static_cast<qint64>(result->issues.size()));
+        }
+        QMessageBox box(QMessageBox::Warning, "Imported", summary, QMessageBox::Ok, this);
+        box.setDetailedText(details.join('\n'));
+        box.exec();
+    });
+}
+
+void MainWindow::runRecordsJob(const QString& label, RecordsJob::Work work,
+                               const std::function<void(bool ok, bool cancelled)>& done) {
+    QProgressDialog* dialog = new QProgressDialog(label, "Cancel", 0, 100, this);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    dialog->setMinimumDuration(0);
+    dialog->setValue(0);
+    
+    m_recordsJob = new RecordsJob(std::move(work), this);
+    connect(m_recordsJob, &RecordsJob::progress, dialog, &QProgressDialog::setValue);
+    connect(dialog, &QProgressDialog::canceled, m_recordsJob, &RecordsJob::cancel);
+    connect(m_recordsJob, &RecordsJob::finished, this, [this, dialog, done](bool ok, bool cancelled) {
+        m_recordsJob->deleteLater();
+        m_recordsJob = nullptr;
+        dialog->deleteLater();
+        done(ok, cancelled);
+    });
+    m_recordsJob->start();
 }
@@ -3,7 +3,6 @@
 #include <QMainWindow>
 #include <QGraphicsView>
 #include <QGraphicsScene>
-#include <QGraphicsPixmapItem>
 #include <QThread>
 #include <QPushButton>
 #include <QSlider>
@@ -16,11 +15,24 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QSpinBox>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
+#include <QPointer>
 
+#include "FrameItem.hpp"
+#include "PlaybackEngine.hpp"
+#include "ProjectDatabase.hpp"
+#include "ProxyGenerator.hpp"
+#include "RecordsJob.hpp"
+#include "RecordsModel.hpp"
+#include "ReplayBuffer.hpp"
+#include "ReplayPlayer.hpp"
+#include "SessionJournal.hpp"
 #include "VideoWorker.hpp"
 #include "BehaviorRecord.hpp"
 
+class QSqlQueryModel;
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -30,9 +42,12 @@ public:
 
 public slots:
     // Received from Worker
-    void updateFrame(const QImage& frame);
+    void pullFrame(); // Display tick: show the latest presented frame, if new
     void onVideoOpened(double duration, double fps, int width, int height);
+    void onDurationChanged(double duration);
     void onPositionChanged(double pos);
+    void onPlaybackStats(const PlaybackStats& stats);
+    void onVideoSwitched(const QString& path, double timeToFirstFrameMs);
     void onVideoError(const QString& message);
     
     // User Actions
@@ -43,12 +58,33 @@ public slots:
     void onSliderReleased();
     void onSliderMoved(int value);
     void onSpeedChanged(int index);
+    void stepForward();
+    void stepBackward();
+    void setDecoderBackend(const QString& backend);
+    
+    // Proxies: playback switches to a proxy once it is ready; the original
+    // can be shown at full resolution for detail checks
+    void setViewOriginal(bool original);
+    void onProxyProgress(const QString& videoPath, double fraction);
+    void onProxyReady(const QString& videoPath, const QString& proxyPath);
+    void onProxyFailed(const QString& videoPath, const QString& reason);
+    
+    // Replays from memory; the main playback position is left alone
+    void instantReplay();
+    void setLoopStart();
+    void setLoopEnd();
+    void stopReplay();
+    void onReplayFinished();
     
     // Behavior recording
     void onBehaviorDoubleClicked(QTreeWidgetItem* item, int column);
     void toggleBehavior(const QString& parentCategory, const QString& behavior, const QString& type);
-    void deleteRecord(int index);
+    void deleteRecord(int row);
+    void applyRecordsFilter();
+    void updateBehaviorFilter();
+    void applyProjectQuery();
     void saveRecords();
+    void importRecords();
 
 protected:
     bool eventFilter(QObject* obj, QEvent* event) override;
@@ -59,30 +95,56 @@ private:
     void setupBehaviorTree();
     void setupControlsDock();
     void setupRecordsDock();
+    void setupProjectDock();
+    void loadVideo(const QString& path); // Restores its unsaved labels
+    // Project database of the video directory: opened before its first
+    // video loads, then synced with the CSV files in the background
+    void openProject(const QString& directory);
+    void syncProject();
+    void updateProjectVideos();
+    void refreshProject(); // After the records changed, if the panel is shown
+    // Save or import in the background behind a progress dialog
+    void runRecordsJob(const QString& label, RecordsJob::Work work,
+                       const std::function<void(bool ok, bool cancelled)>& done);
     void startWorker(const QString& path);
+    void reopenCurrentVideo(bool restartWorkers);
+    QString playbackPath(const QString& videoPath) const; // Proxy if there is one and it is wanted
+    void queueProxies();
+    void keepVisibleArea(); // Restored by the next onVideoOpened()
     void loadNextVideo();
     void loadPrevVideo();
-    void updateRecordsDisplay();
+    void showActiveState(const QString& parentCategory, const QString& behavior,
+                         double startTime, std::optional<int> startFrame);
     void clearActiveState();
+    void reportViewport();
+    bool beginReplay();
     
     double currentPosition() const { return m_currentPosition; }
 
     // UI Elements - Main
     QGraphicsView* m_view;
     QGraphicsScene* m_scene;
-    QGraphicsPixmapItem* m_pixmapItem;
+    FrameItem* m_frameItem;
     
     QPushButton* m_playButton;
+    QPushButton* m_stepBackButton;
+    QPushButton* m_stepForwardButton;
     QSlider* m_seekSlider;
     QLabel* m_timeLabel;
     QComboBox* m_speedCombo;
     QPushButton* m_prevButton;
     QPushButton* m_nextButton;
+    QLabel* m_playbackStatsLabel;
+    QLabel* m_proxyStatusLabel;
+    QAction* m_viewOriginalAction;
+    QTimer* m_viewportTimer; // Coalesces zoom/pan/resize reports to the worker
+    QTimer* m_frameTimer;    // Display tick that pulls frames from the engine
     
     // Dock Widgets
     QDockWidget* m_behaviorDock;
     QDockWidget* m_controlsDock;
     QDockWidget* m_recordsDock;
+    QDockWidget* m_projectDock;
     
     // Behavior Tree
     QTreeWidget* m_behaviorTree;
@@ -100,27 +162,60 @@ private:
     QLabel* m_stateFeedbackLabel;
     
     // Records
-    QTableWidget* m_recordsTable;
+    RecordsModel* m_recordsModel;
+    QTableView* m_recordsView;
+    QComboBox* m_recordsBehaviorFilter;
+    QLineEdit* m_recordsTagFilter;
+    QLineEdit* m_recordsTimeFilter;
     QPushButton* m_saveButton;
     
+    // Project: records of every video in the directory
+    QComboBox* m_projectVideoFilter;
+    QComboBox* m_projectBehaviorFilter;
+    QComboBox* m_projectCategoryFilter;
+    QLineEdit* m_projectTagFilter;
+    QLineEdit* m_projectTimeFilter;
+    QLabel* m_projectSummaryLabel;
+    QTableView* m_projectView;
+    QSqlQueryModel* m_projectModel;
+    QTimer* m_projectRefreshTimer; // Coalesces refreshes while labeling
+    
     // Threading
-    QThread* m_workerThread;
-    VideoWorker* m_worker;
+    PlaybackEngine* m_engine;
+    VideoWorker* m_worker; // Active worker, owned by m_engine
     
     // Video state
     bool m_isSliderPressed;
     double m_duration;
     double m_currentPosition;
+    double m_scrubTarget; // Last position sought while dragging the slider
+    
+    // Instant replay and A-B loop
+    std::shared_ptr<ReplayBuffer> m_replayBuffer;
+    ReplayPlayer* m_replayPlayer;
+    VideoFrame m_lastFrame;    // Last frame from playback, shown again after a replay
+    quint64 m_shownSerial;     // Replay serial of m_lastFrame
+    quint64 m_loopStart;       // Serial of point A (0 = not set)
+    bool m_resumeAfterReplay;
+    
+    // Proxy transcoding
+    ProxyGenerator* m_proxies;
+    bool m_viewOriginal;
+    QRectF m_pendingView; // Visible part of the frame (0..1) to restore after a switch
     
     // Video directory navigation
+    QString m_videoPath; // Original file of the current video (playback may use its proxy)
     QString m_videoDir;
     QStringList m_videoFiles;
     int m_currentVideoIndex;
     
     // Behavior recording state
-    QVector<BehaviorRecord> m_records;
     QString m_currentStateBehavior;
     QString m_currentStateParent;
     double m_stateStartTime;
+    std::optional<int> m_stateStartFrame;
     bool m_stateActive;
+    SessionJournal m_journal; // Unsaved labels of the current video, on disk
+    ProjectDatabase m_project; // Index of the video directory's records, mirrors the journal
+    QPointer<RecordsJob> m_recordsJob; // Save or import in progress; labeling waits for it
 };
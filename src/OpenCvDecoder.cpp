@@ -0,0 +1,78 @@
+#include "OpenCvDecoder.hpp"
+
+OpenCvDecoder::OpenCvDecoder(const Options& options)
+    : m_options(options)
+    , m_framePts(0.0)
+    , m_grabbed(false)
+{
+}
+
+bool OpenCvDecoder::open(const QString& path) {
+    // The capture picks its own thread count; m_options.threads is not exposed
+    m_grabbed = false;
+    return m_cap.open(path.toStdString());
+}
+
+void OpenCvDecoder::close() {
+    m_cap.release();
+    m_mat.release();
+    m_grabbed = false;
+}
+
+double OpenCvDecoder::fps() const {
+    return m_cap.get(cv::CAP_PROP_FPS);
+}
+
+double OpenCvDecoder::duration() const {
+    double fps = m_cap.get(cv::CAP_PROP_FPS);
+    if (fps <= 0) return 0.0;
+    return m_cap.get(cv::CAP_PROP_FRAME_COUNT) / fps;
+}
+
+QSize OpenCvDecoder::frameSize() const {
+    return QSize(static_cast<int>(m_cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+                 static_cast<int>(m_cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+bool OpenCvDecoder::seek(double seconds) {
+    m_grabbed = false;
+    return m_cap.set(cv::CAP_PROP_POS_MSEC, seconds * 1000.0);
+}
+
+bool OpenCvDecoder::grab() {
+    m_grabbed = m_cap.grab();
+    if (m_grabbed) {
+        m_framePts = m_cap.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
+    }
+    return m_grabbed;
+}
+
+VideoDecoder::Transfer OpenCvDecoder::retrieve(FramePool& pool, QImage& out, const DecodeRegion& region) {
+    if (!m_grabbed || !m_cap.retrieve(m_mat) || m_mat.empty()) {
+        return Transfer::Failed;
+    }
+    m_grabbed = false;
+    
+    // Crop, then shrink while still 3 channels, so the conversion below
+    // only touches the pixels that end up on screen
+    const QSize frameSize(m_mat.cols, m_mat.rows);
+    const QRect source = region.sourceRect(frameSize);
+    const QSize size = region.outputSize(frameSize);
+    cv::Mat input = m_mat(cv::Rect(source.x(), source.y(), source.width(), source.height()));
+    if (size != source.size()) {
+        cv::resize(input, m_scaled, cv::Size(size.width(), size.height()), 0, 0, cv::INTER_AREA);
+        input = m_scaled;
+    }
+    
+    // Convert straight into a pooled, display-native buffer.
+    // Format_RGB32 is BGRA in memory on little-endian hosts.
+    out = pool.acquire(size.width(), size.height(), QImage::Format_RGB32);
+    cv::Mat target(size.height(), size.width(), CV_8UC4, out.bits(), static_cast<size_t>(out.bytesPerLine()));
+    if (input.channels() == 4) {
+        input.copyTo(target);
+        return Transfer::Copied;
+    }
+    int code = input.channels() == 1 ? cv::COLOR_GRAY2BGRA : cv::COLOR_BGR2BGRA;
+    cv::cvtColor(input, target, code);
+    return Transfer::Converted;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "VideoDecoder.hpp"
+
+#include <opencv2/opencv.hpp>
+
+// Decoder backed by cv::VideoCapture. Portable, but hides threading, the
+// output pixel format and packet timestamps (PTS comes from POS_MSEC).
+class OpenCvDecoder : public VideoDecoder {
+public:
+    explicit OpenCvDecoder(const Options& options = {});
+
+    QString name() const override { return "opencv"; }
+    bool open(const QString& path) override;
+    void close() override;
+    bool isOpened() const override { return m_cap.isOpened(); }
+
+    double fps() const override;
+    double duration() const override;
+    QSize frameSize() const override;
+
+    bool seek(double seconds) override;
+    bool grab() override;
+    double framePts() const override { return m_framePts; }
+    Transfer retrieve(FramePool& pool, QImage& out, const DecodeRegion& region = {}) override;
+
+private:
+    Options m_options;
+    cv::VideoCapture m_cap;
+    cv::Mat m_mat;
+    cv::Mat m_scaled;
+    double m_framePts;
+    bool m_grabbed;
+};
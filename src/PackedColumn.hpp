@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// Column of unsigned integers stored at the narrowest width that holds every
+// value so far: one byte each until a value needs more, then two, then four.
+// Widening rewrites the column once and never goes back, so a dictionary
+// code column costs one byte per record for a closed vocabulary and grows
+// only when a free-text field such as tags has more distinct values.
+//
+// Scans go through visit(), which hands the loop the raw array at its actual
+// width; operator[] is for random access.
+class PackedColumn {
+public:
+    int size() const {
+        return static_cast<int>(std::visit([](const auto& v) { return v.size(); }, m_values));
+    }
+    bool empty() const { return size() == 0; }
+    int width() const { return 1 << static_cast<int>(m_values.index()); } // Bytes per value
+
+    uint32_t operator[](int index) const {
+        switch (m_values.index()) {
+        case 0: return (*std::get_if<0>(&m_values))[index];
+        case 1: return (*std::get_if<1>(&m_values))[index];
+        default: return (*std::get_if<2>(&m_values))[index];
+        }
+    }
+
+    // f(const T* values, int count) with T the column's current width
+    template <typename F>
+    decltype(auto) visit(F&& f) const {
+        return std::visit([&f](const auto& v) -> decltype(auto) {
+            return f(v.data(), static_cast<int>(v.size()));
+        }, m_values);
+    }
+
+    void push_back(uint32_t value) {
+        fit(widthFor(value));
+        std::visit([value](auto& v) {
+            using T = typename std::decay_t<decltype(v)>::value_type;
+            v.push_back(static_cast<T>(value));
+        }, m_values);
+    }
+
+    // Values of another column, each mapped through map (e.g. a code
+    // translation table); identity when map is null
+    void append(const PackedColumn& other, const std::vector<uint32_t>* map = nullptr) {
+        if (other.empty()) return;
+        if (map) {
+            if (!map->empty()) fit(widthFor(*std::max_element(map->begin(), map->end())));
+        } else {
+            fit(other.width());
+        }
+        std::visit([&other, map](auto& v) {
+            using T = typename std::decay_t<decltype(v)>::value_type;
+            v.reserve(v.size() + other.size());
+            other.visit([&v, map](const auto* values, int count) {
+                for (int i = 0; i < count; ++i) {
+                    v.push_back(static_cast<T>(map ? (*map)[values[i]] : values[i]));
+                }
+            });
+        }, m_values);
+    }
+
+    void erase(int index) {
+        std::visit([index](auto& v) { v.erase(v.begin() + index); }, m_values);
+    }
+
+    // Back to one byte per value; the capacity is kept when it already is
+    void clear() {
+        if (m_values.index() == 0) {
+            std::get_if<0>(&m_values)->clear();
+        } else {
+            m_values = std::vector<uint8_t>();
+        }
+    }
+
+    void reserve(int count) {
+        std::visit([count](auto& v) { v.reserve(static_cast<size_t>(count)); }, m_values);
+    }
+
+    size_t capacityBytes() const {
+        return std::visit([](const auto& v) { return v.capacity() * sizeof(v[0]); }, m_values);
+    }
+
+private:
+    static int widthFor(uint32_t value) {
+        return value <= 0xFF ? 1 : (value <= 0xFFFF ? 2 : 4);
+    }
+
+    void fit(int bytes) {
+        if (bytes <= width()) return;
+        auto widen = [this](auto wider) {
+            std::visit([&wider](const auto& v) {
+                wider.reserve(v.capacity());
+                wider.assign(v.begin(), v.end());
+            }, m_values);
+            m_values = std::move(wider);
+        };
+        if (bytes == 2) {
+            widen(std::vector<uint16_t>());
+        } else {
+            widen(std::vector<uint32_t>());
+        }
+    }
+
+    std::variant<std::vector<uint8_t>, std::vector<uint16_t>, std::vector<uint32_t>> m_values;
+};
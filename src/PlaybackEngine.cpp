@@ -0,0 +1,189 @@
+#include "PlaybackEngine.hpp"
+
+#include <QThread>
+
+PlaybackEngine::PlaybackEngine(QObject* parent)
+    : QObject(parent)
+    , m_active(nullptr)
+    , m_awaitingFirstFrame(false)
+{
+}
+
+PlaybackEngine::~PlaybackEngine() {
+    // Clean shutdown of all threads, including ones still winding down
+    for (Slot* slot : m_slots) {
+        slot->worker->stop();
+    }
+    for (Slot* slot : m_slots) {
+        slot->thread->quit();
+        slot->thread->wait();
+        delete slot->worker;
+        delete slot->thread;
+        delete slot;
+    }
+    for (const QPointer<QThread>& thread : m_retiring) {
+        if (thread) {
+            thread->wait();
+        }
+    }
+}
+
+void PlaybackEngine::open(const QString& path) {
+    m_switchTimer.start();
+    m_awaitingFirstFrame = true;
+    
+    Slot* slot = findSlot(path);
+    
+    // The previous video stays primed from its start, e.g. for ⏮ right after ⏭
+    if (m_active && m_active != slot) {
+        m_active->worker->setActive(false);
+        m_active->worker->setPaused(false);
+        m_active->worker->seek(0.0);
+    }
+    
+    if (slot) {
+        activate(*slot);
+    } else {
+        m_active = startSlot(path, true);
+    }
+}
+
+void PlaybackEngine::setPrefetch(const QStringList& paths) {
+    for (const QString& path : paths) {
+        if (!findSlot(path)) {
+            startSlot(path, false);
+        }
+    }
+    
+    const QVector<Slot*> slots = m_slots;
+    for (Slot* slot : slots) {
+        if (slot != m_active && !paths.contains(slot->path)) {
+            retire(*slot);
+        }
+    }
+}
+
+void PlaybackEngine::closeAll() {
+    const QVector<Slot*> slots = m_slots;
+    for (Slot* slot : slots) {
+        retire(*slot);
+    }
+}
+
+VideoWorker* PlaybackEngine::activeWorker() const {
+    return m_active ? m_active->worker : nullptr;
+}
+
+QString PlaybackEngine::activePath() const {
+    return m_active ? m_active->path : QString();
+}
+
+bool PlaybackEngine::takeFrame(VideoFrame& frame) {
+    if (!m_active || !m_active->worker->mailbox()->take(frame)) return false;
+    
+    if (m_awaitingFirstFrame) {
+        m_awaitingFirstFrame = false;
+        emit videoSwitched(activePath(), m_switchTimer.nsecsElapsed() / 1.0e6);
+    }
+    return true;
+}
+
+PlaybackEngine::Slot* PlaybackEngine::findSlot(const QString& path) {
+    for (Slot* slot : m_slots) {
+        if (slot->path == path) return slot;
+    }
+    return nullptr;
+}
+
+PlaybackEngine::Slot* PlaybackEngine::findSlot(const VideoWorker* worker) {
+    for (Slot* slot : m_slots) {
+        if (slot->worker == worker) return slot;
+    }
+    return nullptr;
+}
+
+bool PlaybackEngine::isActive(const VideoWorker* worker) const {
+    return m_active && m_active->worker == worker;
+}
+
+PlaybackEngine::Slot* PlaybackEngine::startSlot(const QString& path, bool active) {
+    Slot* slot = new Slot;
+    slot->path = path;
+    slot->thread = new QThread;
+    slot->worker = new VideoWorker(path);
+    slot->worker->setActive(active);
+    slot->worker->moveToThread(slot->thread);
+    m_slots.append(slot);
+    
+    VideoWorker* worker = slot->worker;
+    connect(slot->thread, &QThread::started, worker, &VideoWorker::process);
+    connect(worker, &VideoWorker::finished, slot->thread, &QThread::quit);
+    
+    // Forward the active worker's signals; remember metadata of primed ones
+    connect(worker, &VideoWorker::videoOpened, this, [this, worker](double duration, double fps, int width, int height) {
+        Slot* slot = findSlot(worker);
+        if (!slot) return;
+        slot->opened = true;
+        slot->duration = duration;
+        slot->fps = fps;
+        slot->width = width;
+        slot->height = height;
+        if (slot == m_active) emit videoOpened(duration, fps, width, height);
+    });
+    connect(worker, &VideoWorker::durationChanged, this, [this, worker](double duration) {
+        Slot* slot = findSlot(worker);
+        if (!slot) return;
+        slot->duration = duration;
+        if (slot == m_active) emit durationChanged(duration);
+    });
+    connect(worker, &VideoWorker::playbackStats, this, [this, worker](const PlaybackStats& stats) {
+        if (isActive(worker)) emit playbackStats(stats);
+    });
+    connect(worker, &VideoWorker::errorOccurred, this, [this, worker](QString message) {
+        Slot* slot = findSlot(worker);
+        if (!slot) return;
+        slot->error = message;
+        if (slot == m_active) emit errorOccurred(message);
+    });
+    
+    if (active) {
+        m_active = slot;
+    }
+    slot->thread->start();
+    return slot;
+}
+
+void PlaybackEngine::activate(Slot& slot) {
+    m_active = &slot;
+    slot.worker->mailbox()->clear(); // Left over from an earlier activation
+    slot.worker->setPaused(false);
+    slot.worker->setActive(true);
+    
+    // Replay what the GUI missed while the file was primed
+    if (slot.opened) {
+        emit videoOpened(slot.duration, slot.fps, slot.width, slot.height);
+    }
+    if (!slot.error.isEmpty()) {
+        emit errorOccurred(slot.error);
+    }
+}
+
+void PlaybackEngine::retire(Slot& slot) {
+    m_slots.removeOne(&slot);
+    if (m_active == &slot) {
+        m_active = nullptr;
+    }
+    
+    // Tear down without blocking the GUI on the decoder threads
+    slot.worker->stop();
+    if (slot.thread->isFinished()) {
+        delete slot.worker;
+        delete slot.thread;
+    } else {
+        connect(slot.thread, &QThread::finished, slot.worker, &QObject::deleteLater);
+        connect(slot.thread, &QThread::finished, slot.thread, &QObject::deleteLater);
+        m_retiring.removeIf([](const QPointer<QThread>& thread) { return thread.isNull(); });
+        m_retiring.append(QPointer<QThread>(slot.thread));
+    }
+    delete &slot;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+#include "VideoWorker.hpp"
+
+#include <QThread>
+
+// Long-lived owner of the video workers.
+// Besides the active video it keeps neighbouring files "primed": opened,
+// probed and with their first frames decoded, but not presenting. Switching
+// to a primed file is then just an activation, so ⏮/⏭ do not wait for the
+// container to open. Retired workers are torn down asynchronously.
+// Signals of the active worker are forwarded; the others are held back.
+// Frames are not signalled: the GUI pulls them with takeFrame().
+class PlaybackEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PlaybackEngine(QObject* parent = nullptr);
+    ~PlaybackEngine() override;
+
+    // Make path the active video, reusing a primed worker when there is one
+    void open(const QString& path);
+
+    // Keep these files primed in the background; other idle workers are dropped
+    void setPrefetch(const QStringList& paths);
+
+    // Drop every worker, e.g. after a decoder setting changed
+    void closeAll();
+
+    VideoWorker* activeWorker() const;
+    QString activePath() const;
+    
+    // Latest frame presented by the active worker since the last call
+    bool takeFrame(VideoFrame& frame);
+
+signals:
+    void videoOpened(double duration, double fps, int width, int height);
+    void durationChanged(double duration);
+    void playbackStats(const PlaybackStats& stats);
+    void errorOccurred(QString message);
+    
+    // Time from open() to the first frame of the new video reaching the GUI
+    void videoSwitched(const QString& path, double timeToFirstFrameMs);
+
+private:
+    struct Slot {
+        QString path;
+        VideoWorker* worker = nullptr;
+        QThread* thread = nullptr;
+        
+        // Metadata received while primed, replayed on activation
+        bool opened = false;
+        double duration = 0.0;
+        double fps = 0.0;
+        int width = 0;
+        int height = 0;
+        QString error;
+    };
+
+    Slot* findSlot(const QString& path);
+    Slot* findSlot(const VideoWorker* worker);
+    Slot* startSlot(const QString& path, bool active);
+    void retire(Slot& slot);
+    void activate(Slot& slot);
+    bool isActive(const VideoWorker* worker) const;
+
+    QVector<Slot*> m_slots;
+    Slot* m_active;
+    QVector<QPointer<QThread>> m_retiring;
+    
+    // Time-to-first-frame measurement for the current switch
+    QElapsedTimer m_switchTimer;
+    bool m_awaitingFirstFrame;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QMetaType>
+#include <QtGlobal>
+
+// Playback diagnostics reported by VideoWorker about once per second
+struct PlaybackStats {
+    int droppedFrames = 0;
+    int lateFrames = 0;
+    // Presented, but replaced in the mailbox before the GUI took them
+    qint64 overwrittenFrames = 0;
+    
+    // Average per decoded frame: bytes duplicated by memcpy-style copies and
+    // bytes written by the color conversion pass
+    qint64 bytesCopiedPerFrame = 0;
+    qint64 bytesConvertedPerFrame = 0;
+    
+    // Decoded frames waiting for presentation and the memory they hold
+    int bufferedFrames = 0;
+    qint64 bufferedBytes = 0;
+    qint64 bufferBudget = 0;
+    
+    // Frames served from the decoded-frame cache instead of the decoder
+    qint64 cacheLookups = 0;
+    qint64 cacheHits = 0;
+    
+    // Storage reads since the video was opened (FFmpeg backend): throughput
+    // of the medium and the total time the demuxer waited for data
+    qint64 ioBytesRead = 0;
+    double ioMegabytesPerSecond = 0.0;
+    qint64 ioStallMs = 0;
+    
+    bool operator==(const PlaybackStats&) const = default;
+};
+
+Q_DECLARE_METATYPE(PlaybackStats)
@@ -0,0 +1,526 @@
+#include "ProjectDatabase.hpp"
+#include "CsvImporter.hpp"
+#include "SidecarFile.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QVariant>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+const char* const kDatabaseName = "ethowild.sqlite";
+const char* const kCacheSuffix = ".ethoproject.sqlite";
+constexpr int kSchemaVersion = 1;
+constexpr int kBusyTimeoutMs = 5000; // A sync and the window may write at the same time
+
+// Records are the index; files tells which CSV file version they came from.
+// Unsaved labels have no file.
+const char* const kSchema[] = {
+    "CREATE TABLE files ("
+    " id INTEGER PRIMARY KEY,"
+    " name TEXT NOT NULL UNIQUE,"
+    " size INTEGER NOT NULL,"
+    " modified INTEGER NOT NULL)",
+    "CREATE TABLE records ("
+    " id INTEGER PRIMARY KEY,"
+    " file_id INTEGER,"
+    " video TEXT NOT NULL,"
+    " session INTEGER,"
+    " role TEXT,"
+    " behaviour TEXT,"
+    " parent_behaviour TEXT,"
+    " start_time REAL NOT NULL,"
+    " end_time REAL,"
+    " duration REAL,"
+    " record_type TEXT,"
+    " tag TEXT COLLATE NOCASE,"
+    " group_type TEXT,"
+    " sex TEXT,"
+    " observations TEXT,"
+    " stage TEXT,"
+    " group_size INTEGER,"
+    " mother_and_calf INTEGER,"
+    " calves INTEGER,"
+    " start_frame INTEGER,"
+    " end_frame INTEGER)",
+    // Each filter column leads an index ordered like the results (video,
+    // then start time), so matches stream out without sorting; duration
+    // makes counts and totals index-only
+    "CREATE INDEX records_video ON records(video, start_time, duration)",
+    "CREATE INDEX records_behaviour ON records(behaviour, video, start_time, duration)",
+    "CREATE INDEX records_category ON records(parent_behaviour, video, start_time, duration)",
+    "CREATE INDEX records_tag ON records(tag, video, start_time, duration)",
+    "CREATE INDEX records_file ON records(file_id)",
+    "CREATE INDEX records_unsaved ON records(video) WHERE file_id IS NULL",
+};
+
+const char* const kInsertRecord =
+    "INSERT INTO records (file_id, video, session, role, behaviour, parent_behaviour, start_time, end_time,"
+    " duration, record_type, tag, group_type, sex, observations, stage, group_size, mother_and_calf, calves,"
+    " start_frame, end_frame) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+QStringList videoFilters() {
+    return {"*.mp4", "*.avi", "*.mkv", "*.mov", "*.wmv"};
+}
+
+QString newConnectionName() {
+    static std::atomic<int> next{0};
+    return QString("ethowild-project-%1").arg(++next);
+}
+
+qint64 modifiedStamp(const QFileInfo& file) {
+    return file.lastModified().toMSecsSinceEpoch();
+}
+
+QVariant optional(const std::optional<int>& value) {
+    return value ? QVariant(*value) : QVariant();
+}
+
+QVariant optional(const std::optional<double>& value) {
+    return value ? QVariant(*value) : QVariant();
+}
+
+bool run(QSqlQuery& query, const QString& sql) {
+    if (query.exec(sql)) return true;
+    qWarning() << "Project database:" << query.lastError().text() << "in" << sql;
+    return false;
+}
+
+bool run(QSqlQuery& query) {
+    if (query.exec()) return true;
+    qWarning() << "Project database:" << query.lastError().text();
+    return false;
+}
+
+// Commits the transaction if everything in it succeeded
+bool finish(QSqlDatabase& db, bool ok) {
+    if (ok && db.commit()) return true;
+    db.rollback();
+    return false;
+}
+
+bool insertRecord(QSqlQuery& insert, const QVariant& fileId, const QString& video, const BehaviorRecord& r) {
+    insert.bindValue(0, fileId);
+    insert.bindValue(1, video);
+    insert.bindValue(2, r.session);
+    insert.bindValue(3, r.role);
+    insert.bindValue(4, r.behaviour);
+    insert.bindValue(5, r.parentBehaviour);
+    insert.bindValue(6, r.startTime);
+    insert.bindValue(7, optional(r.endTime));
+    insert.bindValue(8, r.duration);
+    insert.bindValue(9, r.recordType);
+    insert.bindValue(10, r.tag);
+    insert.bindValue(11, r.groupType);
+    insert.bindValue(12, r.sex);
+    insert.bindValue(13, r.observations);
+    insert.bindValue(14, r.stage);
+    insert.bindValue(15, optional(r.groupSize));
+    insert.bindValue(16, optional(r.motherAndCalf));
+    insert.bindValue(17, optional(r.calves));
+    insert.bindValue(18, optional(r.startFrame));
+    insert.bindValue(19, optional(r.endFrame));
+    return run(insert);
+}
+
+// The index is derived from the CSV files and the journals, so an older
+// layout is simply rebuilt
+bool createSchema(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (!run(query, "PRAGMA user_version") || !query.next()) return false;
+    if (query.value(0).toInt() == kSchemaVersion) return true;
+
+    if (!db.transaction()) return false;
+    bool ok = run(query, "DROP TABLE IF EXISTS records") && run(query, "DROP TABLE IF EXISTS files");
+    for (const char* statement : kSchema) {
+        ok = ok && run(query, statement);
+    }
+    ok = ok && run(query, QString("PRAGMA user_version = %1").arg(kSchemaVersion));
+    return finish(db, ok);
+}
+
+bool openConnection(const QString& name, const QString& path) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(path);
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(kBusyTimeoutMs));
+    if (!db.open()) {
+        qWarning() << "Cannot open project database" << path << ":" << db.lastError().text();
+        return false;
+    }
+
+    // WAL: readers never wait for the writer, and commits append to the log
+    // instead of syncing the whole database
+    QSqlQuery query(db);
+    return run(query, "PRAGMA journal_mode = WAL") && run(query, "PRAGMA synchronous = NORMAL")
+        && createSchema(db);
+}
+
+void closeConnection(const QString& name) {
+    QSqlDatabase::database(name, false).close();
+    QSqlDatabase::removeDatabase(name);
+}
+
+// Connection of one background job, on the thread that runs it
+class ScopedConnection {
+public:
+    explicit ScopedConnection(const QString& path) : m_name(newConnectionName()) {
+        m_open = openConnection(m_name, path);
+    }
+    ~ScopedConnection() { closeConnection(m_name); }
+
+    bool isOpen() const { return m_open; }
+    QSqlDatabase database() const { return QSqlDatabase::database(m_name, false); }
+
+private:
+    QString m_name;
+    bool m_open;
+};
+
+// Row of the file in files, added or brought up to date with the file, and
+// without records. Runs inside the caller's transaction.
+bool replaceFile(QSqlDatabase& db, const QFileInfo& file, QVariant& fileId) {
+    QSqlQuery query(db);
+    query.prepare("SELECT id FROM files WHERE name = ?");
+    query.bindValue(0, file.fileName());
+    if (!run(query)) return false;
+    if (query.next()) {
+        fileId = query.value(0);
+        query.prepare("DELETE FROM records WHERE file_id = ?");
+        query.bindValue(0, fileId);
+        bool ok = run(query);
+        query.prepare("UPDATE files SET size = ?, modified = ? WHERE id = ?");
+        query.bindValue(0, file.size());
+        query.bindValue(1, modifiedStamp(file));
+        query.bindValue(2, fileId);
+        return ok && run(query);
+    }
+    query.prepare("INSERT INTO files (name, size, modified) VALUES (?, ?, ?)");
+    query.bindValue(0, file.fileName());
+    query.bindValue(1, file.size());
+    query.bindValue(2, modifiedStamp(file));
+    if (!run(query)) return false;
+    fileId = query.lastInsertId();
+    return true;
+}
+
+// Replaces the records of one CSV file in a single transaction, so a
+// cancelled or failed file leaves its previous version indexed
+bool indexCsv(QSqlDatabase& db, const QFileInfo& file, const QString& video,
+              const RecordStore::Vocabulary& vocabulary, const CsvExporter::Progress& progress) {
+    const CsvImporter::Result result = CsvImporter(vocabulary).importFiles({file.absoluteFilePath()}, progress);
+    if (result.cancelled) return false;
+    if (result.issueCount > 0) {
+        qWarning() << "Indexing" << file.fileName() << ":" << result.issueCount << "problems,"
+                   << result.skippedRows << "rows skipped";
+    }
+
+    if (!db.transaction()) return false;
+    QVariant fileId;
+    bool ok = replaceFile(db, file, fileId);
+    QSqlQuery insert(db);
+    ok = ok && insert.prepare(kInsertRecord);
+    for (const RecordStore::Row& row : result.records) {
+        if (!ok) break;
+        ok = insertRecord(insert, fileId, video, row.toRecord());
+    }
+    return finish(db, ok);
+}
+
+// WHERE clause of a filter, with its values in order
+QString whereClause(const ProjectDatabase::Filter& filter, QVariantList& values) {
+    QStringList conditions;
+    auto equal = [&](const char* column, const QString& value) {
+        if (value.isEmpty()) return;
+        conditions << QString("r.%1 = ?").arg(QLatin1String(column));
+        values << value;
+    };
+    equal("video", filter.video);
+    equal("behaviour", filter.behaviour);
+    equal("parent_behaviour", filter.parentBehaviour);
+    equal("tag", filter.tag);
+    if (filter.from > 0.0) {
+        conditions << "r.start_time >= ?";
+        values << filter.from;
+    }
+    if (std::isfinite(filter.to)) {
+        conditions << "r.start_time <= ?";
+        values << filter.to;
+    }
+    return conditions.isEmpty() ? QString() : " WHERE " + conditions.join(" AND ");
+}
+
+} // namespace
+
+ProjectDatabase::ProjectDatabase() = default;
+
+ProjectDatabase::~ProjectDatabase() {
+    close();
+}
+
+bool ProjectDatabase::open(const QString& directory) {
+    close();
+
+    // An existing database wherever it is, else a new one in the directory
+    const QString inDirectory = QDir(directory).filePath(kDatabaseName);
+    const QString inCache = SidecarFile::cachePathFor(directory, kCacheSuffix);
+    QStringList candidates;
+    if (QFileInfo::exists(inDirectory)) {
+        candidates << inDirectory;
+    } else if (QFileInfo::exists(inCache)) {
+        candidates << inCache;
+    } else {
+        candidates << inDirectory << inCache;
+    }
+
+    for (const QString& path : candidates) {
+        const QString name = newConnectionName();
+        if (openConnection(name, path)) {
+            m_connection = name;
+            m_path = path;
+            m_directory = directory;
+            return true;
+        }
+        closeConnection(name);
+    }
+    return false;
+}
+
+void ProjectDatabase::close() {
+    if (m_connection.isEmpty()) return;
+    closeConnection(m_connection);
+    m_connection.clear();
+    m_path.clear();
+    m_directory.clear();
+}
+
+bool ProjectDatabase::isOpen() const {
+    return !m_connection.isEmpty();
+}
+
+QSqlDatabase ProjectDatabase::database() const {
+    return QSqlDatabase::database(m_connection, false);
+}
+
+bool ProjectDatabase::sync(const QString& databasePath, const QString& directory,
+                           const RecordStore::Vocabulary& vocabulary, const CsvExporter::Progress& progress) {
+    ScopedConnection connection(databasePath);
+    if (!connection.isOpen()) return false;
+    QSqlDatabase db = connection.database();
+
+    const QDir dir(directory);
+    const QStringList videos = dir.entryList(videoFilters(), QDir::Files, QDir::Name);
+    const QFileInfoList csvFiles = dir.entryInfoList({"*.csv"}, QDir::Files, QDir::Name);
+    const QStringList arrowFiles = dir.entryList({"*.arrow", "*.feather"}, QDir::Files, QDir::Name);
+
+    // Size and modification time of the files as they were indexed
+    QHash<QString, std::pair<qint64, qint64>> indexed;
+    {
+        QSqlQuery query(db);
+        if (!run(query, "SELECT name, size, modified FROM files")) return false;
+        while (query.next()) {
+            indexed.insert(query.value(0).toString(), {query.value(1).toLongLong(), query.value(2).toLongLong()});
+        }
+    }
+
+    QFileInfoList changed;
+    qint64 total = 0;
+    for (const QFileInfo& file : csvFiles) {
+        const auto found = indexed.constFind(file.fileName());
+        if (found == indexed.constEnd() || found->first != file.size() || found->second != modifiedStamp(file)) {
+            changed << file;
+            total += file.size();
+        }
+        indexed.remove(file.fileName());
+    }
+
+    // Arrow files are not read back; their records stay while they exist
+    for (const QString& name : arrowFiles) indexed.remove(name);
+
+    // Whatever is left was deleted or renamed
+    if (!indexed.isEmpty()) {
+        if (!db.transaction()) return false;
+        QSqlQuery query(db);
+        bool ok = true;
+        for (auto it = indexed.constBegin(); ok && it != indexed.constEnd(); ++it) {
+            query.prepare("DELETE FROM records WHERE file_id = (SELECT id FROM files WHERE name = ?)");
+            query.bindValue(0, it.key());
+            ok = run(query);
+            query.prepare("DELETE FROM files WHERE name = ?");
+            query.bindValue(0, it.key());
+            ok = ok && run(query);
+        }
+        if (!finish(db, ok)) return false;
+    }
+
+    // Progress counts bytes over all files
+    qint64 done = 0;
+    for (const QFileInfo& file : changed) {
+        CsvExporter::Progress fileProgress;
+        fileProgress.cancel = progress.cancel;
+        if (progress.report) {
+            fileProgress.report = [&progress, &done, total](qint64 fileDone, qint64) {
+                progress.report(done + fileDone, total);
+            };
+        }
+        if (!indexCsv(db, file, videoForCsv(file.fileName(), videos), vocabulary, fileProgress)) return false;
+        done += file.size();
+        if (progress.report) progress.report(done, total);
+    }
+    return true;
+}
+
+bool ProjectDatabase::saveUnsaved(const QString& videoPath, const QString& filePath) {
+    if (!isOpen()) return false;
+    const QFileInfo file(filePath);
+    if (file.absoluteDir() != QDir(m_directory)) return false; // Not part of the project
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) return false;
+    QVariant fileId;
+    bool ok = replaceFile(db, file, fileId);
+    QSqlQuery query(db);
+    query.prepare("UPDATE records SET file_id = ? WHERE file_id IS NULL AND video = ?");
+    query.bindValue(0, fileId);
+    query.bindValue(1, QFileInfo(videoPath).fileName());
+    ok = ok && run(query);
+    return finish(db, ok);
+}
+
+void ProjectDatabase::setUnsaved(const QString& videoPath, const std::vector<BehaviorRecord>& records) {
+    if (!isOpen()) return;
+    const QString video = QFileInfo(videoPath).fileName();
+    QSqlDatabase db = database();
+    if (!db.transaction()) return;
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM records WHERE file_id IS NULL AND video = ?");
+    query.bindValue(0, video);
+    bool ok = run(query);
+    ok = ok && query.prepare(kInsertRecord);
+    for (const BehaviorRecord& record : records) {
+        if (!ok) break;
+        ok = insertRecord(query, QVariant(), video, record);
+    }
+    finish(db, ok);
+}
+
+void ProjectDatabase::appendUnsaved(const QString& videoPath, const BehaviorRecord& record) {
+    if (!isOpen()) return;
+    QSqlQuery insert(database());
+    if (insert.prepare(kInsertRecord)) {
+        insertRecord(insert, QVariant(), QFileInfo(videoPath).fileName(), record);
+    }
+}
+
+bool ProjectDatabase::appendUnsaved(const QString& databasePath, const QString& videoPath,
+                                    const RecordStore& records) {
+    if (records.isEmpty()) return true;
+    ScopedConnection connection(databasePath);
+    if (!connection.isOpen()) return false;
+    QSqlDatabase db = connection.database();
+    if (!db.transaction()) return false;
+
+    const QString video = QFileInfo(videoPath).fileName();
+    QSqlQuery insert(db);
+    bool ok = insert.prepare(kInsertRecord);
+    for (const RecordStore::Row& row : records) {
+        if (!ok) break;
+        ok = insertRecord(insert, QVariant(), video, row.toRecord());
+    }
+    return finish(db, ok);
+}
+
+void ProjectDatabase::deleteUnsaved(const QString& videoPath, int index) {
+    if (!isOpen()) return;
+    QSqlQuery query(database());
+    query.prepare("DELETE FROM records WHERE id = (SELECT id FROM records"
+                  " WHERE file_id IS NULL AND video = ? ORDER BY id LIMIT 1 OFFSET ?)");
+    query.bindValue(0, QFileInfo(videoPath).fileName());
+    query.bindValue(1, index);
+    run(query);
+}
+
+QSqlQuery ProjectDatabase::select(const Filter& filter) const {
+    QVariantList values;
+    const QString where = whereClause(filter, values);
+
+    // Times as MM:SS like the records table
+    QSqlQuery query(database());
+    query.prepare(
+        "SELECT r.video AS Video,"
+        " ifnull(f.name, '(unsaved)') AS File,"
+        " printf('%02d:%02d', CAST(r.start_time AS INTEGER) / 60, CAST(r.start_time AS INTEGER) % 60) AS Start,"
+        " CASE WHEN r.end_time IS NULL THEN '' ELSE"
+        " printf('%02d:%02d', CAST(r.end_time AS INTEGER) / 60, CAST(r.end_time AS INTEGER) % 60) END AS \"End\","
+        " printf('%.1f', r.duration) AS Duration,"
+        " r.behaviour AS Behavior,"
+        " r.parent_behaviour AS Category,"
+        " r.record_type AS Type,"
+        " r.tag AS Tag,"
+        " r.role AS Role,"
+        " r.sex AS Sex,"
+        " r.stage AS Stage,"
+        " r.observations AS Observations"
+        " FROM records r LEFT JOIN files f ON f.id = r.file_id" + where +
+        " ORDER BY r.video, r.start_time");
+    for (int i = 0; i < values.size(); ++i) {
+        query.bindValue(i, values[i]);
+    }
+    run(query);
+    return query;
+}
+
+ProjectDatabase::Summary ProjectDatabase::summarize(const Filter& filter) const {
+    QVariantList values;
+    const QString where = whereClause(filter, values);
+
+    Summary summary;
+    QSqlQuery query(database());
+    query.prepare("SELECT COUNT(*), TOTAL(r.duration) FROM records r" + where);
+    for (int i = 0; i < values.size(); ++i) {
+        query.bindValue(i, values[i]);
+    }
+    if (run(query) && query.next()) {
+        summary.count = query.value(0).toLongLong();
+        summary.totalDuration = query.value(1).toDouble();
+    }
+    return summary;
+}
+
+QStringList ProjectDatabase::videos() const {
+    QStringList videos;
+    QSqlQuery query(database());
+    // One index seek per video instead of a scan of every record
+    if (run(query, "WITH RECURSIVE v(video) AS ("
+                   " SELECT MIN(video) FROM records"
+                   " UNION ALL SELECT (SELECT MIN(video) FROM records WHERE video > v.video) FROM v"
+                   " WHERE v.video IS NOT NULL)"
+                   " SELECT video FROM v WHERE video IS NOT NULL")) {
+        while (query.next()) videos << query.value(0).toString();
+    }
+    return videos;
+}
+
+QString ProjectDatabase::videoForCsv(const QString& csvPath, const QStringList& videoFiles) {
+    // "<video>.csv", then "<video>_N.csv" as generateUniqueFilePath numbers them
+    static const QRegularExpression numbered("^(.*)_\\d+$");
+    const QString baseName = QFileInfo(csvPath).completeBaseName();
+    QStringList names{baseName};
+    const QRegularExpressionMatch match = numbered.match(baseName);
+    if (match.hasMatch()) names << match.captured(1);
+
+    for (const QString& name : names) {
+        for (const QString& video : videoFiles) {
+            if (QFileInfo(video).completeBaseName() == name) return QFileInfo(video).fileName();
+        }
+    }
+    return match.hasMatch() ? match.captured(1) : baseName; // Video no longer in the directory
+}
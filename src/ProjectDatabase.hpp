@@ -0,0 +1,96 @@
+#pragma once
+
+#include "BehaviorRecord.hpp"
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <limits>
+#include <vector>
+
+class QSqlDatabase;
+
+// Index of every record of a video directory, across all its videos: the
+// saved CSV files and the unsaved labels, in one SQLite database
+// ("ethowild.sqlite" in the directory, or in the cache directory when the
+// folder is read-only). Records are indexed by video, behavior, category,
+// tag and start time, so questions about a whole season are answered
+// without reading hundreds of CSV files.
+//
+// CSV files belong to a video by name, as CsvExporter::generateUniqueFilePath
+// makes them: "<video>.csv" and "<video>_1.csv" both hold labels of <video>.
+// sync() reads a file again only when its size or modification time changed.
+// Unsaved labels are mirrored as they are made, and become the records of
+// the file they are saved to. Arrow files are not read back: their records
+// stay indexed as they were saved for as long as the file exists.
+//
+// A connection belongs to the thread that opened it: sync() and the bulk
+// appendUnsaved() open their own so they can run on a RecordsJob thread.
+// The database is in WAL mode, so queries from the window go on while a
+// sync writes.
+class ProjectDatabase {
+public:
+    // Records matching every condition that is set
+    struct Filter {
+        QString video;           // Video file name
+        QString behaviour;
+        QString parentBehaviour;
+        QString tag;             // Case-insensitive
+        double from = 0.0;       // Start time range in seconds
+        double to = std::numeric_limits<double>::infinity();
+    };
+
+    struct Summary {
+        qint64 count = 0;
+        double totalDuration = 0.0;
+    };
+
+    ProjectDatabase();
+    ~ProjectDatabase();
+    ProjectDatabase(const ProjectDatabase&) = delete;
+    ProjectDatabase& operator=(const ProjectDatabase&) = delete;
+
+    // Close the previous project and open (or create) the directory's one
+    bool open(const QString& directory);
+    void close();
+    bool isOpen() const;
+    QString path() const { return m_path; }
+    QString directory() const { return m_directory; }
+
+    // Brings the index up to date with the CSV files of the directory:
+    // new and changed files are read, removed ones dropped. Runs on any
+    // thread; a cancelled sync keeps the files indexed so far.
+    static bool sync(const QString& databasePath, const QString& directory,
+                     const RecordStore::Vocabulary& vocabulary,
+                     const CsvExporter::Progress& progress = CsvExporter::Progress());
+    // Unsaved labels of a video, in labeling order
+    void setUnsaved(const QString& videoPath, const std::vector<BehaviorRecord>& records);
+    // The video's unsaved labels were saved to filePath (CSV or Arrow): they
+    // become that file's records in one transaction, without reading it.
+    // False if the file is not in the project's directory.
+    bool saveUnsaved(const QString& videoPath, const QString& filePath);
+    void appendUnsaved(const QString& videoPath, const BehaviorRecord& record);
+    // Many at once (e.g. an import), in one transaction on a connection of
+    // its own, so it runs on a RecordsJob thread like sync()
+    static bool appendUnsaved(const QString& databasePath, const QString& videoPath, const RecordStore& records);
+    // Index among the video's unsaved labels
+    void deleteUnsaved(const QString& videoPath, int index);
+
+    // Matching records ordered by video and start time, for display: video,
+    // file, start, end, duration, behavior, category, type, tag, role, sex,
+    // stage and observations. Rows are read as they are fetched.
+    QSqlQuery select(const Filter& filter) const;
+    Summary summarize(const Filter& filter) const;
+    QStringList videos() const; // With at least one record
+
+    // Video a CSV file belongs to, given the videos of its directory
+    static QString videoForCsv(const QString& csvPath, const QStringList& videoFiles);
+
+private:
+    QSqlDatabase database() const;
+
+    QString m_path;
+    QString m_directory;
+    QString m_connection; // Connection name, unique per open
+};
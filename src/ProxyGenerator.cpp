@@ -0,0 +1,386 @@
+#include "ProxyGenerator.hpp"
+#include "FrameIndex.hpp"
+#include "SidecarFile.hpp"
+#include "VideoDecoder.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#ifdef ETHOWILD_WITH_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+namespace {
+constexpr quint32 kStampMagic = 0x45505258; // "EPRX"
+constexpr quint32 kStampVersion = 1;
+const QString kStampSuffix = QStringLiteral(".ethoproxy");
+const QString kProxySuffix = QStringLiteral(".proxy.mov");
+
+constexpr double kPtsTolerance = 2e-6; // Proxy timestamps are kept to the microsecond
+
+// Finished proxy described by the stamp at stampPath, or an empty string
+QString checkedProxy(const QString& stampPath, const QString& proxyPath, const QString& videoPath) {
+    QFile file(stampPath);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    if (!SidecarFile::checkStamp(in, kStampMagic, kStampVersion, videoPath)) return QString();
+
+    // Also stale if the proxy itself was truncated or replaced
+    qint64 proxySize = -1;
+    in >> proxySize;
+    QFileInfo proxy(proxyPath);
+    if (in.status() != QDataStream::Ok || !proxy.exists() || proxy.size() != proxySize) return QString();
+    return proxyPath;
+}
+
+bool writeStamp(const QString& stampPath, const QString& proxyPath, const QString& videoPath) {
+    QSaveFile file(stampPath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    SidecarFile::writeStamp(out, kStampMagic, kStampVersion, videoPath);
+    out << static_cast<qint64>(QFileInfo(proxyPath).size());
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+// Frame N of the proxy must be frame N of the source, at the same time
+bool framesMatch(const FrameIndex& source, const FrameIndex& proxy) {
+    if (source.frameCount() != proxy.frameCount()) return false;
+    for (int i = 0; i < source.frameCount(); ++i) {
+        if (std::abs(source.pts(i) - proxy.pts(i)) > kPtsTolerance) return false;
+    }
+    return true;
+}
+
+#ifdef ETHOWILD_WITH_FFMPEG
+// Motion-JPEG in QuickTime: every frame is a keyframe, so stepping, reverse
+// playback and seeks on the proxy never decode more than one frame. Frames
+// keep the source PTS in microseconds.
+class ProxyWriter {
+public:
+    ~ProxyWriter() {
+        if (m_format && m_format->pb) avio_closep(&m_format->pb);
+        avformat_free_context(m_format);
+        avcodec_free_context(&m_codec);
+        av_frame_free(&m_picture);
+        av_packet_free(&m_packet);
+        sws_freeContext(m_sws);
+    }
+
+    bool open(const QString& path, const QSize& size, double fps) {
+        if (avformat_alloc_output_context2(&m_format, nullptr, "mov", path.toUtf8().constData()) < 0) return false;
+        const AVCodec* encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!encoder) return false;
+        m_codec = avcodec_alloc_context3(encoder);
+        m_stream = avformat_new_stream(m_format, nullptr);
+        m_picture = av_frame_alloc();
+        m_packet = av_packet_alloc();
+        if (!m_codec || !m_stream || !m_picture || !m_packet) return false;
+
+        m_codec->width = size.width();
+        m_codec->height = size.height();
+        m_codec->pix_fmt = AV_PIX_FMT_YUVJ420P;
+        m_codec->color_range = AVCOL_RANGE_JPEG;
+        m_codec->colorspace = AVCOL_SPC_BT470BG;
+        m_codec->time_base = AVRational{1, 1000000};
+        m_codec->framerate = av_d2q(fps > 0 ? fps : 30.0, 100000);
+        m_codec->flags |= AV_CODEC_FLAG_QSCALE;
+        m_codec->global_quality = FF_QP2LAMBDA * 4;
+        if (m_format->oformat->flags & AVFMT_GLOBALHEADER) {
+            m_codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (avcodec_open2(m_codec, encoder, nullptr) < 0) return false;
+        if (avcodec_parameters_from_context(m_stream->codecpar, m_codec) < 0) return false;
+        m_stream->time_base = m_codec->time_base;
+        m_stream->avg_frame_rate = m_codec->framerate;
+
+        m_picture->format = m_codec->pix_fmt;
+        m_picture->width = size.width();
+        m_picture->height = size.height();
+        if (av_frame_get_buffer(m_picture, 0) < 0) return false;
+
+        // Display pixels (BGRA) to full-range BT.601, as JPEG expects
+        m_sws = sws_getContext(size.width(), size.height(), AV_PIX_FMT_BGRA, size.width(), size.height(),
+                               AV_PIX_FMT_YUVJ420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!m_sws) return false;
+        const int* coefficients = sws_getCoefficients(SWS_CS_ITU601);
+        sws_setColorspaceDetails(m_sws, coefficients, 1, coefficients, 1, 0, 1 << 16, 1 << 16);
+
+        if (avio_open(&m_format->pb, path.toUtf8().constData(), AVIO_FLAG_WRITE) < 0) return false;
+        return avformat_write_header(m_format, nullptr) >= 0;
+    }
+
+    // image must be Format_RGB32 at the proxy size; pts in microseconds
+    bool write(const QImage& image, int64_t pts) {
+        if (av_frame_make_writable(m_picture) < 0) return false;
+        const uint8_t* planes[4] = {image.constBits(), nullptr, nullptr, nullptr};
+        const int strides[4] = {static_cast<int>(image.bytesPerLine()), 0, 0, 0};
+        sws_scale(m_sws, planes, strides, 0, image.height(), m_picture->data, m_picture->linesize);
+        m_picture->pts = pts;
+        m_picture->quality = m_codec->global_quality;
+        return avcodec_send_frame(m_codec, m_picture) >= 0 && drain();
+    }
+
+    bool finish() {
+        if (avcodec_send_frame(m_codec, nullptr) < 0 || !drain()) return false;
+        if (av_write_trailer(m_format) < 0) return false;
+        return avio_closep(&m_format->pb) >= 0;
+    }
+
+private:
+    bool drain() {
+        while (avcodec_receive_packet(m_codec, m_packet) == 0) {
+            av_packet_rescale_ts(m_packet, m_codec->time_base, m_stream->time_base);
+            m_packet->stream_index = m_stream->index;
+            if (av_interleaved_write_frame(m_format, m_packet) < 0) return false;
+        }
+        return true;
+    }
+
+    AVFormatContext* m_format = nullptr;
+    AVCodecContext* m_codec = nullptr;
+    AVStream* m_stream = nullptr;
+    AVFrame* m_picture = nullptr;
+    AVPacket* m_packet = nullptr;
+    SwsContext* m_sws = nullptr;
+};
+#endif
+}
+
+ProxyGenerator::ProxyGenerator(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_generation(0)
+    , m_stop(false)
+{
+    m_options.threads = std::max(1, m_options.threads);
+    m_options.height = std::max(2, m_options.height & ~1);
+}
+
+ProxyGenerator::~ProxyGenerator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_queue.clear();
+    }
+    m_queueChanged.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool ProxyGenerator::isAvailable() {
+#ifdef ETHOWILD_WITH_FFMPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString ProxyGenerator::proxyFor(const QString& videoPath) {
+    QString proxy = checkedProxy(SidecarFile::pathFor(videoPath, kStampSuffix),
+                                 SidecarFile::pathFor(videoPath, kProxySuffix), videoPath);
+    if (proxy.isEmpty()) {
+        proxy = checkedProxy(SidecarFile::cachePathFor(videoPath, kStampSuffix),
+                             SidecarFile::cachePathFor(videoPath, kProxySuffix), videoPath);
+    }
+    return proxy;
+}
+
+bool ProxyGenerator::isProxyFile(const QString& path) {
+    return path.endsWith(kProxySuffix, Qt::CaseInsensitive) || path.endsWith(kProxySuffix + ".part", Qt::CaseInsensitive);
+}
+
+void ProxyGenerator::setQueue(const QStringList& videoPaths) {
+    if (!isAvailable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.assign(videoPaths.begin(), videoPaths.end());
+
+        // Started on first use; they sleep while the queue is empty
+        while (static_cast<int>(m_threads.size()) < m_options.threads) {
+            m_threads.emplace_back(&ProxyGenerator::workerLoop, this);
+        }
+    }
+    m_queueChanged.notify_all();
+}
+
+void ProxyGenerator::prioritize(const QString& videoPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find(m_queue.begin(), m_queue.end(), videoPath);
+    if (it != m_queue.end()) {
+        m_queue.erase(it);
+        m_queue.push_front(videoPath);
+    }
+}
+
+void ProxyGenerator::cancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    ++m_generation;
+}
+
+void ProxyGenerator::workerLoop() {
+    while (true) {
+        QString videoPath;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueChanged.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop) return;
+            videoPath = m_queue.front();
+            m_queue.pop_front();
+            if (m_running.contains(videoPath)) continue;
+            m_running << videoPath;
+        }
+
+        // Finished proxies from an earlier session are not rebuilt
+        QString proxyPath;
+        QString reason;
+        Result result = Result::Skipped;
+        if (proxyFor(videoPath).isEmpty()) {
+            result = transcode(videoPath, proxyPath, reason);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running.removeAll(videoPath);
+        }
+        if (result == Result::Done) {
+            emit proxyReady(videoPath, proxyPath);
+        } else if (result == Result::Failed) {
+            qWarning() << "No proxy for" << videoPath << "-" << reason;
+            emit proxyFailed(videoPath, reason);
+        }
+    }
+}
+
+QSize ProxyGenerator::proxySize(const QSize& source) const {
+    // Same aspect ratio; even dimensions for 4:2:0
+    int height = std::min(m_options.height, source.height()) & ~1;
+    int width = static_cast<int>(std::lround(source.width() * static_cast<double>(height) / source.height())) & ~1;
+    return QSize(std::max(2, width), std::max(2, height));
+}
+
+ProxyGenerator::Result ProxyGenerator::transcode(const QString& videoPath, QString& proxyPath, QString& reason) {
+#ifdef ETHOWILD_WITH_FFMPEG
+    const quint64 generation = m_generation;
+
+    // A share of the cores per job; the rest stays with playback
+    VideoDecoder::Options decoderOptions;
+    decoderOptions.threads = std::max(1, QThread::idealThreadCount() / (2 * m_options.threads));
+    auto decoder = VideoDecoder::create("ffmpeg", decoderOptions);
+    if (!decoder->open(videoPath)) {
+        reason = "the video could not be opened";
+        return Result::Failed;
+    }
+    const QSize sourceSize = decoder->frameSize();
+    if (sourceSize.height() < m_options.minSourceHeight) return Result::Skipped;
+
+    // The source's frame table: progress, and the reference the proxy is checked against
+    FrameIndex sourceIndex;
+    if (!sourceIndex.load(videoPath)) {
+        sourceIndex = FrameIndex::build(videoPath, m_stop);
+        if (isCancelled(generation)) return Result::Cancelled;
+        if (sourceIndex.isEmpty()) {
+            reason = "the video could not be indexed";
+            return Result::Failed;
+        }
+        sourceIndex.save(videoPath);
+    }
+
+    // Next to the video when its folder is writable, otherwise in the cache
+    const bool besideVideo = QFileInfo(QFileInfo(videoPath).absolutePath()).isWritable();
+    proxyPath = besideVideo ? SidecarFile::pathFor(videoPath, kProxySuffix)
+                            : SidecarFile::cachePathFor(videoPath, kProxySuffix);
+    const QString stampPath = besideVideo ? SidecarFile::pathFor(videoPath, kStampSuffix)
+                                          : SidecarFile::cachePathFor(videoPath, kStampSuffix);
+    const QString partPath = proxyPath + ".part";
+
+    const QSize size = proxySize(sourceSize);
+    auto writer = std::make_unique<ProxyWriter>();
+    if (!writer->open(partPath, size, decoder->fps())) {
+        writer.reset();
+        QFile::remove(partPath);
+        reason = "the proxy could not be created";
+        return Result::Failed;
+    }
+
+    auto pool = FramePool::create();
+    DecodeRegion region;
+    region.output = size;
+    QImage image;
+    int frames = 0;
+    int64_t lastPts = -1;
+    auto lastReport = std::chrono::steady_clock::now();
+    auto abandon = [&](Result result, const QString& why) {
+        writer.reset();
+        QFile::remove(partPath);
+        reason = why;
+        return result;
+    };
+
+    // Every frame, in order: proxy frame N is source frame N
+    while (decoder->grab()) {
+        if (isCancelled(generation)) return abandon(Result::Cancelled, QString());
+
+        int64_t pts = std::llround(decoder->framePts() * 1e6);
+        if (pts <= lastPts) return abandon(Result::Failed, "timestamps are not increasing");
+        lastPts = pts;
+        if (decoder->retrieve(*pool, image, region) == VideoDecoder::Transfer::Failed || !writer->write(image, pts)) {
+            return abandon(Result::Failed, "transcoding failed");
+        }
+
+        ++frames;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1)) {
+            lastReport = now;
+            emit progress(videoPath, std::min(1.0, frames / static_cast<double>(sourceIndex.frameCount())));
+        }
+    }
+    if (!writer->finish()) return abandon(Result::Failed, "the proxy could not be written");
+    writer.reset();
+
+    // The stamp is written last: a proxy without one is never used
+    QFile::remove(stampPath);
+    QFile::remove(proxyPath);
+    if (!QFile::rename(partPath, proxyPath)) {
+        QFile::remove(partPath);
+        reason = "the proxy could not be moved into place";
+        return Result::Failed;
+    }
+
+    FrameIndex proxyIndex = FrameIndex::build(proxyPath, m_stop);
+    if (isCancelled(generation)) return Result::Cancelled;
+    if (!framesMatch(sourceIndex, proxyIndex)) {
+        QFile::remove(proxyPath);
+        reason = "proxy frames do not line up with the original";
+        return Result::Failed;
+    }
+    proxyIndex.save(proxyPath);
+    if (!writeStamp(stampPath, proxyPath, videoPath)) {
+        reason = "the proxy stamp could not be written";
+        return Result::Failed;
+    }
+    return Result::Done;
+#else
+    (void)videoPath;
+    (void)proxyPath;
+    reason = "proxies need the FFmpeg backend";
+    return Result::Failed;
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Low-resolution stand-ins for videos too heavy to play smoothly (4K/5.3K
+// HEVC). Every frame of the source is transcoded, in order and with the
+// source's own timestamps, into a small all-intra (Motion-JPEG) file, so
+// frame N of the proxy is frame N of the original at the same PTS. Positions,
+// seeks and recorded behaviors therefore carry over unchanged; each proxy is
+// checked against the source's frame index before it is used.
+//
+// Proxies are built by a few background threads and live next to the video
+// (or in the cache directory) as "<video>.proxy.mov", with a sidecar stamp
+// written once the proxy is complete. An interrupted run resumes with the
+// videos that have no finished proxy yet. Requires the FFmpeg backend.
+class ProxyGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        int height = 540;           // Proxy frame height
+        int minSourceHeight = 1440; // Smaller sources play well enough as they are
+        int threads = 2;            // Videos transcoded at the same time
+    };
+
+    explicit ProxyGenerator(const Options& options, QObject* parent = nullptr);
+    ~ProxyGenerator() override;
+
+    static bool isAvailable();
+
+    // Finished proxy of the video, or an empty string
+    static QString proxyFor(const QString& videoPath);
+    // Proxy files (and unfinished ones) are not videos to label
+    static bool isProxyFile(const QString& path);
+
+    // Replace the pending videos (those with a proxy are skipped); the first
+    // ones are built first. Videos already being transcoded carry on.
+    void setQueue(const QStringList& videoPaths);
+    // Move a pending video to the front, e.g. when the user opens it
+    void prioritize(const QString& videoPath);
+    // Drop the queue and abort the transcodes in progress
+    void cancelAll();
+
+signals:
+    void progress(const QString& videoPath, double fraction);
+    void proxyReady(const QString& videoPath, const QString& proxyPath);
+    void proxyFailed(const QString& videoPath, const QString& reason);
+
+private:
+    enum class Result { Done, Skipped, Cancelled, Failed };
+
+    void workerLoop();
+    Result transcode(const QString& videoPath, QString& proxyPath, QString& reason);
+    QSize proxySize(const QSize& source) const;
+    bool isCancelled(quint64 generation) const { return m_stop || generation != m_generation; }
+
+    Options m_options;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<QString> m_queue;
+    QStringList m_running;               // Being transcoded right now
+    std::atomic<quint64> m_generation;   // Bumped by cancelAll()
+    std::atomic<bool> m_stop;
+};
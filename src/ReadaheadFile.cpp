@@ -0,0 +1,368 @@
+#include "ReadaheadFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t nanosecondsSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+int64_t readAt(int fd, int64_t offset, uint8_t* buffer, int64_t size) {
+#ifdef _WIN32
+    if (_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+    return _read(fd, buffer, static_cast<unsigned>(size));
+#else
+    ssize_t result;
+    do {
+        result = ::pread(fd, buffer, static_cast<size_t>(size), static_cast<off_t>(offset));
+    } while (result < 0 && errno == EINTR);
+    return result;
+#endif
+}
+
+} // namespace
+
+ReadaheadFile::ReadaheadFile(const Options& options)
+    : m_options(options)
+    , m_counters(options.counters ? options.counters : std::make_shared<IoCounters>())
+    , m_fd(-1)
+    , m_size(0)
+    , m_mapping(nullptr)
+    , m_windowStart(0)
+    , m_windowEnd(0)
+    , m_position(0)
+    , m_nextChunk(FIRST_CHUNK_BYTES)
+    , m_generation(0)
+    , m_interrupted(false)
+    , m_stop(false)
+{
+    // At least four chunks fit in the ring, so reading never waits on the reader
+    if (m_options.bufferBytes > 0) {
+        m_options.chunkBytes = std::clamp<size_t>(m_options.chunkBytes, FIRST_CHUNK_BYTES,
+                                                  std::max(FIRST_CHUNK_BYTES, m_options.bufferBytes / 4));
+        m_options.bufferBytes = std::max(m_options.bufferBytes, 4 * m_options.chunkBytes);
+    }
+}
+
+ReadaheadFile::~ReadaheadFile() {
+    close();
+}
+
+bool ReadaheadFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    m_fd = _wopen(std::filesystem::path(reinterpret_cast<const char8_t*>(path.c_str())).c_str(), _O_RDONLY | _O_BINARY);
+    if (m_fd < 0) return false;
+    m_size = _lseeki64(m_fd, 0, SEEK_END);
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) return false;
+    struct stat info;
+    m_size = ::fstat(m_fd, &info) == 0 ? static_cast<int64_t>(info.st_size) : -1;
+#endif
+    if (m_size < 0) {
+        close();
+        return false;
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // Lets the kernel read ahead more aggressively on its own as well
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+#ifndef _WIN32
+    if (m_options.memoryMap && m_options.bufferBytes > 0 && m_size > 0) {
+        void* mapping = ::mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (mapping != MAP_FAILED) {
+            ::madvise(mapping, static_cast<size_t>(m_size), MADV_SEQUENTIAL);
+            m_mapping = static_cast<const uint8_t*>(mapping);
+        }
+    }
+#endif
+
+    if (m_options.bufferBytes > 0) {
+        if (!m_mapping) {
+            m_ring.resize(m_options.bufferBytes);
+            m_chunk.resize(m_options.chunkBytes);
+        }
+        m_stop = false;
+        m_ioThread = std::thread(&ReadaheadFile::ioLoop, this);
+    }
+    return true;
+}
+
+void ReadaheadFile::close() {
+    if (m_ioThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        ++m_generation; // Cuts an in-flight storage read short
+        m_roomFreed.notify_all();
+        m_ioThread.join();
+    }
+
+#ifndef _WIN32
+    if (m_mapping) {
+        ::munmap(const_cast<uint8_t*>(m_mapping), static_cast<size_t>(m_size));
+    }
+#endif
+    m_mapping = nullptr;
+    if (m_fd >= 0) {
+#ifdef _WIN32
+        _close(m_fd);
+#else
+        ::close(m_fd);
+#endif
+    }
+    m_fd = -1;
+    m_size = 0;
+
+    std::vector<uint8_t>().swap(m_ring);
+    std::vector<uint8_t>().swap(m_chunk);
+    m_windowStart = 0;
+    m_windowEnd = 0;
+    m_position = 0;
+    m_nextChunk = FIRST_CHUNK_BYTES;
+    m_interrupted = false;
+    m_stop = false;
+}
+
+int64_t ReadaheadFile::read(uint8_t* buffer, int64_t size) {
+    if (m_fd < 0 || size <= 0) return m_fd < 0 ? -1 : 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_interrupted) return -1;
+    if (m_position >= m_size) return 0;
+
+    // Synchronous: the caller waits for storage on every read
+    if (!m_ioThread.joinable()) {
+        auto start = Clock::now();
+        int64_t wanted = std::min(size, m_size - m_position);
+        int64_t result = readStorage(m_position, buffer, wanted, m_generation.load());
+        m_counters->stallNanoseconds.fetch_add(nanosecondsSince(start), std::memory_order_relaxed);
+        if (result <= 0) return result < 0 ? -1 : 0;
+        m_position += result;
+        return result;
+    }
+
+    if (m_position >= m_windowEnd) {
+        auto start = Clock::now();
+        m_dataReady.wait(lock, [this] {
+            return m_interrupted || m_position < m_windowEnd || m_windowEnd >= m_size;
+        });
+        m_counters->stallNanoseconds.fetch_add(nanosecondsSince(start), std::memory_order_relaxed);
+        if (m_interrupted) return -1;
+        if (m_position >= m_windowEnd) return 0; // Storage error; treated as end of file
+    }
+
+    int64_t count = std::min(size, m_windowEnd - m_position);
+    copyOut(m_position, buffer, count);
+    m_position += count;
+    lock.unlock();
+    m_roomFreed.notify_one();
+    return count;
+}
+
+bool ReadaheadFile::seek(int64_t offset) {
+    if (m_fd < 0 || offset < 0) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        offset = std::min(offset, m_size);
+
+        // Backtracking into the ring and short skips ahead keep the window
+        const int64_t reach = m_windowEnd + static_cast<int64_t>(m_options.chunkBytes);
+        if (!m_ioThread.joinable() || (offset >= m_windowStart && offset <= reach)) {
+            m_position = offset;
+        } else {
+            // Far seek: restart reading at the new position with a small first chunk
+            ++m_generation;
+            m_windowStart = offset;
+            m_windowEnd = offset;
+            m_position = offset;
+            m_nextChunk = FIRST_CHUNK_BYTES;
+            m_counters->seeks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    m_roomFreed.notify_one();
+    return true;
+}
+
+int64_t ReadaheadFile::position() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_position;
+}
+
+void ReadaheadFile::interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_interrupted = true;
+    }
+    m_dataReady.notify_all();
+}
+
+void ReadaheadFile::resume() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interrupted = false;
+}
+
+void ReadaheadFile::ioLoop() {
+    const int64_t capacity = static_cast<int64_t>(m_options.bufferBytes);
+
+    // Oldest byte that must stay readable: a quarter of the ring is kept
+    // behind the position for the demuxer to backtrack into. A mapping keeps
+    // everything, so only the distance ahead counts there.
+    auto keepFrom = [this, capacity] {
+        if (m_mapping) return m_position;
+        return std::min(m_position, std::max(m_windowStart, m_position - capacity / 4));
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        int64_t remaining = m_size - m_windowEnd;
+        int64_t length = std::min(static_cast<int64_t>(m_nextChunk), remaining);
+        if (length <= 0 || capacity - (m_windowEnd - keepFrom()) < length) {
+            m_roomFreed.wait(lock);
+            continue;
+        }
+
+        const int64_t offset = m_windowEnd;
+        const uint64_t generation = m_generation.load();
+        lock.unlock();
+
+        // Ask for the chunk after this one too, so storage stays busy while
+        // this one is copied and consumed
+        hint(offset + length, static_cast<int64_t>(m_options.chunkBytes));
+        int64_t result = m_mapping ? touchPages(offset, length, generation)
+                                   : readStorage(offset, m_chunk.data(), length, generation);
+
+        lock.lock();
+        if (m_stop) break;
+        if (generation != m_generation.load() || offset != m_windowEnd) continue; // Seeked meanwhile
+        if (result <= 0) {
+            // Unreadable (or shorter than it claimed): end the file here
+            m_size = m_windowEnd;
+            m_dataReady.notify_all();
+            continue;
+        }
+
+        // The position may have moved back while reading; never overwrite
+        // what is still to be read
+        int64_t fits = capacity - (m_windowEnd - keepFrom());
+        result = std::min(result, fits);
+        if (result <= 0) continue;
+        if (!m_mapping) {
+            m_windowStart = std::max(m_windowStart, m_windowEnd + result - capacity);
+            copyIn(m_windowEnd, m_chunk.data(), result);
+        }
+        m_windowEnd += result;
+        m_nextChunk = std::min(m_nextChunk * 2, m_options.chunkBytes);
+        m_dataReady.notify_all();
+    }
+}
+
+int64_t ReadaheadFile::readStorage(int64_t offset, uint8_t* buffer, int64_t size, uint64_t generation) {
+    int64_t done = 0;
+    while (done < size && generation == m_generation.load()) {
+        int64_t piece = std::min(size - done, PIECE_BYTES);
+        auto start = Clock::now();
+        int64_t result = readAt(m_fd, offset + done, buffer + done, piece);
+        if (result > 0) throttle(result);
+        m_counters->readNanoseconds.fetch_add(nanosecondsSince(start), std::memory_order_relaxed);
+        if (result <= 0) return done > 0 ? done : result;
+        m_counters->bytesRead.fetch_add(result, std::memory_order_relaxed);
+        done += result;
+    }
+    return done;
+}
+
+int64_t ReadaheadFile::touchPages(int64_t offset, int64_t size, uint64_t generation) {
+    constexpr int64_t PAGE_BYTES = 4096;
+
+    int64_t done = 0;
+    while (done < size && generation == m_generation.load()) {
+        int64_t piece = std::min(size - done, PIECE_BYTES);
+        auto start = Clock::now();
+
+        // One byte per page faults the whole piece in
+        volatile uint8_t sink = 0;
+        for (int64_t page = 0; page < piece; page += PAGE_BYTES) {
+            sink = sink + m_mapping[offset + done + page];
+        }
+        (void)sink;
+        throttle(piece);
+
+        m_counters->readNanoseconds.fetch_add(nanosecondsSince(start), std::memory_order_relaxed);
+        m_counters->bytesRead.fetch_add(piece, std::memory_order_relaxed);
+        done += piece;
+    }
+    return done;
+}
+
+void ReadaheadFile::throttle(int64_t bytes) {
+    if (m_options.throttleBytesPerSecond <= 0.0 && m_options.throttleLatencySeconds <= 0.0) return;
+
+    double seconds = m_options.throttleLatencySeconds;
+    if (m_options.throttleBytesPerSecond > 0.0) {
+        seconds += bytes / m_options.throttleBytesPerSecond;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+
+void ReadaheadFile::hint(int64_t offset, int64_t size) {
+    size = std::min(size, m_size - offset);
+    if (size <= 0) return;
+
+#ifndef _WIN32
+    if (m_mapping) {
+        // Page-aligned start, as madvise requires
+        int64_t aligned = offset & ~static_cast<int64_t>(::sysconf(_SC_PAGESIZE) - 1);
+        ::madvise(const_cast<uint8_t*>(m_mapping) + aligned, static_cast<size_t>(size + offset - aligned), MADV_WILLNEED);
+        return;
+    }
+#endif
+#if defined(__linux__)
+    ::readahead(m_fd, static_cast<off_t>(offset), static_cast<size_t>(size));
+#elif defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise(m_fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+#endif
+}
+
+void ReadaheadFile::copyOut(int64_t offset, uint8_t* buffer, int64_t size) const {
+    if (m_mapping) {
+        std::memcpy(buffer, m_mapping + offset, static_cast<size_t>(size));
+        return;
+    }
+
+    // At most two pieces: up to the end of the ring, then from its start
+    const int64_t capacity = static_cast<int64_t>(m_ring.size());
+    int64_t start = offset % capacity;
+    int64_t first = std::min(size, capacity - start);
+    std::memcpy(buffer, m_ring.data() + start, static_cast<size_t>(first));
+    std::memcpy(buffer + first, m_ring.data(), static_cast<size_t>(size - first));
+}
+
+void ReadaheadFile::copyIn(int64_t offset, const uint8_t* buffer, int64_t size) {
+    const int64_t capacity = static_cast<int64_t>(m_ring.size());
+    int64_t start = offset % capacity;
+    int64_t first = std::min(size, capacity - start);
+    std::memcpy(m_ring.data() + start, buffer, static_cast<size_t>(first));
+    std::memcpy(m_ring.data(), buffer + first, static_cast<size_t>(size - first));
+}
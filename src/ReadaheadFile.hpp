@@ -0,0 +1,88 @@
+#pragma once
+
+#include "IoCounters.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Read-only file with asynchronous readahead, for videos on slow media
+// (USB disks, SD cards). An I/O thread reads large sequential chunks ahead of
+// the read position into a ring buffer, so the demuxer's many small reads
+// are served from memory and only wait for storage after a far seek. Reads
+// shortly behind the position (demuxer backtracking) stay in the ring.
+//
+// With memoryMap the file is mapped instead and the I/O thread faults the
+// pages in ahead of the position; reads then copy straight from the mapping.
+// A bufferBytes of 0 reads synchronously on the caller's thread.
+class ReadaheadFile {
+public:
+    struct Options {
+        size_t bufferBytes = 32 * 1024 * 1024; // Data kept ahead of (and shortly behind) the position
+        size_t chunkBytes = 2 * 1024 * 1024;   // Size of each storage read
+        bool memoryMap = false;
+        // Simulated slow media for benchmarks: bandwidth and per-read latency
+        double throttleBytesPerSecond = 0.0;
+        double throttleLatencySeconds = 0.0;
+        std::shared_ptr<IoCounters> counters; // Optional
+    };
+
+    explicit ReadaheadFile(const Options& options);
+    ~ReadaheadFile();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    int64_t size() const { return m_size; }
+
+    // Copy up to size bytes from the read position. Returns the number of
+    // bytes copied, 0 at the end of the file, -1 on error or interruption.
+    int64_t read(uint8_t* buffer, int64_t size);
+    bool seek(int64_t offset);
+    int64_t position() const;
+
+    // Make blocked and future reads return -1 until resumed (demuxer abort)
+    void interrupt();
+    void resume();
+
+private:
+    static constexpr size_t FIRST_CHUNK_BYTES = 256 * 1024; // Fast first frame after a seek
+    static constexpr int64_t PIECE_BYTES = 512 * 1024;      // Largest single storage request
+
+    void ioLoop();
+    // Storage access; stop early (returning what was read) when the window
+    // is reset meanwhile, since the data would be discarded anyway
+    int64_t readStorage(int64_t offset, uint8_t* buffer, int64_t size, uint64_t generation);
+    int64_t touchPages(int64_t offset, int64_t size, uint64_t generation);
+    void throttle(int64_t bytes);
+    void hint(int64_t offset, int64_t size);
+    void copyOut(int64_t offset, uint8_t* buffer, int64_t size) const;
+    void copyIn(int64_t offset, const uint8_t* buffer, int64_t size);
+
+    Options m_options;
+    std::shared_ptr<IoCounters> m_counters;
+    int m_fd;
+    int64_t m_size;
+    const uint8_t* m_mapping; // Whole file when memory mapped
+
+    std::thread m_ioThread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_dataReady;  // Window grew, or interrupted
+    std::condition_variable m_roomFreed;  // Position moved, window reset, or stopping
+    std::vector<uint8_t> m_ring;          // Byte at offset o lives at m_ring[o % size]
+    std::vector<uint8_t> m_chunk;         // Staging buffer of the I/O thread
+    int64_t m_windowStart;                // Buffered file range [start, end)
+    int64_t m_windowEnd;
+    int64_t m_position;
+    size_t m_nextChunk;                   // Grows from FIRST_CHUNK_BYTES after each seek
+    std::atomic<uint64_t> m_generation;   // Bumped when the window is reset
+    bool m_interrupted;
+    bool m_stop;
+};
@@ -0,0 +1,292 @@
+#include "RecordStore.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char* const kRecordTypes[] = {"EVENT", "STATE"};
+
+template <typename T>
+void eraseAt(std::vector<T>& column, int index) {
+    column.erase(column.begin() + index);
+}
+
+template <typename T>
+size_t columnBytes(const std::vector<T>& column) {
+    return column.capacity() * sizeof(T);
+}
+
+} // namespace
+
+StringDictionary::StringDictionary() {
+    clear();
+}
+
+uint32_t StringDictionary::intern(const QString& value) {
+    auto it = m_codes.constFind(value);
+    if (it != m_codes.constEnd()) return it.value();
+    const uint32_t code = static_cast<uint32_t>(m_values.size());
+    m_values.append(value);
+    m_codes.insert(value, code);
+    return code;
+}
+
+int StringDictionary::find(const QString& value) const {
+    auto it = m_codes.constFind(value);
+    return it != m_codes.constEnd() ? it.value() : -1;
+}
+
+void StringDictionary::clear() {
+    m_values = QStringList{QString()};
+    m_codes.clear();
+    m_codes.insert(QString(), 0);
+}
+
+std::optional<double> RecordStore::Row::endTime() const {
+    const double end = m_store->m_endTimes[m_index];
+    return std::isnan(end) ? std::nullopt : std::optional<double>(end);
+}
+
+std::optional<int> RecordStore::Row::endFrame() const {
+    const std::optional<int> offset = optional(m_store->m_endFrames[m_index]);
+    if (!offset) return std::nullopt;
+    return static_cast<int32_t>(static_cast<uint32_t>(startFrame().value_or(0)) + static_cast<uint32_t>(*offset));
+}
+
+BehaviorRecord RecordStore::Row::toRecord() const {
+    BehaviorRecord record;
+    record.session = session();
+    record.role = role();
+    record.behaviour = behaviour();
+    record.parentBehaviour = parentBehaviour();
+    record.startTime = startTime();
+    record.endTime = endTime();
+    record.startFrame = startFrame();
+    record.endFrame = endFrame();
+    record.duration = duration();
+    record.recordType = recordType();
+    record.tag = tag();
+    record.groupType = groupType();
+    record.sex = sex();
+    record.observations = observations().toString();
+    record.stage = stage();
+    record.groupSize = groupSize();
+    record.motherAndCalf = motherAndCalf();
+    record.calves = calves();
+    return record;
+}
+
+RecordStore::RecordStore(const Vocabulary& vocabulary) {
+    auto seed = [this](Field field, const QStringList& values) {
+        for (const QString& value : values) dictionary(field).intern(value);
+    };
+    seed(Field::Role, vocabulary.roles);
+    seed(Field::Behaviour, vocabulary.behaviours);
+    seed(Field::ParentBehaviour, vocabulary.parentBehaviours);
+    for (const char* type : kRecordTypes) dictionary(Field::RecordType).intern(QString::fromLatin1(type));
+    seed(Field::GroupType, vocabulary.groupTypes);
+    seed(Field::Sex, vocabulary.sexes);
+    seed(Field::Stage, vocabulary.stages);
+    m_textStarts.push_back(0);
+}
+
+void RecordStore::reserve(int records) {
+    const int n = std::max(0, records);
+    for (auto& column : m_codes) column.reserve(n);
+    m_sessions.reserve(n);
+    m_startTimes.reserve(n);
+    m_endTimes.reserve(n);
+    m_startFrames.reserve(n);
+    m_endFrames.reserve(n);
+    m_groupSizes.reserve(n);
+    m_motherAndCalf.reserve(n);
+    m_calves.reserve(n);
+}
+
+void RecordStore::append(const BehaviorRecord& record) {
+    auto code = [this](Field field, const QString& value) {
+        m_codes[static_cast<int>(field)].push_back(dictionary(field).intern(value));
+    };
+    code(Field::Role, record.role);
+    code(Field::Behaviour, record.behaviour);
+    code(Field::ParentBehaviour, record.parentBehaviour);
+    code(Field::RecordType, record.recordType);
+    code(Field::Tag, record.tag);
+    code(Field::GroupType, record.groupType);
+    code(Field::Sex, record.sex);
+    code(Field::Stage, record.stage);
+
+    if (!record.observations.isEmpty()) {
+        m_textRows.push_back(size());
+        m_text += record.observations;
+        m_textStarts.push_back(static_cast<uint32_t>(m_text.size()));
+    }
+
+    // The duration is not kept: it is always end minus start
+    m_sessions.push_back(zigzag(record.session));
+    m_startTimes.push_back(record.startTime);
+    m_endTimes.push_back(record.endTime.value_or(std::nan("")));
+    m_startFrames.push_back(fromOptional(record.startFrame));
+    // A state spans a few hundred frames, so its end frame is stored as an
+    // offset that fits in two bytes; wrapping arithmetic keeps it exact
+    std::optional<int> endOffset;
+    if (record.endFrame) {
+        endOffset = static_cast<int32_t>(static_cast<uint32_t>(*record.endFrame)
+                                         - static_cast<uint32_t>(record.startFrame.value_or(0)));
+    }
+    m_endFrames.push_back(fromOptional(endOffset));
+    m_groupSizes.push_back(fromOptional(record.groupSize));
+    m_motherAndCalf.push_back(fromOptional(record.motherAndCalf));
+    m_calves.push_back(fromOptional(record.calves));
+}
+
+void RecordStore::append(const RecordStore& other) {
+    if (other.isEmpty()) return;
+
+    // One lookup per distinct value, not per record
+    for (int f = 0; f < CODED_FIELDS; ++f) {
+        const StringDictionary& values = other.m_dictionaries[f];
+        std::vector<uint32_t> codes(values.size());
+        for (int code = 0; code < values.size(); ++code) {
+            codes[code] = m_dictionaries[f].intern(values.value(static_cast<uint32_t>(code)));
+        }
+        m_codes[f].append(other.m_codes[f], &codes);
+    }
+
+    const int baseRow = size();
+    const uint32_t baseText = static_cast<uint32_t>(m_text.size());
+    m_text += other.m_text;
+    for (int32_t row : other.m_textRows) m_textRows.push_back(baseRow + row);
+    for (size_t k = 1; k < other.m_textStarts.size(); ++k) m_textStarts.push_back(baseText + other.m_textStarts[k]);
+
+    auto extend = [](auto& column, const auto& more) { column.insert(column.end(), more.begin(), more.end()); };
+    m_sessions.append(other.m_sessions);
+    extend(m_startTimes, other.m_startTimes);
+    extend(m_endTimes, other.m_endTimes);
+    m_startFrames.append(other.m_startFrames);
+    m_endFrames.append(other.m_endFrames);
+    m_groupSizes.append(other.m_groupSizes);
+    m_motherAndCalf.append(other.m_motherAndCalf);
+    m_calves.append(other.m_calves);
+}
+
+void RecordStore::remove(int index) {
+    if (index < 0 || index >= size()) return;
+
+    for (auto& column : m_codes) column.erase(index);
+    m_sessions.erase(index);
+    eraseAt(m_startTimes, index);
+    eraseAt(m_endTimes, index);
+    m_startFrames.erase(index);
+    m_endFrames.erase(index);
+    m_groupSizes.erase(index);
+    m_motherAndCalf.erase(index);
+    m_calves.erase(index);
+
+    // Close the gap in the text buffer; later records move down by one
+    auto text = std::lower_bound(m_textRows.begin(), m_textRows.end(), index);
+    size_t k = static_cast<size_t>(text - m_textRows.begin());
+    if (text != m_textRows.end() && *text == index) {
+        const uint32_t start = m_textStarts[k];
+        const uint32_t length = m_textStarts[k + 1] - start;
+        m_text.remove(start, length);
+        m_textRows.erase(text);
+        eraseAt(m_textStarts, static_cast<int>(k + 1));
+        for (size_t i = k + 1; i < m_textStarts.size(); ++i) m_textStarts[i] -= length;
+    }
+    for (; k < m_textRows.size(); ++k) --m_textRows[k];
+}
+
+void RecordStore::clear() {
+    for (auto& column : m_codes) column.clear();
+    m_sessions.clear();
+    m_startTimes.clear();
+    m_endTimes.clear();
+    m_startFrames.clear();
+    m_endFrames.clear();
+    m_groupSizes.clear();
+    m_motherAndCalf.clear();
+    m_calves.clear();
+    m_text.clear();
+    m_textRows.clear();
+    m_textStarts.assign(1, 0);
+}
+
+QStringView RecordStore::observations(int index) const {
+    auto text = std::lower_bound(m_textRows.begin(), m_textRows.end(), index);
+    if (text == m_textRows.end() || *text != index) return QStringView();
+    const size_t k = static_cast<size_t>(text - m_textRows.begin());
+    return QStringView(m_text).mid(m_textStarts[k], m_textStarts[k + 1] - m_textStarts[k]);
+}
+
+double RecordStore::duration(int index) const {
+    const double end = m_endTimes[index];
+    return std::isnan(end) ? 0.0 : end - m_startTimes[index];
+}
+
+std::vector<int> RecordStore::select(const Query& query) const {
+    // One pass per condition over its own column; each pass narrows the
+    // candidates left by the previous one
+    std::vector<int> rows;
+    const double* start = m_startTimes.data();
+    const int n = size();
+    for (int i = 0; i < n; ++i) {
+        if (start[i] >= query.from && start[i] <= query.to) rows.push_back(i);
+    }
+
+    auto narrow = [this, &rows](Field field, const std::optional<uint32_t>& wanted) {
+        if (!wanted) return;
+        const uint32_t value = *wanted;
+        codes(field).visit([&rows, value](const auto* column, int) {
+            rows.erase(std::remove_if(rows.begin(), rows.end(), [column, value](int i) { return column[i] != value; }),
+                       rows.end());
+        });
+    };
+    narrow(Field::Behaviour, query.behaviour);
+    narrow(Field::ParentBehaviour, query.parentBehaviour);
+    narrow(Field::RecordType, query.recordType);
+    narrow(Field::Tag, query.tag);
+    return rows;
+}
+
+std::vector<RecordStore::Aggregate> RecordStore::aggregate(Field field, const std::vector<int>* rows) const {
+    // Dense tables indexed by code: no hashing per record
+    const int values = dictionary(field).size();
+    std::vector<int> counts(values, 0);
+    std::vector<double> durations(values, 0.0);
+    const double* start = m_startTimes.data();
+    const double* end = m_endTimes.data();
+    codes(field).visit([&](const auto* column, int n) {
+        auto add = [&](int i) {
+            ++counts[column[i]];
+            if (!std::isnan(end[i])) durations[column[i]] += end[i] - start[i];
+        };
+        if (rows) {
+            for (int i : *rows) add(i);
+        } else {
+            for (int i = 0; i < n; ++i) add(i);
+        }
+    });
+
+    std::vector<Aggregate> result;
+    for (int code = 0; code < values; ++code) {
+        if (counts[code] > 0) {
+            result.push_back({static_cast<uint32_t>(code), counts[code], durations[code]});
+        }
+    }
+    return result;
+}
+
+size_t RecordStore::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& column : m_codes) bytes += column.capacityBytes();
+    for (const PackedColumn* column : {&m_sessions, &m_startFrames, &m_endFrames, &m_groupSizes, &m_motherAndCalf,
+                                       &m_calves}) {
+        bytes += column->capacityBytes();
+    }
+    bytes += columnBytes(m_startTimes) + columnBytes(m_endTimes);
+    bytes += columnBytes(m_textRows) + columnBytes(m_textStarts);
+    bytes += static_cast<size_t>(m_text.capacity()) * sizeof(QChar);
+    return bytes;
+}
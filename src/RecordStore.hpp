@@ -0,0 +1,176 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "BehaviorRecord.hpp"
+#include "PackedColumn.hpp"
+
+// Strings of one categorical field, each stored once. Code 0 is always the
+// empty string; codes never change while the dictionary lives.
+class StringDictionary {
+public:
+    StringDictionary();
+
+    // Code of the value, adding it if it is new
+    uint32_t intern(const QString& value);
+    // Code of the value, or -1 if it is not in the dictionary
+    int find(const QString& value) const;
+    const QString& value(uint32_t code) const { return m_values[code]; }
+    int size() const { return m_values.size(); }
+    void clear();
+
+private:
+    QStringList m_values;
+    QHash<QString, uint32_t> m_codes;
+};
+
+// Behavior records stored by column. Fields with a closed vocabulary (the
+// lists in behaviors.json) are kept as codes into dictionaries seeded from
+// Config, tags are dictionary-coded as well, and each code, session, frame
+// and count column is only as wide as its largest value (see PackedColumn):
+// one byte for a vocabulary, two for a few thousand tags. Times are doubles,
+// durations are derived from them, and the observations of the few records
+// that have any share one text buffer. On RecordStoreBench's records this is
+// about 38 bytes a record against 344 for a BehaviorRecord with its strings
+// (9x), and scans touch only the columns they need. Records keep labeling
+// order.
+class RecordStore {
+public:
+    enum class Field { Role, Behaviour, ParentBehaviour, RecordType, Tag, GroupType, Sex, Stage, FIELD_COUNT };
+
+    // Values known up front; codes follow this order
+    struct Vocabulary {
+        QStringList roles;
+        QStringList behaviours;
+        QStringList parentBehaviours;
+        QStringList groupTypes;
+        QStringList sexes;
+        QStringList stages;
+    };
+
+    // One record, read in place
+    class Row {
+    public:
+        Row(const RecordStore& store, int index) : m_store(&store), m_index(index) {}
+
+        int index() const { return m_index; }
+        int session() const { return unzigzag(m_store->m_sessions[m_index]); }
+        const QString& text(Field field) const { return m_store->dictionary(field).value(code(field)); }
+        uint32_t code(Field field) const { return m_store->m_codes[static_cast<int>(field)][m_index]; }
+        const QString& role() const { return text(Field::Role); }
+        const QString& behaviour() const { return text(Field::Behaviour); }
+        const QString& parentBehaviour() const { return text(Field::ParentBehaviour); }
+        const QString& recordType() const { return text(Field::RecordType); }
+        const QString& tag() const { return text(Field::Tag); }
+        const QString& groupType() const { return text(Field::GroupType); }
+        const QString& sex() const { return text(Field::Sex); }
+        const QString& stage() const { return text(Field::Stage); }
+        QStringView observations() const { return m_store->observations(m_index); }
+        double startTime() const { return m_store->m_startTimes[m_index]; }
+        std::optional<double> endTime() const;
+        double duration() const { return m_store->duration(m_index); }
+        std::optional<int> startFrame() const { return optional(m_store->m_startFrames[m_index]); }
+        std::optional<int> endFrame() const;
+        std::optional<int> groupSize() const { return optional(m_store->m_groupSizes[m_index]); }
+        std::optional<int> motherAndCalf() const { return optional(m_store->m_motherAndCalf[m_index]); }
+        std::optional<int> calves() const { return optional(m_store->m_calves[m_index]); }
+
+        BehaviorRecord toRecord() const;
+
+        Row& operator++() { ++m_index; return *this; }
+        bool operator!=(const Row& other) const { return m_index != other.m_index; }
+        const Row& operator*() const { return *this; }
+
+    private:
+        static std::optional<int> optional(uint32_t packed) {
+            return packed == 0 ? std::nullopt : std::optional<int>(unzigzag(packed - 1));
+        }
+
+        const RecordStore* m_store;
+        int m_index;
+    };
+
+    // Records matching every condition that is set
+    struct Query {
+        std::optional<uint32_t> behaviour;
+        std::optional<uint32_t> parentBehaviour;
+        std::optional<uint32_t> recordType;
+        std::optional<uint32_t> tag;
+        double from = 0.0;  // Start time range in seconds
+        double to = std::numeric_limits<double>::infinity();
+    };
+
+    struct Aggregate {
+        uint32_t code = 0;
+        int count = 0;
+        double totalDuration = 0.0;
+    };
+
+    explicit RecordStore(const Vocabulary& vocabulary = Vocabulary());
+
+    int size() const { return static_cast<int>(m_startTimes.size()); }
+    bool isEmpty() const { return m_startTimes.empty(); }
+    void reserve(int records);
+
+    void append(const BehaviorRecord& record);
+    // All records of another store (e.g. one loaded in parallel), with its
+    // codes translated to this store's dictionaries
+    void append(const RecordStore& other);
+    void remove(int index);
+    // Drops the records; dictionaries keep their codes
+    void clear();
+
+    Row at(int index) const { return Row(*this, index); }
+    Row begin() const { return Row(*this, 0); }
+    Row end() const { return Row(*this, size()); }
+
+    const StringDictionary& dictionary(Field field) const { return m_dictionaries[static_cast<int>(field)]; }
+    // Dictionary-coded column, for scans
+    const PackedColumn& codes(Field field) const { return m_codes[static_cast<int>(field)]; }
+    const std::vector<double>& startTimes() const { return m_startTimes; }
+
+    std::vector<int> select(const Query& query) const;
+    // Count and total duration per value of field, over rows (all records if null)
+    std::vector<Aggregate> aggregate(Field field, const std::vector<int>* rows = nullptr) const;
+
+    // Memory held by the records, dictionaries excluded
+    size_t memoryBytes() const;
+
+private:
+    static constexpr int CODED_FIELDS = static_cast<int>(Field::FIELD_COUNT);
+
+    // Signed ints as unsigned ones that stay small for small magnitudes, so
+    // their columns stay narrow. Optional ints add one, leaving 0 for none
+    // (INT32_MIN is read back as none).
+    static uint32_t zigzag(int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+    static int32_t unzigzag(uint32_t value) { return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1))); }
+    static uint32_t fromOptional(const std::optional<int>& value) { return value ? zigzag(*value) + 1 : 0; }
+
+    StringDictionary& dictionary(Field field) { return m_dictionaries[static_cast<int>(field)]; }
+    QStringView observations(int index) const;
+    double duration(int index) const; // End minus start, 0 without an end
+
+    StringDictionary m_dictionaries[CODED_FIELDS];
+    PackedColumn m_codes[CODED_FIELDS];
+    PackedColumn m_sessions;             // zigzag()
+    std::vector<double> m_startTimes;
+    std::vector<double> m_endTimes;      // NaN when the record has no end
+    PackedColumn m_startFrames;          // fromOptional()
+    PackedColumn m_endFrames;            // fromOptional() of the offset from the start frame
+    PackedColumn m_groupSizes;
+    PackedColumn m_motherAndCalf;
+    PackedColumn m_calves;
+    // Observations, back to back, of the few records that have any
+    QString m_text;
+    std::vector<int32_t> m_textRows;     // Records with observations, ascending
+    std::vector<uint32_t> m_textStarts;  // m_textRows[k]'s text is [start[k], start[k + 1])
+};
@@ -0,0 +1,83 @@
+#include "RecordsDelegate.hpp"
+#include "RecordsModel.hpp"
+
+#include <QAbstractItemView>
+#include <QCursor>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionButton>
+#include <algorithm>
+
+RecordsDelegate::RecordsDelegate(QWidget* view)
+    : QStyledItemDelegate(view)
+    , m_styleButton(new QPushButton(view))
+{
+    m_styleButton->setObjectName("deleteButton");
+    m_styleButton->hide();
+}
+
+void RecordsDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    if (!isDeleteCell(index)) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Row background and selection, then the button on top
+    QStyleOptionViewItem background = option;
+    initStyleOption(&background, index);
+    QStyle* style = m_styleButton->style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &background, painter, option.widget);
+
+    QStyleOptionButton button;
+    button.initFrom(m_styleButton);
+    button.rect = buttonRect(option.rect);
+    button.text = QStringLiteral("✕");
+    button.state = QStyle::State_Enabled;
+    auto* view = qobject_cast<const QAbstractItemView*>(option.widget);
+    if ((option.state & QStyle::State_MouseOver) && view
+        && button.rect.contains(view->viewport()->mapFromGlobal(QCursor::pos()))) {
+        button.state |= QStyle::State_MouseOver;
+    }
+    if (m_pressed == index) button.state |= QStyle::State_Sunken;
+    style->drawControl(QStyle::CE_PushButton, &button, painter, m_styleButton);
+}
+
+QSize RecordsDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    if (isDeleteCell(index)) return QSize(BUTTON_SIZE + 4, BUTTON_SIZE);
+    return QStyledItemDelegate::sizeHint(option, index);
+}
+
+bool RecordsDelegate::editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                                  const QModelIndex& index) {
+    if (!isDeleteCell(index)) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::MouseButtonDblClick) {
+        auto* mouse = static_cast<QMouseEvent*>(event);
+        if (mouse->button() == Qt::LeftButton && buttonRect(option.rect).contains(mouse->position().toPoint())) {
+            m_pressed = index;
+            return true;
+        }
+    } else if (event->type() == QEvent::MouseButtonRelease) {
+        auto* mouse = static_cast<QMouseEvent*>(event);
+        const bool clicked = m_pressed == index && buttonRect(option.rect).contains(mouse->position().toPoint());
+        m_pressed = QModelIndex();
+        if (clicked) {
+            emit deleteRequested(index.row());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RecordsDelegate::isDeleteCell(const QModelIndex& index) {
+    return index.column() == RecordsModel::DeleteColumn;
+}
+
+QRect RecordsDelegate::buttonRect(const QRect& cell) {
+    QRect rect(0, 0, BUTTON_SIZE, std::min(BUTTON_SIZE, cell.height()));
+    rect.moveCenter(cell.center());
+    return rect;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QPushButton>
+#include <QStyledItemDelegate>
+
+// Draws the delete action of the records table as a button-looking cell, so
+// rows need no widgets of their own. A click on it emits deleteRequested
+// with the view row. The button is painted through a hidden QPushButton
+// named "deleteButton", so the theme's style sheet still applies to it.
+class RecordsDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit RecordsDelegate(QWidget* view);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                     const QModelIndex& index) override;
+
+signals:
+    void deleteRequested(int row);
+
+private:
+    static constexpr int BUTTON_SIZE = 28;
+
+    static bool isDeleteCell(const QModelIndex& index);
+    static QRect buttonRect(const QRect& cell);
+
+    QPushButton* m_styleButton; // Never shown, owned by the view
+    QModelIndex m_pressed;      // Cell where the mouse button went down
+};
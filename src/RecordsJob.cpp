@@ -0,0 +1,40 @@
+#include "RecordsJob.hpp"
+
+#include <algorithm>
+
+RecordsJob::RecordsJob(Work work, QObject* parent)
+    : QObject(parent)
+    , m_work(std::move(work))
+    , m_cancel(false)
+    , m_percent(-1)
+{
+}
+
+RecordsJob::~RecordsJob() {
+    cancel();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void RecordsJob::start() {
+    if (m_thread.joinable()) return;
+    m_thread = std::thread(&RecordsJob::run, this);
+}
+
+void RecordsJob::cancel() {
+    m_cancel = true;
+}
+
+void RecordsJob::run() {
+    CsvExporter::Progress progress;
+    progress.cancel = &m_cancel;
+    progress.report = [this](qint64 done, qint64 total) {
+        // Only whole percent steps cross to the GUI thread
+        const int percent = total > 0 ? static_cast<int>(std::min<qint64>(100, done * 100 / total)) : 0;
+        if (percent != m_percent) {
+            m_percent = percent;
+            emit this->progress(percent);
+        }
+    };
+    const bool ok = m_work(progress);
+    emit finished(ok, !ok && m_cancel);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CsvExporter.hpp"
+#include <QObject>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// Runs one save (CSV or Arrow) or import of records on a background thread,
+// so the window stays responsive with large sessions. Signals arrive queued
+// on the thread that owns the job; cancel() stops the work at the next
+// checkpoint, and a cancelled save leaves the target file untouched.
+class RecordsJob : public QObject {
+    Q_OBJECT
+
+public:
+    using Work = std::function<bool(const CsvExporter::Progress&)>;
+
+    explicit RecordsJob(Work work, QObject* parent = nullptr);
+    ~RecordsJob() override;
+
+    void start();
+    void cancel();
+
+signals:
+    void progress(int percent);
+    void finished(bool ok, bool cancelled);
+
+private:
+    void run();
+
+    Work m_work;
+    std::thread m_thread;
+    std::atomic<bool> m_cancel;
+    int m_percent; // Last reported, touched by the worker thread only
+};
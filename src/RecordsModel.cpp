@@ -0,0 +1,329 @@
+#include "RecordsModel.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const char* const kHeaders[RecordsModel::COLUMN_COUNT] = {"Time", "Behavior", "Type", ""};
+
+QString behaviorText(const RecordStore::Row& record) {
+    return record.parentBehaviour() + " / " + record.behaviour();
+}
+
+// Remove value from an ascending list and shift the numbers after it down
+void renumber(std::vector<int>& list, int value) {
+    list.erase(std::remove(list.begin(), list.end(), value), list.end());
+    for (int& item : list) {
+        if (item > value) --item;
+    }
+}
+
+} // namespace
+
+bool RecordsModel::Filter::isEmpty() const {
+    return behavior.isEmpty() && tag.isEmpty() && from <= 0.0
+        && to == std::numeric_limits<double>::infinity();
+}
+
+RecordsModel::RecordsModel(const RecordStore::Vocabulary& vocabulary, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_store(vocabulary)
+    , m_sortColumn(TimeColumn)
+    , m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+int RecordsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int RecordsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant RecordsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) return QVariant();
+
+    const RecordStore::Row r = m_store.at(m_rows[index.row()]);
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case TimeColumn: {
+            QString time = BehaviorRecord::formatTime(r.startTime());
+            if (auto end = r.endTime()) time += " - " + BehaviorRecord::formatTime(*end);
+            return time;
+        }
+        case BehaviorColumn:
+            return behaviorText(r);
+        case TypeColumn:
+            return r.recordType();
+        default:
+            return QVariant();
+        }
+    }
+    if (role == Qt::ToolTipRole) {
+        // Only built when the user hovers the row
+        return index.column() == DeleteColumn ? QStringLiteral("Delete record") : r.toRecord().asDisplayString();
+    }
+    return QVariant();
+}
+
+QVariant RecordsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < COLUMN_COUNT) {
+        return QString::fromUtf8(kHeaders[section]);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void RecordsModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= COLUMN_COUNT) return;
+    if (column == m_sortColumn && order == m_sortOrder) return;
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    // Keep selection and current row on the same records
+    const QModelIndexList persistent = persistentIndexList();
+    std::vector<int> persistentRecords;
+    persistentRecords.reserve(persistent.size());
+    for (const QModelIndex& index : persistent) {
+        persistentRecords.push_back(m_rows[index.row()]);
+    }
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    std::sort(m_rows.begin(), m_rows.end(), [this](int a, int b) { return rowLessThan(a, b); });
+
+    std::vector<int> rowOf(m_store.size(), -1);
+    for (size_t row = 0; row < m_rows.size(); ++row) {
+        rowOf[m_rows[row]] = static_cast<int>(row);
+    }
+    QModelIndexList moved;
+    moved.reserve(persistent.size());
+    for (int i = 0; i < persistent.size(); ++i) {
+        moved.append(index(rowOf[persistentRecords[i]], persistent[i].column()));
+    }
+    changePersistentIndexList(persistent, moved);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void RecordsModel::append(const BehaviorRecord& record) {
+    const bool newBehavior = addRecord(record);
+    const int number = m_store.size() - 1;
+
+    // Labels usually come in time order, making this a push_back
+    const std::vector<double>& starts = m_store.startTimes();
+    auto start = std::upper_bound(m_byStart.begin(), m_byStart.end(), number, [&starts](int a, int b) {
+        return starts[a] < starts[b];
+    });
+    m_byStart.insert(start, number);
+
+    if (matches(number)) {
+        const int row = insertPosition(number);
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(m_rows.begin() + row, number);
+        endInsertRows();
+    }
+
+    if (newBehavior) emit behaviorsChanged();
+}
+
+void RecordsModel::append(const std::vector<BehaviorRecord>& records) {
+    if (records.empty()) return;
+
+    beginResetModel();
+    m_store.reserve(m_store.size() + static_cast<int>(records.size()));
+    for (const BehaviorRecord& record : records) {
+        addRecord(record);
+        m_byStart.push_back(m_store.size() - 1);
+    }
+    const std::vector<double>& starts = m_store.startTimes();
+    std::stable_sort(m_byStart.begin(), m_byStart.end(), [&starts](int a, int b) { return starts[a] < starts[b]; });
+    rebuildRows();
+    endResetModel();
+    emit behaviorsChanged();
+}
+
+void RecordsModel::append(const RecordStore& records) {
+    if (records.isEmpty()) return;
+
+    beginResetModel();
+    const int first = m_store.size();
+    m_store.append(records);
+
+    // Lower-cased once per distinct tag
+    const StringDictionary& tags = m_store.dictionary(RecordStore::Field::Tag);
+    std::vector<QString> lowerTags(tags.size());
+    for (int code = 0; code < tags.size(); ++code) lowerTags[code] = tags.value(static_cast<uint32_t>(code)).toLower();
+
+    const PackedColumn& behaviours = m_store.codes(RecordStore::Field::Behaviour);
+    const PackedColumn& tagCodes = m_store.codes(RecordStore::Field::Tag);
+    for (int number = first; number < m_store.size(); ++number) {
+        m_byBehavior[behaviours[number]].push_back(number);
+        m_byTag[lowerTags[tagCodes[number]]].push_back(number);
+        m_byStart.push_back(number);
+    }
+    const std::vector<double>& starts = m_store.startTimes();
+    std::stable_sort(m_byStart.begin(), m_byStart.end(), [&starts](int a, int b) { return starts[a] < starts[b]; });
+    rebuildRows();
+    endResetModel();
+    emit behaviorsChanged();
+}
+
+bool RecordsModel::removeRows(int row, int count, const QModelIndex& parent) {
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > static_cast<int>(m_rows.size())) {
+        return false;
+    }
+
+    std::vector<int> removed(m_rows.begin() + row, m_rows.begin() + row + count);
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    m_rows.erase(m_rows.begin() + row, m_rows.begin() + row + count);
+
+    // Highest first, so the numbers still to remove stay valid
+    std::sort(removed.rbegin(), removed.rend());
+    const int behaviorCount = m_byBehavior.size();
+    for (int number : removed) {
+        unindex(number);
+        m_store.remove(number);
+    }
+    endRemoveRows();
+
+    if (m_byBehavior.size() != behaviorCount) emit behaviorsChanged();
+    return true;
+}
+
+void RecordsModel::clear() {
+    beginResetModel();
+    m_store.clear();
+    m_rows.clear();
+    m_byBehavior.clear();
+    m_byTag.clear();
+    m_byStart.clear();
+    endResetModel();
+    emit behaviorsChanged();
+}
+
+void RecordsModel::setFilter(const Filter& filter) {
+    beginResetModel();
+    m_filter = filter;
+    m_filter.tag = filter.tag.trimmed().toLower();
+    m_behaviorCode.reset();
+    if (!filter.behavior.isEmpty()) {
+        m_behaviorCode = m_store.dictionary(RecordStore::Field::Behaviour).find(filter.behavior);
+    }
+    rebuildRows();
+    endResetModel();
+}
+
+QStringList RecordsModel::behaviors() const {
+    const StringDictionary& dictionary = m_store.dictionary(RecordStore::Field::Behaviour);
+    QStringList names;
+    for (auto it = m_byBehavior.cbegin(); it != m_byBehavior.cend(); ++it) {
+        names.append(dictionary.value(it.key()));
+    }
+    names.sort(Qt::CaseInsensitive);
+    return names;
+}
+
+bool RecordsModel::addRecord(const BehaviorRecord& record) {
+    const int number = m_store.size();
+    m_store.append(record);
+
+    std::vector<int>& sameBehavior = m_byBehavior[m_store.codes(RecordStore::Field::Behaviour)[number]];
+    const bool newBehavior = sameBehavior.empty();
+    sameBehavior.push_back(number);
+    m_byTag[record.tag.toLower()].push_back(number);
+    return newBehavior;
+}
+
+bool RecordsModel::lessThan(int a, int b) const {
+    const RecordStore::Row ra = m_store.at(a);
+    const RecordStore::Row rb = m_store.at(b);
+    int order = 0;
+    switch (m_sortColumn) {
+    case TimeColumn:
+        order = ra.startTime() < rb.startTime() ? -1 : (rb.startTime() < ra.startTime() ? 1 : 0);
+        break;
+    case BehaviorColumn:
+        order = ra.parentBehaviour().compare(rb.parentBehaviour(), Qt::CaseInsensitive);
+        if (order == 0) order = ra.behaviour().compare(rb.behaviour(), Qt::CaseInsensitive);
+        break;
+    case TypeColumn:
+        order = ra.recordType().compare(rb.recordType());
+        break;
+    default:
+        break;
+    }
+    return order != 0 ? order < 0 : a < b;
+}
+
+bool RecordsModel::rowLessThan(int a, int b) const {
+    return m_sortOrder == Qt::AscendingOrder ? lessThan(a, b) : lessThan(b, a);
+}
+
+bool RecordsModel::matches(int record) const {
+    const RecordStore::Row r = m_store.at(record);
+    if (m_behaviorCode && r.code(RecordStore::Field::Behaviour) != *m_behaviorCode) return false;
+    if (!m_filter.tag.isEmpty() && r.tag().toLower() != m_filter.tag) return false;
+    return r.startTime() >= m_filter.from && r.startTime() <= m_filter.to;
+}
+
+int RecordsModel::insertPosition(int record) const {
+    auto it = std::upper_bound(m_rows.begin(), m_rows.end(), record,
+                               [this](int a, int b) { return rowLessThan(a, b); });
+    return static_cast<int>(it - m_rows.begin());
+}
+
+void RecordsModel::unindex(int record) {
+    const RecordStore::Row r = m_store.at(record);
+    auto behavior = m_byBehavior.find(r.code(RecordStore::Field::Behaviour));
+    if (behavior != m_byBehavior.end()) {
+        behavior->erase(std::find(behavior->begin(), behavior->end(), record));
+        if (behavior->empty()) m_byBehavior.erase(behavior);
+    }
+    auto tag = m_byTag.find(r.tag().toLower());
+    if (tag != m_byTag.end()) {
+        tag->erase(std::find(tag->begin(), tag->end(), record));
+        if (tag->empty()) m_byTag.erase(tag);
+    }
+
+    for (auto it = m_byBehavior.begin(); it != m_byBehavior.end(); ++it) {
+        renumber(*it, record);
+    }
+    for (auto it = m_byTag.begin(); it != m_byTag.end(); ++it) {
+        renumber(*it, record);
+    }
+    renumber(m_byStart, record);
+    renumber(m_rows, record);
+}
+
+void RecordsModel::rebuildRows() {
+    // Narrow down with the most selective index, then check the rest
+    std::vector<int> candidates;
+    bool timeOrdered = false;
+    if (m_behaviorCode) {
+        if (*m_behaviorCode >= 0) candidates = m_byBehavior.value(static_cast<uint32_t>(*m_behaviorCode));
+    } else if (!m_filter.tag.isEmpty()) {
+        candidates = m_byTag.value(m_filter.tag);
+    } else {
+        const std::vector<double>& starts = m_store.startTimes();
+        auto first = std::lower_bound(m_byStart.begin(), m_byStart.end(), m_filter.from,
+                                      [&starts](int record, double time) { return starts[record] < time; });
+        auto last = std::upper_bound(first, m_byStart.end(), m_filter.to,
+                                     [&starts](double time, int record) { return time < starts[record]; });
+        candidates.assign(first, last);
+        timeOrdered = true;
+    }
+
+    m_rows.clear();
+    m_rows.reserve(candidates.size());
+    for (int record : candidates) {
+        if (matches(record)) m_rows.push_back(record);
+    }
+
+    if (timeOrdered && m_sortColumn == TimeColumn) {
+        // m_byStart breaks ties by labeling order, like lessThan()
+        if (m_sortOrder == Qt::DescendingOrder) std::reverse(m_rows.begin(), m_rows.end());
+    } else {
+        std::sort(m_rows.begin(), m_rows.end(), [this](int a, int b) { return rowLessThan(a, b); });
+    }
+}
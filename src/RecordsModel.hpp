@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QStringList>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "RecordStore.hpp"
+
+// The labeled records of the current video, shown by the records dock.
+// Records are kept in a RecordStore in labeling order (the order they are
+// exported in); the rows are a sorted and filtered view of them. Appending
+// a record updates the indexes and inserts one row, so labeling costs the
+// same with 10 or 100k records. Display text and tooltips are built only
+// for visible rows.
+//
+// Filters use indexes: records by behavior, by tag and by start time.
+// Deleting a record renumbers the indexes, which is linear but only happens
+// on a user click.
+class RecordsModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { TimeColumn, BehaviorColumn, TypeColumn, DeleteColumn, COLUMN_COUNT };
+
+    struct Filter {
+        QString behavior;   // Exact behavior name, empty for all
+        QString tag;        // Case-insensitive, empty for all
+        double from = 0.0;  // Start time range in seconds
+        double to = std::numeric_limits<double>::infinity();
+
+        bool isEmpty() const;
+    };
+
+    explicit RecordsModel(const RecordStore::Vocabulary& vocabulary, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // All records in labeling order, regardless of the filter
+    const RecordStore& records() const { return m_store; }
+    bool isEmpty() const { return m_store.isEmpty(); }
+
+    void append(const BehaviorRecord& record);
+    // Many records at once (a restored session): one reset instead of a row each
+    void append(const std::vector<BehaviorRecord>& records);
+    // Records loaded elsewhere (an import), also with one reset
+    void append(const RecordStore& records);
+    // Position in labeling order of the record shown in row
+    int recordIndex(int row) const { return m_rows[row]; }
+    // Rows of the view, not positions in labeling order
+    bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+    void clear();
+
+    void setFilter(const Filter& filter);
+    const Filter& filter() const { return m_filter; }
+    // Behaviors with at least one record, sorted
+    QStringList behaviors() const;
+
+signals:
+    void behaviorsChanged();
+
+private:
+    // Order of the view; ties keep labeling order
+    bool lessThan(int a, int b) const;
+    bool rowLessThan(int a, int b) const; // Honors m_sortOrder
+    bool matches(int record) const;
+    int insertPosition(int record) const;
+    // Adds the record to m_store and the behavior and tag indexes; true if
+    // its behavior is new
+    bool addRecord(const BehaviorRecord& record);
+    // Drop a record from the indexes and renumber the ones after it
+    void unindex(int record);
+    void rebuildRows();
+
+    RecordStore m_store;
+    std::vector<int> m_rows;                        // Record of each view row
+    QHash<uint32_t, std::vector<int>> m_byBehavior; // Ascending record numbers
+    QHash<QString, std::vector<int>> m_byTag;       // Keyed by lower-case tag
+    std::vector<int> m_byStart;                     // Records by start time
+    Filter m_filter;
+    std::optional<int> m_behaviorCode;              // Code wanted by the filter
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+};
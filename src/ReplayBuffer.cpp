@@ -0,0 +1,149 @@
+#include "ReplayBuffer.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+
+ReplayBuffer::ReplayBuffer(double seconds)
+    : m_seconds(seconds)
+    , m_totalDelay(0.0)
+    , m_bytes(0)
+    , m_nextSerial(1)
+    , m_firstSerial(1)
+    , m_stop(false)
+{
+    m_thread = std::thread(&ReplayBuffer::encodeLoop, this);
+}
+
+ReplayBuffer::~ReplayBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_pendingChanged.notify_all();
+    m_thread.join();
+}
+
+quint64 ReplayBuffer::record(const VideoFrame& frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    quint64 serial = m_nextSerial++;
+    if (frame.image.isNull()) return serial;
+    
+    // The pixels are shared with the display, not copied
+    if (m_pending.size() >= MAX_PENDING) {
+        m_pending.pop_front();
+    }
+    m_pending.emplace_back(serial, frame);
+    m_pendingChanged.notify_one();
+    return serial;
+}
+
+void ReplayBuffer::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.clear();
+    m_frames.clear();
+    m_firstSerial = m_nextSerial;
+    m_totalDelay = 0.0;
+    m_bytes = 0;
+}
+
+std::vector<ReplayBuffer::Frame> ReplayBuffer::lastSeconds(double seconds) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto first = m_frames.end();
+    double total = 0.0;
+    while (first != m_frames.begin() && total < seconds) {
+        --first;
+        total += first->delay;
+    }
+    return std::vector<Frame>(first, m_frames.end());
+}
+
+std::vector<ReplayBuffer::Frame> ReplayBuffer::range(quint64 first, quint64 last) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Frame> frames;
+    for (const Frame& frame : m_frames) {
+        if (frame.serial >= first && frame.serial <= last) {
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+qint64 ReplayBuffer::bytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+VideoFrame ReplayBuffer::decode(const Frame& frame) {
+    VideoFrame decoded;
+    decoded.sourceRect = frame.sourceRect;
+    decoded.pts = frame.pts;
+    decoded.frameNumber = frame.frameNumber;
+    
+    cv::Mat encoded(1, static_cast<int>(frame.jpeg.size()), CV_8U, const_cast<char*>(frame.jpeg.constData()));
+    cv::Mat bgr = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (bgr.empty()) return decoded;
+    
+    QImage image(bgr.cols, bgr.rows, QImage::Format_RGB32);
+    cv::Mat target(bgr.rows, bgr.cols, CV_8UC4, image.bits(), static_cast<size_t>(image.bytesPerLine()));
+    cv::cvtColor(bgr, target, cv::COLOR_BGR2BGRA);
+    decoded.image = image;
+    return decoded;
+}
+
+void ReplayBuffer::encodeLoop() {
+    cv::Mat small;
+    cv::Mat bgr;
+    std::vector<uchar> encoded;
+    
+    while (true) {
+        std::pair<quint64, VideoFrame> pending;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pendingChanged.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+            if (m_stop) return;
+            pending = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+        
+        // Format_RGB32 is BGRA in memory; wrap it without copying
+        const QImage& image = pending.second.image;
+        cv::Mat source(image.height(), image.width(), CV_8UC4,
+                       const_cast<uchar*>(image.constBits()), static_cast<size_t>(image.bytesPerLine()));
+        if (source.cols > MAX_WIDTH) {
+            int height = std::max(1, source.rows * MAX_WIDTH / source.cols);
+            cv::resize(source, small, cv::Size(MAX_WIDTH, height), 0, 0, cv::INTER_AREA);
+            cv::cvtColor(small, bgr, cv::COLOR_BGRA2BGR);
+        } else {
+            cv::cvtColor(source, bgr, cv::COLOR_BGRA2BGR);
+        }
+        if (!cv::imencode(".jpg", bgr, encoded, {cv::IMWRITE_JPEG_QUALITY, JPEG_QUALITY})) continue;
+        
+        Frame frame;
+        frame.jpeg = QByteArray(reinterpret_cast<const char*>(encoded.data()), static_cast<qsizetype>(encoded.size()));
+        frame.sourceRect = pending.second.sourceRect;
+        frame.pts = pending.second.pts;
+        frame.frameNumber = pending.second.frameNumber;
+        frame.serial = pending.first;
+        pending.second = VideoFrame(); // Give the pixels back to the pool
+        
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (frame.serial < m_firstSerial) continue; // Cleared while encoding
+        
+        // Replay at normal speed: media time between frames, either way for
+        // reverse playback, with pauses and seeks shortened to a brief hold
+        double gap = m_frames.empty() ? 0.0 : std::abs(frame.pts - m_frames.back().pts);
+        frame.delay = gap > 0.0 ? std::min(gap, MAX_DELAY) : (m_frames.empty() ? 0.0 : MAX_DELAY);
+        
+        m_totalDelay += frame.delay;
+        m_bytes += frame.jpeg.size();
+        m_frames.push_back(std::move(frame));
+        
+        // Keep only the last m_seconds of playback
+        while (m_frames.size() > 1 && m_totalDelay - m_frames.front().delay >= m_seconds) {
+            m_totalDelay -= m_frames.front().delay;
+            m_bytes -= m_frames.front().jpeg.size();
+            m_frames.pop_front();
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VideoFrame.hpp"
+
+// Rolling record of the last few seconds of frames shown on screen, for
+// instant replay and A-B loops that never touch the decoder.
+// Frames are JPEG-encoded at a reduced size on a background thread (tens of
+// KB each instead of MB), so recording costs the GUI nothing. If the encoder
+// falls behind, frames are skipped rather than queued.
+class ReplayBuffer {
+public:
+    struct Frame {
+        QByteArray jpeg;
+        QRect sourceRect;
+        double pts = 0.0;
+        int frameNumber = -1;
+        double delay = 0.0; // Seconds to show the previous frame before this one
+        quint64 serial = 0; // Order in which the frames were shown
+    };
+
+    explicit ReplayBuffer(double seconds);
+    ~ReplayBuffer();
+
+    // Queue a shown frame for encoding; returns its serial number
+    quint64 record(const VideoFrame& frame);
+    void clear();
+
+    // Frames covering the last seconds of playback, oldest first
+    std::vector<Frame> lastSeconds(double seconds) const;
+    // Frames with serials in [first, last], oldest first
+    std::vector<Frame> range(quint64 first, quint64 last) const;
+
+    double seconds() const { return m_seconds; }
+    qint64 bytes() const;
+
+    static VideoFrame decode(const Frame& frame);
+
+private:
+    void encodeLoop();
+
+    static constexpr int MAX_WIDTH = 1280;
+    static constexpr int JPEG_QUALITY = 85;
+    static constexpr size_t MAX_PENDING = 4;
+    static constexpr double MAX_DELAY = 0.25; // Longer gaps (pauses, seeks) replay as this
+
+    double m_seconds;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingChanged;
+    std::deque<std::pair<quint64, VideoFrame>> m_pending;
+    std::deque<Frame> m_frames;
+    double m_totalDelay;
+    qint64 m_bytes;
+    quint64 m_nextSerial;
+    quint64 m_firstSerial; // Frames recorded before the last clear() are discarded
+    bool m_stop;
+    std::thread m_thread;
+};
@@ -0,0 +1,82 @@
+#include "ReplayPlayer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ReplayPlayer::ReplayPlayer(std::shared_ptr<ReplayBuffer> buffer, QObject* parent)
+    : QObject(parent)
+    , m_buffer(std::move(buffer))
+    , m_next(0)
+    , m_looping(false)
+    , m_loopFirst(0)
+    , m_loopLast(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ReplayPlayer::showNext);
+}
+
+bool ReplayPlayer::playLast(double seconds) {
+    m_looping = false;
+    return start(m_buffer->lastSeconds(seconds));
+}
+
+bool ReplayPlayer::playLoop(quint64 first, quint64 last) {
+    m_looping = true;
+    m_loopFirst = std::min(first, last);
+    m_loopLast = std::max(first, last);
+    return start(m_buffer->range(m_loopFirst, m_loopLast));
+}
+
+void ReplayPlayer::stop() {
+    if (!isPlaying()) return;
+    
+    m_timer.stop();
+    m_frames.clear();
+    m_looping = false;
+    emit finished();
+}
+
+quint64 ReplayPlayer::currentSerial() const {
+    if (m_frames.empty() || m_next == 0) return 0;
+    return m_frames[m_next - 1].serial;
+}
+
+bool ReplayPlayer::start(std::vector<ReplayBuffer::Frame> frames) {
+    m_timer.stop();
+    m_frames = std::move(frames);
+    m_next = 0;
+    if (m_frames.empty()) {
+        m_looping = false;
+        return false;
+    }
+    
+    showNext();
+    return true;
+}
+
+void ReplayPlayer::showNext() {
+    if (m_next >= m_frames.size()) {
+        if (!m_looping) {
+            stop();
+            return;
+        }
+        
+        // Pick up frames that finished encoding since the loop was set
+        std::vector<ReplayBuffer::Frame> frames = m_buffer->range(m_loopFirst, m_loopLast);
+        if (frames.empty()) {
+            stop();
+            return;
+        }
+        m_frames = std::move(frames);
+        m_next = 0;
+    }
+    
+    emit frameReady(ReplayBuffer::decode(m_frames[m_next]));
+    ++m_next;
+    
+    // Looping back to A gets one frame's hold instead of the original gap
+    double delay = m_next < m_frames.size() ? m_frames[m_next].delay
+                                            : (m_frames.size() > 1 ? m_frames[1].delay : 0.04);
+    m_timer.start(static_cast<int>(std::lround(delay * 1000.0)));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "ReplayBuffer.hpp"
+
+// Plays frames from a ReplayBuffer on the GUI thread, paced like the
+// original playback: an instant replay of the last seconds, or an A-B loop
+// between two shown frames. The first frame is decoded and emitted
+// immediately, so replay starts within one frame.
+class ReplayPlayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ReplayPlayer(std::shared_ptr<ReplayBuffer> buffer, QObject* parent = nullptr);
+
+    bool playLast(double seconds);
+    // Loops until stop(); first and last are serials returned by ReplayBuffer::record
+    bool playLoop(quint64 first, quint64 last);
+    void stop();
+
+    bool isPlaying() const { return !m_frames.empty(); }
+    bool isLooping() const { return m_looping; }
+    // Serial of the replay frame on screen
+    quint64 currentSerial() const;
+
+signals:
+    void frameReady(const VideoFrame& frame);
+    void finished();
+
+private slots:
+    void showNext();
+
+private:
+    bool start(std::vector<ReplayBuffer::Frame> frames);
+
+    std::shared_ptr<ReplayBuffer> m_buffer;
+    std::vector<ReplayBuffer::Frame> m_frames;
+    size_t m_next;
+    bool m_looping;
+    quint64 m_loopFirst;
+    quint64 m_loopLast;
+    QTimer m_timer;
+};
@@ -0,0 +1,472 @@
+#include "SessionJournal.hpp"
+#include "SidecarFile.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const QString kJournalSuffix = QStringLiteral(".ethojournal");
+constexpr quint32 kJournalMagic = 0x45544A4C; // "ETJL"
+constexpr quint32 kJournalVersion = 1;
+constexpr qint64 kHeaderSize = 8;
+constexpr quint32 kMaxEntryBytes = 16 * 1024 * 1024; // Anything larger is a torn length
+constexpr int kAppendChunkBytes = 1024 * 1024;       // Handed to the writer at a time by appendRecords
+
+quint32 crc32(const char* data, qsizetype size) {
+    static const auto table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xFFFFFFFFu;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Entry on disk: body size, body (type byte + payload), CRC-32 of the body
+QByteArray frame(quint8 type, const QByteArray& payload) {
+    QByteArray body;
+    body.reserve(1 + payload.size());
+    body.append(static_cast<char>(type));
+    body.append(payload);
+
+    QByteArray entry(4, Qt::Uninitialized);
+    qToLittleEndian<quint32>(static_cast<quint32>(body.size()), entry.data());
+    entry.append(body);
+    char crc[4];
+    qToLittleEndian<quint32>(crc32(body.constData(), body.size()), crc);
+    entry.append(crc, 4);
+    return entry;
+}
+
+// False at the end of the file or at the first damaged entry
+bool readEntry(QIODevice& in, quint8& type, QByteArray& payload) {
+    char size[4];
+    if (in.read(size, 4) != 4) return false;
+    const quint32 bodySize = qFromLittleEndian<quint32>(size);
+    if (bodySize == 0 || bodySize > kMaxEntryBytes) return false;
+
+    QByteArray body = in.read(bodySize);
+    char crc[4];
+    if (body.size() != static_cast<qsizetype>(bodySize) || in.read(crc, 4) != 4) return false;
+    if (qFromLittleEndian<quint32>(crc) != crc32(body.constData(), body.size())) return false;
+
+    type = static_cast<quint8>(body[0]);
+    payload = body.mid(1);
+    return true;
+}
+
+template <typename T>
+void writeOptional(QDataStream& out, const std::optional<T>& value) {
+    out << value.has_value();
+    if (value) out << *value;
+}
+
+template <typename T>
+void readOptional(QDataStream& in, std::optional<T>& value) {
+    bool present = false;
+    in >> present;
+    value.reset();
+    if (present) {
+        T v{};
+        in >> v;
+        value = v;
+    }
+}
+
+QByteArray encodeRecord(const BehaviorRecord& r) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << static_cast<qint32>(r.session) << r.role << r.behaviour << r.parentBehaviour << r.startTime;
+    writeOptional(out, r.endTime);
+    writeOptional(out, r.startFrame);
+    writeOptional(out, r.endFrame);
+    out << r.duration << r.recordType << r.tag << r.groupType << r.sex << r.observations << r.stage;
+    writeOptional(out, r.groupSize);
+    writeOptional(out, r.motherAndCalf);
+    writeOptional(out, r.calves);
+    return payload;
+}
+
+bool decodeRecord(const QByteArray& payload, BehaviorRecord& r) {
+    QDataStream in(payload);
+    qint32 session = 1;
+    in >> session >> r.role >> r.behaviour >> r.parentBehaviour >> r.startTime;
+    r.session = session;
+    readOptional(in, r.endTime);
+    readOptional(in, r.startFrame);
+    readOptional(in, r.endFrame);
+    in >> r.duration >> r.recordType >> r.tag >> r.groupType >> r.sex >> r.observations >> r.stage;
+    readOptional(in, r.groupSize);
+    readOptional(in, r.motherAndCalf);
+    readOptional(in, r.calves);
+    return in.status() == QDataStream::Ok;
+}
+
+QByteArray encodeState(const SessionJournal::ActiveState& state) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << state.parentBehaviour << state.behaviour << state.startTime;
+    writeOptional(out, state.startFrame);
+    return payload;
+}
+
+bool decodeState(const QByteArray& payload, SessionJournal::ActiveState& state) {
+    QDataStream in(payload);
+    in >> state.parentBehaviour >> state.behaviour >> state.startTime;
+    readOptional(in, state.startFrame);
+    return in.status() == QDataStream::Ok;
+}
+
+template <typename T>
+QByteArray encodeValue(T value) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << value;
+    return payload;
+}
+
+template <typename T>
+bool decodeValue(const QByteArray& payload, T& value) {
+    QDataStream in(payload);
+    in >> value;
+    return in.status() == QDataStream::Ok;
+}
+
+void syncToDisk(QFile& file) {
+    file.flush();
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+} // namespace
+
+SessionJournal::SessionJournal()
+    : m_nextId(0)
+    , m_writtenPosition(std::nan(""))
+    , m_flushRequested(0)
+    , m_flushDone(0)
+    , m_stop(false)
+{
+}
+
+SessionJournal::~SessionJournal() {
+    close();
+}
+
+bool SessionJournal::open(const QString& videoPath, Recovered& recovered) {
+    close();
+    recovered = Recovered();
+
+    // An existing journal wherever it is, else a new one next to the video
+    const QString besideVideo = SidecarFile::pathFor(videoPath, kJournalSuffix);
+    const QString inCache = SidecarFile::cachePathFor(videoPath, kJournalSuffix);
+    bool opened = false;
+    if (QFileInfo::exists(besideVideo)) {
+        opened = openFile(besideVideo);
+    } else if (QFileInfo::exists(inCache)) {
+        opened = openFile(inCache);
+    } else {
+        opened = openFile(besideVideo) || openFile(inCache);
+    }
+    if (!opened) {
+        qWarning() << "Labels of" << videoPath << "are not journaled:" << m_file.errorString();
+        return false;
+    }
+
+    // Replay, dropping a torn entry at the end
+    m_file.seek(kHeaderSize);
+    qint64 validEnd = kHeaderSize;
+    quint8 type = 0;
+    QByteArray payload;
+    while (readEntry(m_file, type, payload)) {
+        bool ok = true;
+        switch (static_cast<Entry>(type)) {
+        case Entry::Record: {
+            BehaviorRecord record;
+            ok = decodeRecord(payload, record);
+            if (ok) {
+                recovered.records.push_back(record);
+                m_liveIds.push_back(m_nextId++);
+            }
+            break;
+        }
+        case Entry::Delete: {
+            quint32 id = 0;
+            ok = decodeValue(payload, id);
+            auto it = std::lower_bound(m_liveIds.begin(), m_liveIds.end(), id);
+            if (ok && it != m_liveIds.end() && *it == id) {
+                recovered.records.erase(recovered.records.begin() + (it - m_liveIds.begin()));
+                m_liveIds.erase(it);
+            }
+            break;
+        }
+        case Entry::StateBegin: {
+            ActiveState state;
+            ok = decodeState(payload, state);
+            if (ok) recovered.activeState = state;
+            break;
+        }
+        case Entry::StateEnd:
+            recovered.activeState.reset();
+            break;
+        case Entry::Position: {
+            double position = 0.0;
+            ok = decodeValue(payload, position);
+            if (ok) recovered.position = position;
+            break;
+        }
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) break;
+        validEnd = m_file.pos();
+    }
+    if (validEnd < m_file.size()) {
+        qWarning() << "Dropping" << m_file.size() - validEnd << "damaged bytes at the end of" << m_file.fileName();
+        m_file.resize(validEnd);
+    }
+    m_file.seek(validEnd);
+
+    m_activeState = recovered.activeState;
+    if (recovered.position) m_writtenPosition = *recovered.position;
+    startWriter();
+    return true;
+}
+
+void SessionJournal::close() {
+    if (!isOpen()) return;
+    stopWriter();
+    m_file.close();
+    m_liveIds.clear();
+    m_nextId = 0;
+    m_activeState.reset();
+    m_position.reset();
+    m_writtenPosition = std::nan("");
+}
+
+void SessionJournal::appendRecord(const BehaviorRecord& record) {
+    if (!isOpen()) return;
+    m_liveIds.push_back(m_nextId++);
+    append(Entry::Record, encodeRecord(record));
+}
+
+void SessionJournal::appendRecords(const RecordStore& records) {
+    if (!isOpen() || records.isEmpty()) return;
+    m_liveIds.reserve(m_liveIds.size() + records.size());
+    // Handed over in chunks so the writer starts while the rest is encoded
+    QByteArray entries;
+    for (const RecordStore::Row& row : records) {
+        m_liveIds.push_back(m_nextId++);
+        entries.append(frame(static_cast<quint8>(Entry::Record), encodeRecord(row.toRecord())));
+        if (entries.size() >= kAppendChunkBytes) {
+            appendFramed(entries);
+            entries.clear();
+        }
+    }
+    if (!entries.isEmpty()) appendFramed(entries);
+}
+
+void SessionJournal::deleteRecord(int index) {
+    if (!isOpen() || index < 0 || index >= static_cast<int>(m_liveIds.size())) return;
+    const quint32 id = m_liveIds[index];
+    m_liveIds.erase(m_liveIds.begin() + index);
+    append(Entry::Delete, encodeValue(id));
+}
+
+void SessionJournal::beginState(const ActiveState& state) {
+    if (!isOpen()) return;
+    m_activeState = state;
+    append(Entry::StateBegin, encodeState(state));
+}
+
+void SessionJournal::endState() {
+    if (!isOpen()) return;
+    m_activeState.reset();
+    append(Entry::StateEnd, QByteArray());
+}
+
+void SessionJournal::setPosition(double seconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_position = seconds;
+}
+
+SessionJournal::Snapshot SessionJournal::snapshot() {
+    flush();
+    return {m_file.fileName(), m_liveIds};
+}
+
+bool SessionJournal::exportCsv(const Snapshot& snapshot, const QString& csvPath,
+                               const CsvExporter::Progress& progress) {
+    // Single pass over the journal: ids and liveIds both ascend. Entries
+    // appended after the snapshot are never reached.
+    QFile in(snapshot.path);
+    if (!in.open(QIODevice::ReadOnly) || !in.seek(kHeaderSize)) return false;
+    const std::vector<quint32>& liveIds = snapshot.liveIds;
+    quint32 id = 0;
+    size_t live = 0;
+    auto next = [&](BehaviorRecord& record) {
+        quint8 type = 0;
+        QByteArray payload;
+        while (live < liveIds.size() && readEntry(in, type, payload)) {
+            if (static_cast<Entry>(type) != Entry::Record) continue;
+            if (id++ != liveIds[live]) continue;
+            ++live;
+            return decodeRecord(payload, record);
+        }
+        return false;
+    };
+    return CsvExporter::exportRecords(csvPath, next, static_cast<qint64>(liveIds.size()), progress)
+        && live == liveIds.size();
+}
+
+void SessionJournal::clearRecords() {
+    if (!isOpen()) return;
+    stopWriter();
+    m_file.resize(kHeaderSize);
+    m_file.seek(kHeaderSize);
+    syncToDisk(m_file);
+    m_liveIds.clear();
+    m_nextId = 0;
+    m_writtenPosition = std::nan("");
+    startWriter();
+    if (m_activeState) append(Entry::StateBegin, encodeState(*m_activeState));
+}
+
+bool SessionJournal::openFile(const QString& path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) return false;
+
+    if (m_file.size() >= kHeaderSize) {
+        char header[kHeaderSize];
+        m_file.read(header, kHeaderSize);
+        if (qFromLittleEndian<quint32>(header) == kJournalMagic
+            && qFromLittleEndian<quint32>(header + 4) == kJournalVersion) {
+            return true;
+        }
+        // Not ours or from another version: keep it aside rather than lose it
+        m_file.close();
+        QFile::remove(path + ".old");
+        QFile::rename(path, path + ".old");
+        qWarning() << "Unreadable journal moved to" << path + ".old";
+        if (!m_file.open(QIODevice::ReadWrite)) return false;
+    }
+    m_file.resize(0);
+    writeHeader();
+    return true;
+}
+
+void SessionJournal::writeHeader() {
+    char header[kHeaderSize];
+    qToLittleEndian<quint32>(kJournalMagic, header);
+    qToLittleEndian<quint32>(kJournalVersion, header + 4);
+    m_file.seek(0);
+    m_file.write(header, kHeaderSize);
+    syncToDisk(m_file);
+}
+
+void SessionJournal::append(Entry type, const QByteArray& payload) {
+    appendFramed(frame(static_cast<quint8>(type), payload));
+}
+
+void SessionJournal::appendFramed(const QByteArray& entries) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.append(entries);
+    }
+    m_wake.notify_one();
+}
+
+void SessionJournal::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_writer.joinable()) return;
+    const quint64 ticket = ++m_flushRequested;
+    m_wake.notify_one();
+    m_flushed.wait(lock, [this, ticket] { return m_flushDone >= ticket; });
+}
+
+void SessionJournal::startWriter() {
+    m_stop = false;
+    m_writer = std::thread(&SessionJournal::writerLoop, this);
+}
+
+void SessionJournal::stopWriter() {
+    if (!m_writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_writer.join();
+}
+
+void SessionJournal::writerLoop() {
+    // Each write is flushed from QFile's buffer to the OS right away (safe
+    // from an app crash); the sync to storage (safe from power loss) is
+    // batched
+    Clock::time_point lastSync = Clock::now();
+    Clock::time_point lastPosition;
+    bool unsynced = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        if (m_pending.isEmpty() && !m_stop && m_flushRequested == m_flushDone) {
+            m_wake.wait_until(lock, unsynced ? lastSync + SYNC_INTERVAL : Clock::now() + POSITION_INTERVAL);
+        }
+        const bool stopping = m_stop;
+        const quint64 ticket = m_flushRequested;
+        const bool flushing = ticket != m_flushDone;
+        const Clock::time_point now = Clock::now();
+
+        if (m_position && *m_position != m_writtenPosition
+            && (stopping || flushing || now - lastPosition >= POSITION_INTERVAL)) {
+            m_pending.append(frame(static_cast<quint8>(Entry::Position), encodeValue(*m_position)));
+            m_writtenPosition = *m_position;
+            lastPosition = now;
+        }
+        QByteArray data;
+        data.swap(m_pending);
+        lock.unlock();
+
+        if (!data.isEmpty()) {
+            if (m_file.write(data) != data.size() || !m_file.flush()) {
+                qWarning() << "Cannot write journal" << m_file.fileName() << m_file.errorString();
+            }
+            unsynced = true;
+        }
+        if (unsynced && (stopping || flushing || Clock::now() - lastSync >= SYNC_INTERVAL)) {
+            syncToDisk(m_file);
+            unsynced = false;
+            lastSync = Clock::now();
+        }
+
+        lock.lock();
+        if (flushing) {
+            m_flushDone = ticket;
+            m_flushed.notify_all();
+        }
+        if (stopping && m_pending.isEmpty()) break;
+    }
+}
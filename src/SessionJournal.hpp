@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "BehaviorRecord.hpp"
+#include "CsvExporter.hpp"
+#include "RecordStore.hpp"
+
+// Append-only log of the labeling done on one video, so nothing is lost to a
+// crash or to switching videos before saving. Every change (record added or
+// deleted, state started or ended, playhead moved) is one checksummed entry.
+// Entries are handed to a writer thread and synced to disk in batches, so
+// labeling never waits for storage.
+//
+// Opening the journal replays it: records, the active state and the last
+// position come back as they were. A torn entry at the end (crash during a
+// write) is dropped. Saving streams the live records from the journal into
+// the CSV file, then starts the journal afresh.
+//
+// The journal lives next to the video as "<video>.ethojournal", or in the
+// cache directory when the video's folder is read-only.
+class SessionJournal {
+public:
+    struct ActiveState {
+        QString parentBehaviour;
+        QString behaviour;
+        double startTime = 0.0;
+        std::optional<int> startFrame;
+    };
+
+    // What exportCsv() needs to read the journal on another thread
+    struct Snapshot {
+        QString path;
+        std::vector<quint32> liveIds;
+    };
+
+    struct Recovered {
+        std::vector<BehaviorRecord> records; // Labeling order, deleted ones left out
+        std::optional<ActiveState> activeState;
+        std::optional<double> position;
+    };
+
+    SessionJournal();
+    ~SessionJournal();
+
+    // Close the previous journal (writing everything out) and open the
+    // video's one, filling in what it holds
+    bool open(const QString& videoPath, Recovered& recovered);
+    void close();
+    bool isOpen() const { return m_writer.joinable(); }
+    QString path() const { return m_file.fileName(); }
+
+    void appendRecord(const BehaviorRecord& record);
+    // Many records at once (e.g. an import), encoded on the calling thread.
+    // May run on a RecordsJob thread as long as nothing else changes the
+    // journal meanwhile; only setPosition() is safe alongside it.
+    void appendRecords(const RecordStore& records);
+    // Index among the live records, in labeling order
+    void deleteRecord(int index);
+    void beginState(const ActiveState& state);
+    void endState();
+    // Cheap to call for every frame; only the latest position is written,
+    // at most every few seconds
+    void setPosition(double seconds);
+
+    // Saving: take a snapshot (everything logged so far is written out),
+    // stream its records into a CSV file on any thread, and once that
+    // succeeded start over with only the active state and position
+    Snapshot snapshot();
+    static bool exportCsv(const Snapshot& snapshot, const QString& csvPath,
+                          const CsvExporter::Progress& progress = CsvExporter::Progress());
+    void clearRecords();
+
+private:
+    enum class Entry : quint8 { Record = 1, Delete = 2, StateBegin = 3, StateEnd = 4, Position = 5 };
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr auto SYNC_INTERVAL = std::chrono::milliseconds(250);
+    static constexpr auto POSITION_INTERVAL = std::chrono::seconds(2);
+
+    bool openFile(const QString& path);
+    void append(Entry type, const QByteArray& payload);
+    void appendFramed(const QByteArray& entries);
+    void writeHeader();
+    void flush();
+    void startWriter();
+    void stopWriter();
+    void writerLoop();
+
+    QFile m_file;                    // Written by the writer thread only
+    std::vector<quint32> m_liveIds;  // Journal id of each live record
+    quint32 m_nextId;
+    std::optional<ActiveState> m_activeState;
+
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    QByteArray m_pending;            // Entries not yet handed to the file
+    std::optional<double> m_position;
+    double m_writtenPosition;
+    quint64 m_flushRequested;
+    quint64 m_flushDone;
+    bool m_stop;
+};
@@ -0,0 +1,41 @@
+#include "SidecarFile.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+QString SidecarFile::pathFor(const QString& videoPath, const QString& suffix) {
+    return videoPath + suffix;
+}
+
+QString SidecarFile::cachePathFor(const QString& videoPath, const QString& suffix) {
+    QString absolute = QFileInfo(videoPath).absoluteFilePath();
+    QByteArray hash = QCryptographicHash::hash(absolute.toUtf8(), QCryptographicHash::Sha1).toHex();
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/sidecars";
+    QDir().mkpath(dir);
+    return QDir(dir).filePath(QString::fromLatin1(hash) + suffix);
+}
+
+void SidecarFile::writeStamp(QDataStream& out, quint32 magic, quint32 version, const QString& videoPath) {
+    QFileInfo videoInfo(videoPath);
+    out << magic << version
+        << static_cast<qint64>(videoInfo.size())
+        << static_cast<qint64>(videoInfo.lastModified().toMSecsSinceEpoch());
+}
+
+bool SidecarFile::checkStamp(QDataStream& in, quint32 magic, quint32 version, const QString& videoPath) {
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    qint64 videoSize = 0;
+    qint64 videoModified = 0;
+    in >> fileMagic >> fileVersion >> videoSize >> videoModified;
+    
+    // Stale if the video was replaced or re-encoded since the cache was written
+    QFileInfo videoInfo(videoPath);
+    return in.status() == QDataStream::Ok
+        && fileMagic == magic && fileVersion == version
+        && videoSize == videoInfo.size()
+        && videoModified == videoInfo.lastModified().toMSecsSinceEpoch();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QDataStream>
+#include <QString>
+
+// Per-video cache files (frame index, thumbnails, ...).
+// They live next to the video as "<video><suffix>", or in the user cache
+// directory when the video's folder is not writable. Every file starts with
+// a stamp of the video's size and modification time so stale caches are
+// ignored after the video is replaced.
+class SidecarFile {
+public:
+    static QString pathFor(const QString& videoPath, const QString& suffix);
+    static QString cachePathFor(const QString& videoPath, const QString& suffix);
+
+    static void writeStamp(QDataStream& out, quint32 magic, quint32 version, const QString& videoPath);
+    static bool checkStamp(QDataStream& in, quint32 magic, quint32 version, const QString& videoPath);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity, wait-free single-producer/single-consumer ring.
+// Slots are allocated once up front and reused in place: the producer fills
+// the slot returned by acquireWrite() and publishes it with commitWrite(),
+// the consumer reads peek() and releases it with pop(). Every operation is a
+// bounded number of atomic loads/stores, so neither side can block the other.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity)
+        : m_slots(capacity > 0 ? capacity : 1)
+        , m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return m_slots.size(); }
+
+    // Number of published slots (exact for the consumer, a lower bound for the producer)
+    std::size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+    // Producer side: next free slot, or nullptr when the ring is full
+    T* acquireWrite() {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= m_slots.size()) {
+            return nullptr;
+        }
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    void commitWrite() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side: slot at offset from the front, or nullptr if not yet published
+    T* peek(std::size_t offset = 0) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_tail.load(std::memory_order_acquire) - head <= offset) {
+            return nullptr;
+        }
+        return &m_slots[(head + offset) % m_slots.size()];
+    }
+
+    void pop() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::vector<T> m_slots;
+    // Keep the indices on separate cache lines to avoid false sharing
+    alignas(kCacheLine) std::atomic<std::size_t> m_head; // Consumer position
+    alignas(kCacheLine) std::atomic<std::size_t> m_tail; // Producer position
+};
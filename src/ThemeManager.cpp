@@ -284,7 +284,7 @@ QHeaderView::section {
 }
 
 /* Table Widget */
-QTableWidget {
+QTableView {
     background-color: #FFFFFF;
     border: 1px solid #E0E0E0;
     border-radius: 6px;
@@ -293,11 +293,11 @@ QTableWidget {
     outline: none;
 }
 
-QTableWidget::item {
+QTableView::item {
     padding: 8px;
 }
 
-QTableWidget::item:selected {
+QTableView::item:selected {
     background-color: #E0F2F1;
     color: #00796B;
 }
@@ -663,7 +663,7 @@ QHeaderView::section {
 }
 
 /* Table Widget */
-QTableWidget {
+QTableView {
     background-color: #2D2D3F;
     border: 1px solid #3D3D50;
     border-radius: 6px;
@@ -672,12 +672,12 @@ QTableWidget {
     outline: none;
 }
 
-QTableWidget::item {
+QTableView::item {
     padding: 8px;
     color: #E0E0E0;
 }
 
-QTableWidget::item:selected {
+QTableView::item:selected {
     background-color: #3D3D50;
     color: #80CBC4;
 }
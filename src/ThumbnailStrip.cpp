@@ -0,0 +1,178 @@
+#include "ThumbnailStrip.hpp"
+#include "FrameIndex.hpp"
+#include "SidecarFile.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kSidecarMagic = 0x45544842; // "ETHB"
+constexpr quint32 kSidecarVersion = 1;
+const QString kSidecarSuffix = QStringLiteral(".ethothumb");
+
+constexpr int kThumbnailWidth = 160;
+constexpr int kJpegQuality = 70;
+constexpr double kMinInterval = 2.0;   // Seconds between samples
+constexpr double kMaxThumbnails = 1800; // Caps the strip at ~5 MB for long recordings
+}
+
+ThumbnailStrip::ThumbnailStrip(QString videoPath)
+    : m_videoPath(std::move(videoPath))
+    , m_stop(false)
+    , m_complete(false)
+{
+}
+
+ThumbnailStrip::~ThumbnailStrip() {
+    stop();
+}
+
+void ThumbnailStrip::start(double duration, std::shared_ptr<const FrameIndex> index) {
+    if (m_thread.joinable() || m_complete) return;
+    
+    if (load()) {
+        m_complete = true;
+        return;
+    }
+    
+    m_stop = false;
+    m_thread = std::thread(&ThumbnailStrip::buildLoop, this, duration, std::move(index));
+}
+
+void ThumbnailStrip::stop() {
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+int ThumbnailStrip::count() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_thumbnails.size());
+}
+
+QImage ThumbnailStrip::thumbnailAt(double seconds) const {
+    QByteArray jpeg;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_thumbnails.empty()) return QImage();
+        
+        auto it = std::lower_bound(m_thumbnails.begin(), m_thumbnails.end(), seconds,
+                                   [](const Thumbnail& t, double s) { return t.pts < s; });
+        if (it == m_thumbnails.end()) {
+            --it;
+        } else if (it != m_thumbnails.begin() && seconds - (it - 1)->pts < it->pts - seconds) {
+            --it;
+        }
+        jpeg = it->jpeg; // Implicitly shared, decoded outside the lock
+    }
+    
+    cv::Mat encoded(1, static_cast<int>(jpeg.size()), CV_8U, const_cast<char*>(jpeg.constData()));
+    cv::Mat decoded = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (decoded.empty()) return QImage();
+    
+    QImage image(decoded.cols, decoded.rows, QImage::Format_RGB32);
+    cv::Mat target(decoded.rows, decoded.cols, CV_8UC4, image.bits(), static_cast<size_t>(image.bytesPerLine()));
+    cv::cvtColor(decoded, target, cv::COLOR_BGR2BGRA);
+    return image;
+}
+
+void ThumbnailStrip::buildLoop(double duration, std::shared_ptr<const FrameIndex> index) {
+    cv::VideoCapture cap(m_videoPath.toStdString());
+    if (!cap.isOpened()) return;
+    
+    double interval = std::max(kMinInterval, duration / kMaxThumbnails);
+    double lastTarget = -1.0;
+    cv::Mat frame;
+    cv::Mat small;
+    std::vector<uchar> encoded;
+    
+    for (double t = 0.0; t < duration && !m_stop; t += interval) {
+        // Snap to the preceding keyframe so the sample needs no decode-forward
+        double target = t;
+        if (index && !index->isEmpty()) {
+            target = index->pts(index->keyframeAtOrBefore(index->frameAtTime(t)));
+        }
+        if (target <= lastTarget) continue; // Same GOP as the previous sample
+        lastTarget = target;
+        
+        cap.set(cv::CAP_PROP_POS_MSEC, target * 1000.0);
+        if (!cap.read(frame) || frame.empty()) continue;
+        double pts = cap.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
+        
+        int height = std::max(1, frame.rows * kThumbnailWidth / std::max(1, frame.cols));
+        cv::resize(frame, small, cv::Size(kThumbnailWidth, height), 0, 0, cv::INTER_AREA);
+        if (!cv::imencode(".jpg", small, encoded, {cv::IMWRITE_JPEG_QUALITY, kJpegQuality})) continue;
+        
+        Thumbnail thumbnail;
+        thumbnail.pts = pts;
+        thumbnail.jpeg = QByteArray(reinterpret_cast<const char*>(encoded.data()), static_cast<qsizetype>(encoded.size()));
+        
+        QMutexLocker locker(&m_mutex);
+        if (m_thumbnails.empty() || m_thumbnails.back().pts < pts) {
+            m_thumbnails.push_back(std::move(thumbnail));
+        }
+    }
+    
+    if (!m_stop) {
+        m_complete = true;
+        save();
+    }
+}
+
+bool ThumbnailStrip::load() {
+    for (const QString& path : {SidecarFile::pathFor(m_videoPath, kSidecarSuffix),
+                                SidecarFile::cachePathFor(m_videoPath, kSidecarSuffix)}) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_6_0);
+        if (!SidecarFile::checkStamp(in, kSidecarMagic, kSidecarVersion, m_videoPath)) continue;
+        
+        quint32 count = 0;
+        in >> count;
+        
+        std::vector<Thumbnail> thumbnails;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            Thumbnail thumbnail;
+            in >> thumbnail.pts >> thumbnail.jpeg;
+            thumbnails.push_back(std::move(thumbnail));
+        }
+        if (in.status() != QDataStream::Ok) continue;
+        
+        QMutexLocker locker(&m_mutex);
+        m_thumbnails = std::move(thumbnails);
+        return true;
+    }
+    return false;
+}
+
+bool ThumbnailStrip::save() const {
+    return saveTo(SidecarFile::pathFor(m_videoPath, kSidecarSuffix))
+        || saveTo(SidecarFile::cachePathFor(m_videoPath, kSidecarSuffix));
+}
+
+bool ThumbnailStrip::saveTo(const QString& path) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    SidecarFile::writeStamp(out, kSidecarMagic, kSidecarVersion, m_videoPath);
+    
+    QMutexLocker locker(&m_mutex);
+    out << static_cast<quint32>(m_thumbnails.size());
+    for (const Thumbnail& thumbnail : m_thumbnails) {
+        out << thumbnail.pts << thumbnail.jpeg;
+    }
+    locker.unlock();
+    
+    return out.status() == QDataStream::Ok && file.commit();
+}
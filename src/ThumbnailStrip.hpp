@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class FrameIndex;
+
+// Low-resolution preview frames sampled every few seconds, used to show
+// something instantly while the seek slider is dragged. Thumbnails are kept
+// JPEG-encoded in memory (a few KB each) and cached in a sidecar file; the
+// strip is filled by a background thread and is usable while it grows.
+class ThumbnailStrip {
+public:
+    explicit ThumbnailStrip(QString videoPath);
+    ~ThumbnailStrip();
+
+    // Load the cached strip, or start sampling in the background.
+    // With an index, samples snap to keyframes so each costs a single decode.
+    void start(double duration, std::shared_ptr<const FrameIndex> index);
+    void stop();
+
+    // Nearest available thumbnail to the given time (thread-safe)
+    QImage thumbnailAt(double seconds) const;
+
+    int count() const;
+    bool isComplete() const { return m_complete; }
+
+private:
+    struct Thumbnail {
+        double pts = 0.0;
+        QByteArray jpeg;
+    };
+
+    void buildLoop(double duration, std::shared_ptr<const FrameIndex> index);
+    bool load();
+    bool save() const;
+    bool saveTo(const QString& path) const;
+
+    QString m_videoPath;
+    mutable QMutex m_mutex;
+    std::vector<Thumbnail> m_thumbnails; // Sorted by pts
+    std::thread m_thread;
+    std::atomic<bool> m_stop;
+    std::atomic<bool> m_complete;
+};
@@ -0,0 +1,57 @@
+#include "VideoDecoder.hpp"
+#include "OpenCvDecoder.hpp"
+#include "YuvConverter.hpp"
+#ifdef ETHOWILD_WITH_FFMPEG
+#include "FfmpegDecoder.hpp"
+#endif
+
+std::unique_ptr<VideoDecoder> VideoDecoder::create(const QString& backend, const Options& options) {
+#ifdef ETHOWILD_WITH_FFMPEG
+    if (backend.compare("ffmpeg", Qt::CaseInsensitive) == 0) {
+        return std::make_unique<FfmpegDecoder>(options);
+    }
+#endif
+    return std::make_unique<OpenCvDecoder>(options);
+}
+
+QStringList VideoDecoder::availableBackends() {
+    QStringList backends{"opencv"};
+#ifdef ETHOWILD_WITH_FFMPEG
+    backends.append("ffmpeg");
+#endif
+    return backends;
+}
+
+QString VideoDecoder::defaultBackend() {
+#ifdef ETHOWILD_WITH_FFMPEG
+    return "ffmpeg";
+#else
+    return "opencv";
+#endif
+}
+
+bool VideoDecoder::convertYuv(const YuvFrame& frame, const DecodeRegion& region, FramePool& pool, QImage& out) {
+    const QSize frameSize(frame.width, frame.height);
+    const int factor = region.boxFactor(frameSize);
+    if (frame.isNull() || factor <= 0) return false;
+    
+    const QRect source = region.sourceRect(frameSize);
+    const QSize size = region.outputSize(frameSize);
+    QImage image = pool.acquire(size.width(), size.height(), QImage::Format_RGB32);
+    
+    YuvConverter::Request request;
+    request.frame = &frame;
+    request.x = source.x();
+    request.y = source.y();
+    request.width = source.width();
+    request.height = source.height();
+    request.factor = factor;
+    request.dst = image.bits();
+    request.dstStride = static_cast<int>(image.bytesPerLine());
+    request.dstWidth = size.width();
+    request.dstHeight = size.height();
+    if (!YuvConverter::convert(request)) return false;
+    
+    out = image;
+    return true;
+}
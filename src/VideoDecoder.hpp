@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+#include "DecodeRegion.hpp"
+#include "FramePool.hpp"
+#include "IoCounters.hpp"
+#include "YuvFrame.hpp"
+
+// Decode backend driven by VideoWorker's decoder thread.
+// Usage is seek(), then grab() to decode the next frame, then optionally
+// retrieve() it into a display buffer. Frames that are only grabbed are
+// never color converted. A decoder is used from one thread at a time.
+class VideoDecoder {
+public:
+    struct Options {
+        int threads = 0; // Decoder threads; 0 lets the backend decide
+        // Input readahead on an I/O thread (FFmpeg backend); 0 lets the
+        // demuxer read synchronously
+        int readaheadMegabytes = 32;
+        bool memoryMap = false; // Map the file instead of reading it into a buffer
+        // Simulated slow media, for benchmarks
+        double throttleMegabytesPerSecond = 0.0;
+        double throttleLatencyMs = 0.0;
+        std::shared_ptr<IoCounters> ioCounters; // Optional storage statistics
+    };
+
+    enum class Transfer {
+        Failed,
+        Copied,   // Pixels were already display-native
+        Converted // Pixels went through a color conversion
+    };
+
+    // Backend by name ("opencv" or "ffmpeg"); unknown or unavailable names
+    // fall back to OpenCV
+    static std::unique_ptr<VideoDecoder> create(const QString& backend, const Options& options = {});
+    static QStringList availableBackends();
+    static QString defaultBackend();
+
+    // Crop, box-downscale and convert a native 4:2:0 frame into a pooled
+    // Format_RGB32 image in one SIMD pass. Returns false when the region's
+    // scale is not a power of two.
+    static bool convertYuv(const YuvFrame& frame, const DecodeRegion& region, FramePool& pool, QImage& out);
+
+    virtual ~VideoDecoder() = default;
+
+    virtual QString name() const = 0;
+    virtual bool open(const QString& path) = 0;
+    virtual void close() = 0;
+    virtual bool isOpened() const = 0;
+
+    virtual double fps() const = 0;
+    virtual double duration() const = 0; // Container estimate in seconds
+    virtual QSize frameSize() const = 0;
+
+    // Reposition so the next grab() returns a frame at or before seconds
+    // (usually the preceding keyframe)
+    virtual bool seek(double seconds) = 0;
+    virtual bool grab() = 0;
+    // Presentation time of the grabbed frame in seconds, relative to the
+    // stream start (the same clock FrameIndex uses)
+    virtual double framePts() const = 0;
+
+    // Convert the grabbed frame into a pooled Format_RGB32 image. Only the
+    // region's source rect is converted, scaled to its output size.
+    virtual Transfer retrieve(FramePool& pool, QImage& out, const DecodeRegion& region = {}) = 0;
+    // Skimming: while enabled, grab() returns keyframes only and the frames
+    // in between are demuxed but never decoded. Returns false if the backend
+    // cannot skip decoding (the caller then seeks from keyframe to keyframe).
+    virtual bool setKeyframesOnly(bool enabled) { (void)enabled; return false; }
+    // The grabbed frame in its native YUV layout, without converting.
+    // Backends that only produce RGB return false.
+    virtual bool retrieveYuv(YuvFrame& frame) { (void)frame; return false; }
+};
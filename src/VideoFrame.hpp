@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QtGlobal>
+
+#include "DecodeRegion.hpp"
+#include "YuvFrame.hpp"
+
+// A decoded frame travelling from the decoder thread to the presenter.
+// Holds either display pixels (image) or, when that is smaller, the
+// decoder's native YUV planes plus the region to convert them for; the
+// presenter converts those just before showing the frame.
+struct VideoFrame {
+    QImage image;
+    YuvFrame yuv;
+    DecodeRegion region;     // Crop and scale for converting yuv
+    QRect sourceRect;        // Part of the source frame the image shows, in source pixels
+    double pts = 0.0;        // Presentation time in seconds
+    int frameNumber = -1;    // Position in presentation order (-1 if unknown)
+    quint64 generation = 0;  // Seek generation the frame was decoded for
+    
+    bool isNull() const { return image.isNull() && yuv.isNull(); }
+    
+    // Pixel memory held by this frame
+    qint64 bytes() const {
+        if (!image.isNull()) return image.sizeInBytes();
+        if (yuv.isNull()) return 0;
+        return static_cast<qint64>(yuv.strides[0]) * yuv.height * 3 / 2;
+    }
+};
@@ -1,44 +1,128 @@
 #include "VideoWorker.hpp"
+#include "Config.hpp"
 #include <QThread>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 VideoWorker::VideoWorker(QString videoPath, QObject* parent)
     : QObject(parent)
     , m_videoPath(videoPath)
+    , m_decoderBackend(Config::instance().decoderBackend())
     , m_stop(false)
     , m_paused(false)
-    , m_seeking(false)
+    , m_active(true)
+    , m_seekTarget(0.0)
+    , m_seekTargetFrame(-1)
+    , m_seekFillsGop(false)
+    , m_seekGeneration(0)
     , m_playbackSpeed(1.0)
+    , m_reverse(false)
+    , m_presentedFrame(0)
     , m_fps(30.0)
     , m_duration(0.0)
+    , m_ring(MAX_BUFFER_FRAMES)
+    , m_bufferBudget(Config::instance().bufferMegabytes() * 1024LL * 1024)
+    , m_bufferedBytes(0)
+    , m_frameBytes(0)
+    , m_frameCache(Config::instance().frameCacheMegabytes() * 1024LL * 1024)
+    , m_cacheLookups(0)
+    , m_cacheHits(0)
+    , m_cursor(-1)
+    , m_capFrame(0)
+    , m_pendingGrab(false)
+    , m_skimming(false)
+    , m_keyframesOnly(false)
+    , m_skimPts(0.0)
+    , m_viewportScale(1.0)
+    , m_viewportChanged(false)
+    , m_framePool(FramePool::create())
+    , m_framesDecoded(0)
+    , m_bytesCopied(0)
+    , m_bytesConverted(0)
+    , m_thumbnails(std::make_shared<ThumbnailStrip>(videoPath))
+    , m_mailbox(std::make_shared<FrameMailbox>())
+    , m_ioCounters(std::make_shared<IoCounters>())
 {
+    m_decoderOptions.threads = Config::instance().decoderThreads();
+    m_decoderOptions.readaheadMegabytes = Config::instance().readaheadMegabytes();
+    m_decoderOptions.memoryMap = Config::instance().memoryMap();
+    m_decoderOptions.ioCounters = m_ioCounters;
 }
 
 VideoWorker::~VideoWorker() {
     stop();
+    if (m_decodeThread.joinable()) {
+        m_decodeThread.join();
+    }
+    if (m_indexThread.joinable()) {
+        m_indexThread.join();
+    }
 }
 
 void VideoWorker::openVideo() {
-    // Convert QString to std::string for OpenCV (path encoding might be an issue on Windows, check later)
-    // On Linux it's fine.
-    m_cap.open(m_videoPath.toStdString());
+    m_decoder = VideoDecoder::create(m_decoderBackend, m_decoderOptions);
+    if (!m_decoder->open(m_videoPath) && m_decoder->name() != "opencv") {
+        qWarning() << "Decoder" << m_decoder->name() << "could not open" << m_videoPath << "- falling back to OpenCV";
+        m_decoder = VideoDecoder::create("opencv", m_decoderOptions);
+        m_decoder->open(m_videoPath);
+    }
     
-    if (m_cap.isOpened()) {
-        m_fps = m_cap.get(cv::CAP_PROP_FPS);
+    if (m_decoder->isOpened()) {
+        m_fps = m_decoder->fps();
         if (m_fps <= 0) m_fps = 30.0;
+        m_frameCache.setWindow(static_cast<int>(std::ceil(PREFETCH_SECONDS * m_fps)));
         
-        double frameCount = m_cap.get(cv::CAP_PROP_FRAME_COUNT);
-        m_duration = frameCount / m_fps;
-        int width = static_cast<int>(m_cap.get(cv::CAP_PROP_FRAME_WIDTH));
-        int height = static_cast<int>(m_cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+        // Real PTS from a cached index if there is one; otherwise estimate
+        // from the container until the background indexer finishes
+        auto index = std::make_shared<FrameIndex>();
+        if (index->load(m_videoPath)) {
+            m_duration = index->duration();
+            {
+                QMutexLocker locker(&m_indexMutex);
+                m_index = index;
+            }
+            m_thumbnails->start(m_duration, index);
+        } else {
+            m_duration = m_decoder->duration();
+            m_indexThread = std::thread(&VideoWorker::buildIndex, this);
+        }
         
-        emit videoOpened(m_duration, m_fps, width, height);
+        QSize size = m_decoder->frameSize();
+        emit videoOpened(m_duration, m_fps, size.width(), size.height());
     } else {
         emit errorOccurred("Failed to open video file: " + m_videoPath);
         m_stop = true;
     }
 }
 
+void VideoWorker::buildIndex() {
+    auto index = std::make_shared<FrameIndex>(FrameIndex::build(m_videoPath, m_stop));
+    if (m_stop) return;
+    if (index->isEmpty()) {
+        // Unindexable container: sample thumbnails by time instead
+        m_thumbnails->start(m_duration, nullptr);
+        return;
+    }
+    
+    if (!index->save(m_videoPath)) {
+        qWarning() << "Could not write frame index for" << m_videoPath;
+    }
+    
+    {
+        QMutexLocker locker(&m_indexMutex);
+        m_index = index;
+    }
+    emit durationChanged(index->duration());
+    m_thumbnails->start(index->duration(), index);
+}
+
+std::shared_ptr<const FrameIndex> VideoWorker::frameIndex() const {
+    QMutexLocker locker(&m_indexMutex);
+    return m_index;
+}
+
 void VideoWorker::stop() {
     m_stop = true;
 }
@@ -47,95 +131,606 @@ void VideoWorker::setPaused(bool paused) {
     m_paused = paused;
 }
 
+void VideoWorker::setActive(bool active) {
+    m_active = active;
+}
+
 void VideoWorker::seek(double positionSeconds) {
+    // Publish the target before the generation so the decoder never pairs
+    // a new generation with an old target
     m_seekTarget = positionSeconds;
-    m_seeking = true;
+    m_seekTargetFrame = -1;
+    m_seekFillsGop = false;
+    m_seekGeneration.fetch_add(1);
+}
+
+void VideoWorker::requestFrame(int frame, bool fillGop) {
+    m_seekTarget = frame / m_fps;
+    m_seekTargetFrame = std::max(frame, 0);
+    m_seekFillsGop = fillGop;
+    m_seekGeneration.fetch_add(1);
 }
 
 void VideoWorker::setSpeed(double speed) {
-    m_playbackSpeed = speed;
+    if (speed == 0.0) return;
+    
+    bool wasSkimming = m_playbackSpeed.exchange(speed) >= SKIM_SPEED;
+    
+    // Changing direction, or entering or leaving skimming, restarts decoding
+    // from the frame on screen instead of playing out what is buffered
+    bool reverse = speed < 0.0;
+    if (reverse != m_reverse.exchange(reverse)) {
+        requestFrame(m_presentedFrame.load(), reverse);
+    } else if ((speed >= SKIM_SPEED) != wasSkimming) {
+        requestFrame(m_presentedFrame.load(), false);
+    }
+}
+
+void VideoWorker::setViewport(const QRectF& visible, double devicePixelsPerSourcePixel) {
+    {
+        QMutexLocker locker(&m_viewportMutex);
+        m_viewportVisible = visible;
+        m_viewportScale = devicePixelsPerSourcePixel;
+    }
+    m_viewportChanged = true;
+}
+
+void VideoWorker::stepForward() {
+    requestFrame(m_presentedFrame.load() + 1, false);
+}
+
+void VideoWorker::stepBackward() {
+    // Caching the whole GOP makes repeated steps back free
+    requestFrame(m_presentedFrame.load() - 1, true);
 }
 
 void VideoWorker::process() {
     openVideo();
     
-    // Simple pacing loop
+    if (!m_stop) {
+        m_decodeThread = std::thread(&VideoWorker::decodeLoop, this);
+        presentLoop();
+        m_decodeThread.join();
+    }
+    if (m_indexThread.joinable()) {
+        m_indexThread.join();
+    }
+    m_thumbnails->stop();
+    
+    emit finished();
+}
+
+bool VideoWorker::seekTo(double target, quint64 generation) {
+    std::shared_ptr<const FrameIndex> index = frameIndex();
+    if (!index || index->isEmpty()) {
+        // No index yet: fall back to the decoder's approximate seek
+        m_decoder->seek(target);
+        return false;
+    }
+    
+    int frame = index->frameAtTime(target);
+    double targetPts = index->pts(frame);
+    double tolerance = 0.5 / m_fps;
+    int keyframe = index->keyframeAtOrBefore(frame);
+    
+    // Land on the preceding keyframe, then decode forward to the exact frame.
+    // If the decoder lands past the target, back off one GOP and retry.
+    for (int attempt = 0; attempt < 3 && keyframe >= 0; ++attempt) {
+        m_decoder->seek(index->pts(keyframe));
+        
+        while (m_decoder->grab()) {
+            // A newer seek supersedes this one
+            if (m_stop || m_seekGeneration.load() != generation) return false;
+            
+            double pts = m_decoder->framePts();
+            if (pts >= targetPts - tolerance) {
+                if (pts <= targetPts + tolerance || attempt == 2) return true;
+                break;
+            }
+        }
+        keyframe = index->keyframeBefore(keyframe);
+    }
+    
+    return false;
+}
+
+void VideoWorker::handleSeek(const FrameIndex* index, quint64 generation) {
+    int requestedFrame = m_seekTargetFrame.load();
+    double target = m_seekTarget.load();
+    bool fillsGop = m_seekFillsGop.load();
+    bool reverse = m_reverse.load();
+    
+    if (!index) {
+        // No index yet: fall back to the decoder's approximate seek
+        m_pendingGrab = seekTo(target, generation);
+        m_cursor = -1;
+        m_capFrame = -1;
+        return;
+    }
+    
+    m_cursor = requestedFrame >= 0 ? std::min(requestedFrame, index->frameCount() - 1)
+                                   : index->frameAtTime(target);
+    m_frameCache.setFocus(m_cursor, reverse ? -1 : 1);
+    
+    if ((fillsGop || reverse) && !m_frameCache.contains(m_cursor)) {
+        fillGop(*index, m_cursor, generation);
+    }
+}
+
+void VideoWorker::positionCapture(const FrameIndex& index, int frame, quint64 generation) {
+    if (m_capFrame == frame) return;
+    
+    m_pendingGrab = seekTo(index.pts(frame), generation);
+    m_capFrame = m_pendingGrab ? frame : -1;
+}
+
+bool VideoWorker::decodeNext(VideoFrame& out, const FrameIndex* index) {
+    bool grabbed = m_pendingGrab || m_decoder->grab();
+    m_pendingGrab = false;
+    if (!grabbed) {
+        m_capFrame = -1;
+        return false;
+    }
+    
+    // Keep whichever is smaller until presentation: the native 4:2:0 planes
+    // (1.5 bytes per source pixel) or the cropped, scaled BGRA image
+    const QSize frameSize = m_decoder->frameSize();
+    const QSize outputSize = m_region.outputSize(frameSize);
+    const qint64 nativeBytes = static_cast<qint64>(frameSize.width()) * frameSize.height() * 3 / 2;
+    const qint64 displayBytes = static_cast<qint64>(outputSize.width()) * outputSize.height() * 4;
+    
+    out = VideoFrame();
+    if (nativeBytes < displayBytes && m_region.boxFactor(frameSize) > 0 && m_decoder->retrieveYuv(out.yuv)) {
+        out.region = m_region;
+    } else {
+        QImage image;
+        VideoDecoder::Transfer transfer = m_decoder->retrieve(*m_framePool, image, m_region);
+        if (transfer == VideoDecoder::Transfer::Failed) {
+            m_capFrame = -1;
+            return false;
+        }
+        if (transfer == VideoDecoder::Transfer::Copied) {
+            m_bytesCopied.fetch_add(image.sizeInBytes(), std::memory_order_relaxed);
+        } else {
+            m_bytesConverted.fetch_add(image.sizeInBytes(), std::memory_order_relaxed);
+        }
+        out.image = image;
+    }
+    m_framesDecoded.fetch_add(1, std::memory_order_relaxed);
+    
+    out.sourceRect = m_region.sourceRect(frameSize);
+    out.pts = m_decoder->framePts();
+    out.frameNumber = index ? index->frameAtTime(out.pts + 0.0005)
+                            : static_cast<int>(std::lround(out.pts * m_fps));
+    m_capFrame = out.frameNumber + 1;
+    return true;
+}
+
+void VideoWorker::fillGop(const FrameIndex& index, int lastFrame, quint64 generation) {
+    positionCapture(index, index.keyframeAtOrBefore(lastFrame), generation);
+    
+    // Decode the GOP forward once; the cache keeps what fits, nearest to the focus
+    VideoFrame decoded;
+    while (!m_stop && m_seekGeneration.load() == generation && decodeNext(decoded, &index)) {
+        m_frameCache.insert(decoded);
+        if (decoded.frameNumber >= lastFrame) break;
+    }
+}
+
+void VideoWorker::prefetchPreviousGop(const FrameIndex& index, quint64 generation) {
+    if (m_cursor <= 0) return;
+    
+    int keyframe = index.keyframeAtOrBefore(m_cursor);
+    if (keyframe <= 0 || m_frameCache.contains(keyframe - 1)) return;
+    
+    // Only when the previous GOP fits in the cache together with the frames
+    // still to be shown; older frames make room
+    int previousKeyframe = index.keyframeAtOrBefore(keyframe - 1);
+    qint64 frameBytes = m_frameCache.count() > 0 ? m_frameCache.bytes() / m_frameCache.count() : 0;
+    if (frameBytes * (m_cursor - previousKeyframe + 1) > m_frameCache.budget()) return;
+    
+    fillGop(index, keyframe - 1, generation);
+}
+
+void VideoWorker::prefetchWindow(const FrameIndex& index, quint64 generation) {
+    if (index.isEmpty()) return;
+    
+    int playhead = std::clamp(m_presentedFrame.load(), 0, index.frameCount() - 1);
+    m_frameCache.setFocus(playhead, 1);
+    
+    // Never reach further than the cache can hold, or prefetched frames
+    // would evict each other
+    qint64 frameBytes = m_frameCache.count() > 0 ? m_frameCache.bytes() / m_frameCache.count() : m_frameBytes;
+    int reach = m_frameCache.window();
+    if (frameBytes > 0) {
+        reach = static_cast<int>(std::min<qint64>(reach, m_frameCache.budget() / frameBytes / 2 - 1));
+    }
+    
+    // One unit of work per call: the next missing frame ahead (resuming is
+    // the common case), otherwise the GOP of the nearest missing one behind
+    int last = std::min(index.frameCount() - 1, playhead + reach);
+    for (int frame = playhead; frame <= last; ++frame) {
+        if (m_frameCache.contains(frame)) continue;
+        
+        positionCapture(index, frame, generation);
+        VideoFrame decoded;
+        if (m_seekGeneration.load() == generation && decodeNext(decoded, &index)) {
+            m_frameCache.insert(decoded);
+        }
+        return;
+    }
+    
+    int first = std::max(0, playhead - reach);
+    for (int frame = playhead - 1; frame >= first; --frame) {
+        if (!m_frameCache.contains(frame)) {
+            fillGop(index, frame, generation);
+            return;
+        }
+    }
+}
+
+const VideoFrame* VideoWorker::findCached(int frame) {
+    m_cacheLookups.fetch_add(1, std::memory_order_relaxed);
+    const VideoFrame* cached = m_frameCache.find(frame);
+    if (cached) {
+        m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return cached;
+}
+
+void VideoWorker::publish(VideoFrame* slot, const VideoFrame& frame, quint64 generation) {
+    *slot = frame;
+    slot->generation = generation;
+    m_frameBytes = frame.bytes();
+    m_bufferedBytes.fetch_add(m_frameBytes, std::memory_order_relaxed);
+    m_ring.commitWrite();
+}
+
+bool VideoWorker::bufferHasRoom() const {
+    if (m_ring.size() < static_cast<size_t>(MIN_BUFFER_FRAMES)) return true;
+    return m_bufferedBytes.load(std::memory_order_relaxed) + m_frameBytes <= m_bufferBudget;
+}
+
+void VideoWorker::release(VideoFrame* frame) {
+    // Release the pixels now rather than when the slot is reused
+    m_bufferedBytes.fetch_sub(frame->bytes(), std::memory_order_relaxed);
+    *frame = VideoFrame();
+    m_ring.pop();
+}
+
+bool VideoWorker::prepareForDisplay(const VideoFrame& frame, VideoFrame& shown) {
+    shown = frame;
+    if (!shown.image.isNull()) return true;
+    
+    // Stored as YUV: convert now, only for frames that are actually shown
+    if (!VideoDecoder::convertYuv(frame.yuv, frame.region, *m_framePool, shown.image)) return false;
+    m_bytesConverted.fetch_add(shown.image.sizeInBytes(), std::memory_order_relaxed);
+    shown.yuv = YuvFrame();
+    return true;
+}
+
+void VideoWorker::produceForward(VideoFrame* slot, const FrameIndex* index, quint64 generation) {
+    if (index && m_cursor >= 0) {
+        if (m_cursor >= index->frameCount()) {
+            m_cursor = 0; // Loop video
+        }
+        if (const VideoFrame* cached = findCached(m_cursor)) {
+            publish(slot, *cached, generation);
+            ++m_cursor;
+            return;
+        }
+        positionCapture(*index, m_cursor, generation);
+    }
+    
+    VideoFrame decoded;
+    if (!decodeNext(decoded, index)) {
+        // Loop video
+        if (index) {
+            m_cursor = 0;
+        } else {
+            m_decoder->seek(0.0);
+        }
+        return;
+    }
+    
+    if (index) {
+        m_frameCache.setFocus(decoded.frameNumber, 1);
+        m_frameCache.insert(decoded);
+        m_cursor = decoded.frameNumber + 1;
+    }
+    publish(slot, decoded, generation);
+}
+
+void VideoWorker::produceReverse(VideoFrame* slot, const FrameIndex& index, quint64 generation) {
+    if (m_cursor < 0) {
+        // Reached the first frame; hold until the next seek or direction change
+        QThread::msleep(5);
+        return;
+    }
+    
+    const VideoFrame* cached = findCached(m_cursor);
+    if (!cached) {
+        m_frameCache.setFocus(m_cursor, -1);
+        fillGop(index, m_cursor, generation);
+        cached = m_frameCache.find(m_cursor);
+    }
+    if (cached && m_seekGeneration.load() == generation) {
+        publish(slot, *cached, generation);
+    }
+    
+    --m_cursor;
+    m_frameCache.setFocus(m_cursor, -1);
+}
+
+void VideoWorker::produceSkim(VideoFrame* slot, const FrameIndex* index, quint64 generation) {
+    double speed = m_playbackSpeed.load();
+    int stride = std::max(1, static_cast<int>(std::lround(speed * SKIM_KEYFRAME_COST)));
+    
+    if (!index) {
+        // No keyframe table yet: grab() without retrieve() up to the next frame
+        // worth showing (the decoder skips non-keyframes itself if it can)
+        double minGap = stride / m_fps;
+        bool grabbed = m_pendingGrab || m_decoder->grab();
+        while (grabbed && m_decoder->framePts() >= m_skimPts && m_decoder->framePts() < m_skimPts + minGap) {
+            if (m_stop || m_seekGeneration.load() != generation) return;
+            grabbed = m_decoder->grab();
+        }
+        m_pendingGrab = grabbed;
+        
+        VideoFrame decoded;
+        if (!decodeNext(decoded, nullptr)) {
+            m_decoder->seek(0.0); // Loop video
+            m_skimPts = -std::numeric_limits<double>::infinity();
+            return;
+        }
+        m_skimPts = decoded.pts;
+        publish(slot, decoded, generation);
+        return;
+    }
+    
+    if (m_cursor < 0 || m_cursor >= index->frameCount()) {
+        m_cursor = 0; // Loop video
+    }
+    
+    // The last keyframe within one stride, or the next one when keyframes are sparser
+    int keyframe = index->keyframeAtOrBefore(m_cursor - 1 + stride);
+    if (keyframe < m_cursor) {
+        keyframe = index->keyframeAfter(m_cursor - 1);
+        if (keyframe < 0) {
+            m_cursor = 0; // Past the last keyframe: loop video
+            return;
+        }
+    }
+    
+    // Consecutive keyframes are read straight through; farther ones are seeked to
+    if (m_keyframesOnly && m_capFrame >= 0 && m_capFrame <= keyframe
+        && index->keyframeAfter(m_capFrame - 1) == keyframe) {
+        m_capFrame = keyframe;
+    }
+    positionCapture(*index, keyframe, generation);
+    
+    VideoFrame decoded;
+    if (m_seekGeneration.load() != generation || !decodeNext(decoded, index)) {
+        m_cursor = 0;
+        return;
+    }
+    
+    // Skimmed frames bypass the GOP cache; it holds the neighbourhood of the playhead
+    m_cursor = decoded.frameNumber + 1;
+    publish(slot, decoded, generation);
+}
+
+void VideoWorker::setSkimming(bool skimming) {
+    m_skimming = skimming;
+    m_keyframesOnly = m_decoder->setKeyframesOnly(skimming) && skimming;
+    m_skimPts = -std::numeric_limits<double>::infinity();
+    
+    // The decoder's position no longer matches the frame numbering
+    m_capFrame = -1;
+    m_pendingGrab = false;
+}
+
+void VideoWorker::applyViewport(const FrameIndex* index) {
+    QRectF visible;
+    double scale;
+    {
+        QMutexLocker locker(&m_viewportMutex);
+        visible = m_viewportVisible;
+        scale = m_viewportScale;
+    }
+    
+    DecodeRegion region = DecodeRegion::forViewport(m_decoder->frameSize(), visible, scale);
+    if (region == m_region) return;
+    m_region = region;
+    
+    // Cached frames were converted for the old region
+    m_frameCache.clear();
+    if (m_paused && index) {
+        // Re-render the still frame at the new resolution
+        requestFrame(m_presentedFrame.load(), m_reverse.load());
+    }
+}
+
+void VideoWorker::decodeLoop() {
+    // Starts from zero so a seek issued before the thread ran is still honoured
+    quint64 decodeGeneration = 0;
+    std::shared_ptr<const FrameIndex> index = frameIndex();
+    
     while (!m_stop) {
+        // The index may finish building while playback is running
+        if (!index) {
+            index = frameIndex();
+            if (index && m_reverse.load()) {
+                // Reverse playback needs frame numbers: restart from the screen
+                requestFrame(m_presentedFrame.load(), true);
+            }
+        }
+        
+        if (m_viewportChanged.exchange(false)) {
+            applyViewport(index.get());
+        }
+        
         // 1. Handle Seeking
-        if (m_seeking) {
-            m_bufferMutex.lock();
-            m_buffer.clear();
-            m_bufferMutex.unlock();
-            
-            double target = m_seekTarget.load();
-            // Seek OpenCV
-            m_cap.set(cv::CAP_PROP_POS_MSEC, target * 1000.0);
-            m_seeking = false;
-        }
-        
-        // 2. Decode / Buffer Filling
-        m_bufferMutex.lock();
-        bool bufferNeedsData = m_buffer.size() < BUFFER_SIZE;
-        m_bufferMutex.unlock();
-        
-        if (bufferNeedsData) {
-            cv::Mat frame;
-            if (m_cap.read(frame)) {
-                if (!frame.empty()) {
-                    // Color Conversion
-                    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
-                    
-                    // Deep copy to QImage
-                    // Note: QImage constructor with raw data does NOT copy, so we must call .copy()
-                    QImage qImg(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), QImage::Format_RGB888);
-                    QImage deepCopy = qImg.copy();
-                    
-                    double pos = m_cap.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
-                    
-                    m_bufferMutex.lock();
-                    m_buffer.push_back({pos, deepCopy});
-                    m_bufferMutex.unlock();
-                }
-            } else {
-                // Loop video
-                m_cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+        quint64 generation = m_seekGeneration.load();
+        if (generation != decodeGeneration) {
+            decodeGeneration = generation;
+            handleSeek(index.get(), generation);
+        }
+        bool reverse = index && m_reverse.load();
+        bool skimming = !reverse && !m_paused && m_playbackSpeed.load() >= SKIM_SPEED;
+        if (skimming != m_skimming) {
+            setSkimming(skimming);
+        }
+        
+        // 2. Wait for a free slot within the byte budget (the presenter drains
+        // stale generations). Primed and paused workers stop after the first
+        // few frames to save memory and decoding.
+        bool playing = m_active && !m_paused;
+        VideoFrame* slot = (playing || m_ring.size() < PRIME_FRAMES) && bufferHasRoom() ? m_ring.acquireWrite() : nullptr;
+        if (!slot) {
+            if (reverse) {
+                prefetchPreviousGop(*index, decodeGeneration);
+            } else if (index && m_active && m_paused) {
+                prefetchWindow(*index, decodeGeneration);
             }
+            QThread::msleep(2);
+            continue;
         }
         
-        // 3. Playback / Emission
-        if (m_paused) {
-            QThread::msleep(50); // Sleep longer when paused
+        // 3. Decode (or serve from the GOP cache) into the slot
+        if (reverse) {
+            produceReverse(slot, *index, decodeGeneration);
+        } else if (m_skimming) {
+            produceSkim(slot, index.get(), decodeGeneration);
+        } else {
+            produceForward(slot, index.get(), decodeGeneration);
+        }
+    }
+    
+    m_decoder->close();
+}
+
+void VideoWorker::presentLoop() {
+    m_scheduler.invalidate();
+    m_scheduler.resetStats();
+    auto lastStatsReport = FrameScheduler::Clock::now();
+    PlaybackStats reported;
+    quint64 presentGeneration = m_seekGeneration.load();
+    quint64 stillGeneration = presentGeneration - 1; // Generation last shown while paused
+    
+    // Present each frame at its PTS deadline
+    while (!m_stop) {
+        // 1. Flush frames decoded before the latest seek
+        quint64 generation = m_seekGeneration.load();
+        if (generation != presentGeneration) {
+            presentGeneration = generation;
+            m_scheduler.invalidate();
+        }
+        
+        VideoFrame* next = m_ring.peek();
+        if (next && next->generation != presentGeneration) {
+            release(next);
             continue;
         }
         
-        m_bufferMutex.lock();
-        bool hasFrames = !m_buffer.empty();
-        std::pair<double, QImage> nextFrame;
-        if (hasFrames) nextFrame = m_buffer.front();
-        m_bufferMutex.unlock();
+        // 2. Playback / Emission
+        if (!m_active) {
+            // Primed: poll quickly so activation shows the first frame at once
+            m_scheduler.invalidate();
+            QThread::msleep(2);
+            continue;
+        }
         
-        if (hasFrames) {
-            emit frameReady(nextFrame.second);
-            emit positionChanged(nextFrame.first);
-            
-            m_bufferMutex.lock();
-            m_buffer.pop_front();
-            m_bufferMutex.unlock();
-            
-            // Pacing
-            // Calculate desired frame time
-            double frameTimeMs = 1000.0 / (m_fps * m_playbackSpeed);
+        if (m_paused) {
+            // Re-anchor the clock on resume so the pause is not counted as lateness
+            m_scheduler.invalidate();
             
-            // In a real app, we would measure elapsed time since last emit
-            // For now, a simple sleep is robust enough for v1
-            QThread::msleep(static_cast<unsigned long>(frameTimeMs));
-        } else {
+            // Scrubbing: show the first frame after a seek without consuming it
+            if (stillGeneration != presentGeneration) {
+                VideoFrame shown;
+                if (next && prepareForDisplay(*next, shown)) {
+                    stillGeneration = presentGeneration;
+                    if (next->frameNumber >= 0) m_presentedFrame = next->frameNumber;
+                    m_mailbox->post(shown);
+                }
+                QThread::msleep(1);
+                continue;
+            }
+            QThread::msleep(50); // Sleep longer when paused
+            continue;
+        }
+        
+        if (!next) {
             // Waiting for decoder
-            QThread::msleep(5);
+            QThread::msleep(1);
+            continue;
+        }
+        
+        // Speed changes re-anchor the clock at the current media time
+        double speed = m_playbackSpeed.load();
+        m_scheduler.setSpeed(speed);
+        
+        // Looping back to the start would otherwise look like a huge backlog
+        double direction = speed < 0.0 ? -1.0 : 1.0;
+        double backlogLimit = std::max(1.0, std::abs(speed));
+        if (m_scheduler.isAnchored() && (next->pts - m_scheduler.mediaTimeNow()) * direction < -backlogLimit) {
+            m_scheduler.invalidate();
+        }
+        
+        // Skimmed frames are further apart than one frame duration
+        const VideoFrame* successor = m_ring.peek(1);
+        double frameDuration = 1.0 / m_fps;
+        if (successor && successor->generation == presentGeneration) {
+            frameDuration = std::max(frameDuration, std::abs(successor->pts - next->pts));
+        }
+        FrameScheduler::Decision decision = m_scheduler.schedule(next->pts, frameDuration, successor != nullptr);
+        if (decision == FrameScheduler::Decision::Wait) {
+            // Sleep until the deadline (bounded so seek/stop stay responsive)
+            auto wakeUp = std::min(m_scheduler.deadline(next->pts),
+                                   FrameScheduler::Clock::now() + std::chrono::milliseconds(10));
+            std::this_thread::sleep_until(wakeUp);
+            continue;
+        }
+        
+        VideoFrame shown;
+        if (decision == FrameScheduler::Decision::Present && prepareForDisplay(*next, shown)) {
+            stillGeneration = presentGeneration;
+            if (next->frameNumber >= 0) m_presentedFrame = next->frameNumber;
+            m_mailbox->post(shown);
+        }
+        release(next);
+        
+        // Report drop/late counters at most once per second
+        auto now = FrameScheduler::Clock::now();
+        if (now - lastStatsReport >= std::chrono::seconds(1)) {
+            lastStatsReport = now;
+            PlaybackStats stats = collectStats();
+            if (stats != reported) {
+                reported = stats;
+                emit playbackStats(stats);
+            }
         }
     }
-    
-    m_cap.release();
-    emit finished();
 }
 
+PlaybackStats VideoWorker::collectStats() const {
+    PlaybackStats stats;
+    stats.droppedFrames = m_scheduler.droppedFrames();
+    stats.lateFrames = m_scheduler.lateFrames();
+    stats.overwrittenFrames = m_mailbox->overwrittenFrames();
+    stats.bufferedFrames = static_cast<int>(m_ring.size());
+    stats.bufferedBytes = m_bufferedBytes.load(std::memory_order_relaxed);
+    stats.bufferBudget = m_bufferBudget;
+    stats.cacheLookups = m_cacheLookups.load(std::memory_order_relaxed);
+    stats.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    stats.ioBytesRead = m_ioCounters->bytesRead.load(std::memory_order_relaxed);
+    stats.ioMegabytesPerSecond = m_ioCounters->megabytesPerSecond();
+    stats.ioStallMs = m_ioCounters->stallNanoseconds.load(std::memory_order_relaxed) / 1000000;
+    
+    qint64 frames = m_framesDecoded.load(std::memory_order_relaxed);
+    if (frames > 0) {
+        stats.bytesCopiedPerFrame = m_bytesCopied.load(std::memory_order_relaxed) / frames;
+        stats.bytesConvertedPerFrame = m_bytesConverted.load(std::memory_order_relaxed) / frames;
+    }
+    return stats;
+}
@@ -3,10 +3,20 @@
 #include <QObject>
 #include <QImage>
 #include <QMutex>
-#include <QWaitCondition>
-#include <opencv2/opencv.hpp>
 #include <atomic>
-#include <deque>
+#include <memory>
+#include <thread>
+
+#include "FrameIndex.hpp"
+#include "FrameMailbox.hpp"
+#include "FramePool.hpp"
+#include "FrameScheduler.hpp"
+#include "FrameCache.hpp"
+#include "PlaybackStats.hpp"
+#include "SpscRing.hpp"
+#include "ThumbnailStrip.hpp"
+#include "VideoDecoder.hpp"
+#include "VideoFrame.hpp"
 
 class VideoWorker : public QObject {
     Q_OBJECT
@@ -14,46 +24,148 @@ class VideoWorker : public QObject {
 public:
     explicit VideoWorker(QString videoPath, QObject* parent = nullptr);
     ~VideoWorker() override;
+    
+    // Scrub previews; safe to use from the GUI thread
+    std::shared_ptr<ThumbnailStrip> thumbnails() const { return m_thumbnails; }
+    // The frame on screen and its position; the GUI pulls it once per display tick
+    std::shared_ptr<FrameMailbox> mailbox() const { return m_mailbox; }
 
 public slots:
-    // Main loop to start processing
+    // Main loop to start processing (runs the presenter; spawns the decoder)
     void process();
     
     // Controls
     void stop();
     void setPaused(bool paused);
+    // Inactive workers are primed: they open the file and decode a few frames,
+    // but present nothing until activated
+    void setActive(bool active);
+    // Seeks coalesce: only the newest target is decoded, older ones are cancelled.
+    // While paused, the first frame at the new position is still shown.
     void seek(double positionSeconds);
+    // Negative speeds play in reverse. From SKIM_SPEED upwards only
+    // keyframes are decoded (see produceSkim).
     void setSpeed(double speed);
+    // What the view shows: visible part of the frame in source pixels and the
+    // device pixels per source pixel. Frames are cropped and downscaled to it.
+    void setViewport(const QRectF& visible, double devicePixelsPerSourcePixel);
+    
+    // Single-frame stepping relative to the frame on screen (use while paused)
+    void stepForward();
+    void stepBackward();
 
 signals:
-    // Emitted when a frame is ready for display
-    void frameReady(const QImage& frame);
-    
-    // Metadata signals
+    // Metadata signals (frames and positions go through the mailbox)
     void videoOpened(double duration, double fps, int width, int height);
-    void positionChanged(double timestamp);
+    void durationChanged(double duration); // Once the frame index provides real PTS
+    void playbackStats(const PlaybackStats& stats);
     void finished();
     void errorOccurred(QString message);
 
 private:
     void openVideo();
-    void readFramesIntoBuffer();
+    void buildIndex();
+    std::shared_ptr<const FrameIndex> frameIndex() const;
+    void requestFrame(int frame, bool fillGop);
+    bool seekTo(double target, quint64 generation);
+    
+    // Decoder thread helpers
+    void handleSeek(const FrameIndex* index, quint64 generation);
+    void positionCapture(const FrameIndex& index, int frame, quint64 generation);
+    bool decodeNext(VideoFrame& out, const FrameIndex* index);
+    void fillGop(const FrameIndex& index, int lastFrame, quint64 generation);
+    void prefetchPreviousGop(const FrameIndex& index, quint64 generation);
+    void prefetchWindow(const FrameIndex& index, quint64 generation);
+    const VideoFrame* findCached(int frame);
+    void produceForward(VideoFrame* slot, const FrameIndex* index, quint64 generation);
+    void produceReverse(VideoFrame* slot, const FrameIndex& index, quint64 generation);
+    void produceSkim(VideoFrame* slot, const FrameIndex* index, quint64 generation);
+    void setSkimming(bool skimming);
+    void publish(VideoFrame* slot, const VideoFrame& frame, quint64 generation);
+    bool bufferHasRoom() const;
+    void release(VideoFrame* frame);
+    bool prepareForDisplay(const VideoFrame& frame, VideoFrame& shown);
+    void applyViewport(const FrameIndex* index);
+    void decodeLoop();
+    void presentLoop();
+    PlaybackStats collectStats() const;
     
     QString m_videoPath;
-    cv::VideoCapture m_cap;
+    QString m_decoderBackend;
+    VideoDecoder::Options m_decoderOptions;
+    std::unique_ptr<VideoDecoder> m_decoder; // Owned by the decoder thread once playback starts
     
     // State
     std::atomic<bool> m_stop;
     std::atomic<bool> m_paused;
-    std::atomic<bool> m_seeking;
+    std::atomic<bool> m_active;
     std::atomic<double> m_seekTarget;
-    double m_playbackSpeed;
+    std::atomic<int> m_seekTargetFrame;    // Overrides m_seekTarget when >= 0
+    std::atomic<bool> m_seekFillsGop;      // Decode and cache the whole GOP up to the target
+    std::atomic<quint64> m_seekGeneration; // Bumped by seek(); stale frames are discarded
+    std::atomic<double> m_playbackSpeed;
+    std::atomic<bool> m_reverse;
+    std::atomic<int> m_presentedFrame;     // Frame number currently on screen
     double m_fps;
     double m_duration;
     
-    // Buffer
-    static const int BUFFER_SIZE = 10;
-    std::deque<std::pair<double, QImage>> m_buffer; // Pair of timestamp, image
-    QMutex m_bufferMutex;
+    // Decoder -> presenter hand-off
+    // The ring holds as many frames as fit the byte budget from the config,
+    // but at least MIN_BUFFER_FRAMES and at most MAX_BUFFER_FRAMES
+    static const int MAX_BUFFER_FRAMES = 120;
+    static const int MIN_BUFFER_FRAMES = 2;
+    static const int PRIME_FRAMES = 3; // Decoded ahead while inactive or paused
+    
+    // High-speed skimming shows keyframes only. A keyframe costs a few regular
+    // frames to decode, so at most one is shown per SKIM_KEYFRAME_COST * speed
+    // source frames; that keeps skimming within the decode budget of 1x.
+    static constexpr double SKIM_SPEED = 4.0;
+    static constexpr double SKIM_KEYFRAME_COST = 4.0;
+    SpscRing<VideoFrame> m_ring;
+    qint64 m_bufferBudget;
+    std::atomic<qint64> m_bufferedBytes; // Pixel memory of the frames in the ring
+    qint64 m_frameBytes;                 // Size of the last published frame (decoder thread)
+    std::thread m_decodeThread;
+    
+    // Decoder thread state
+    // Recently decoded frames, so replays and steps skip the decoder. While
+    // paused, the cache is filled PREFETCH_SECONDS around the playhead.
+    static constexpr double PREFETCH_SECONDS = 2.0;
+    FrameCache m_frameCache;
+    std::atomic<qint64> m_cacheLookups;
+    std::atomic<qint64> m_cacheHits;
+    int m_cursor;       // Next frame number to hand to the presenter (-1 if unknown)
+    int m_capFrame;     // Frame the decoder produces on the next decode (-1 if unknown)
+    bool m_pendingGrab; // The decoder holds a grabbed frame that still needs retrieve()
+    bool m_skimming;      // Producing keyframes only
+    bool m_keyframesOnly; // The decoder skips non-keyframes itself
+    double m_skimPts;     // Last skimmed frame, when there is no index yet
+    
+    // Viewport reported by the GUI; the decoder converts only what is shown
+    QRectF m_viewportVisible;
+    double m_viewportScale;
+    QMutex m_viewportMutex;
+    std::atomic<bool> m_viewportChanged;
+    DecodeRegion m_region; // Decoder thread only
+    
+    // Pixel buffers recycled between decoder and display
+    std::shared_ptr<FramePool> m_framePool;
+    std::atomic<qint64> m_framesDecoded;
+    std::atomic<qint64> m_bytesCopied;
+    std::atomic<qint64> m_bytesConverted;
+    
+    // Frame-accurate seeking
+    std::shared_ptr<const FrameIndex> m_index;
+    mutable QMutex m_indexMutex;
+    std::thread m_indexThread;
+    
+    // Scrub preview strip (sampled in the background once the index is known)
+    std::shared_ptr<ThumbnailStrip> m_thumbnails;
+    
+    // Presentation clock
+    FrameScheduler m_scheduler;
+    std::shared_ptr<FrameMailbox> m_mailbox;
+    
+    // Storage statistics, shared with the decoder's input reader
+    std::shared_ptr<IoCounters> m_ioCounters;
 };
-
@@ -0,0 +1,333 @@
+#include "YuvConverter.hpp"
+#include "YuvKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(ETHOWILD_YUV_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace yuv {
+
+namespace {
+
+inline int mulhrs(int a, int c) {
+    return (a * c + 0x4000) >> 15;
+}
+
+inline uint8_t toByte(int q5) {
+    int value = (q5 + 16) >> 5;
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void storePixel(uint8_t* out, int y, int u, int v, const Coefficients& k) {
+    int luma = mulhrs((y - k.yOffset) << 7, k.cy);
+    int cb = (u - 128) << 7;
+    int cr = (v - 128) << 7;
+    out[0] = toByte(luma + mulhrs(cb, k.cbu));
+    out[1] = toByte(luma - mulhrs(cb, k.cgu) - mulhrs(cr, k.cgv));
+    out[2] = toByte(luma + mulhrs(cr, k.crv));
+    out[3] = 255;
+}
+
+// Rounded mean of a size x size block
+inline int boxMean(const uint8_t* data, int stride, int step, int size) {
+    int sum = 0;
+    for (int row = 0; row < size; ++row) {
+        const uint8_t* line = data + row * stride;
+        for (int col = 0; col < size; ++col) {
+            sum += line[col * step];
+        }
+    }
+    int count = size * size;
+    return (sum + count / 2) / count;
+}
+
+} // namespace
+
+void convertSpanScalar(const Rows& rows, int row, int begin, int end) {
+    const int f = rows.factor;
+    uint8_t* out = rows.dst + row * rows.dstStride + begin * 4;
+    
+    if (f == 1) {
+        const uint8_t* y = rows.y + row * rows.yStride;
+        const uint8_t* u = rows.u + (row / 2) * rows.uvStride;
+        const uint8_t* v = rows.v + (row / 2) * rows.uvStride;
+        for (int x = begin; x < end; ++x, out += 4) {
+            int c = (x / 2) * rows.uvStep;
+            storePixel(out, y[x], u[c], v[c], rows.k);
+        }
+    } else if (f == 2) {
+        // Same rounding as the SIMD kernels: vertical pavgb, then horizontal pair mean
+        const uint8_t* y0 = rows.y + (2 * row) * rows.yStride;
+        const uint8_t* y1 = y0 + rows.yStride;
+        const uint8_t* u = rows.u + row * rows.uvStride;
+        const uint8_t* v = rows.v + row * rows.uvStride;
+        for (int x = begin; x < end; ++x, out += 4) {
+            int a = (y0[2 * x] + y1[2 * x] + 1) >> 1;
+            int b = (y0[2 * x + 1] + y1[2 * x + 1] + 1) >> 1;
+            int c = x * rows.uvStep;
+            storePixel(out, (a + b + 1) >> 1, u[c], v[c], rows.k);
+        }
+    } else {
+        const int half = f / 2;
+        const uint8_t* y = rows.y + (f * row) * rows.yStride;
+        const uint8_t* u = rows.u + (half * row) * rows.uvStride;
+        const uint8_t* v = rows.v + (half * row) * rows.uvStride;
+        for (int x = begin; x < end; ++x, out += 4) {
+            int c = half * x * rows.uvStep;
+            storePixel(out, boxMean(y + f * x, rows.yStride, 1, f),
+                       boxMean(u + c, rows.uvStride, rows.uvStep, half),
+                       boxMean(v + c, rows.uvStride, rows.uvStep, half), rows.k);
+        }
+    }
+}
+
+void convertRowsScalar(const Rows& rows, int begin, int end) {
+    for (int row = begin; row < end; ++row) {
+        convertSpanScalar(rows, row, 0, rows.width);
+    }
+}
+
+#ifndef ETHOWILD_YUV_X86
+// Only scalar code on other architectures
+void convertRowsSse41(const Rows& rows, int begin, int end) { convertRowsScalar(rows, begin, end); }
+void convertRowsAvx2(const Rows& rows, int begin, int end) { convertRowsScalar(rows, begin, end); }
+void convertRowsAvx512(const Rows& rows, int begin, int end) { convertRowsScalar(rows, begin, end); }
+#endif
+
+} // namespace yuv
+
+namespace {
+
+yuv::Coefficients coefficientsFor(YuvFrame::Matrix matrix, bool fullRange) {
+    const double kr = matrix == YuvFrame::Matrix::Bt709 ? 0.2126 : 0.299;
+    const double kb = matrix == YuvFrame::Matrix::Bt709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+    const double lumaScale = fullRange ? 1.0 : 255.0 / 219.0;
+    const double chromaScale = fullRange ? 1.0 : 255.0 / 224.0;
+    
+    auto q13 = [](double value) { return static_cast<int16_t>(std::lround(value * 8192.0)); };
+    yuv::Coefficients k;
+    k.yOffset = fullRange ? 0 : 16;
+    k.cy = q13(lumaScale);
+    k.cbu = q13(2.0 * (1.0 - kb) * chromaScale);
+    k.cgu = q13(2.0 * (1.0 - kb) * kb / kg * chromaScale);
+    k.cgv = q13(2.0 * (1.0 - kr) * kr / kg * chromaScale);
+    k.crv = q13(2.0 * (1.0 - kr) * chromaScale);
+    return k;
+}
+
+// Small shared pool for row stripes. The calling thread works on the batch
+// too, so a conversion never waits for a pool thread to wake up first.
+class StripePool {
+public:
+    static StripePool& instance() {
+        static StripePool pool;
+        return pool;
+    }
+
+    int threadCount() const { return static_cast<int>(m_threads.size()) + 1; }
+
+    void run(int count, const std::function<void(int)>& work) {
+        if (count <= 1 || m_threads.empty()) {
+            for (int i = 0; i < count; ++i) work(i);
+            return;
+        }
+        
+        Batch batch;
+        batch.work = &work;
+        batch.count = count;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batches.push_back(&batch);
+        }
+        m_wake.notify_all();
+        
+        drain(batch);
+        
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [&] { return batch.done.load() == count && batch.users == 0; });
+        m_batches.erase(std::remove(m_batches.begin(), m_batches.end(), &batch), m_batches.end());
+    }
+
+private:
+    struct Batch {
+        const std::function<void(int)>* work = nullptr;
+        int count = 0;
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        int users = 0; // Pool threads inside drain(), guarded by m_mutex
+    };
+
+    StripePool() {
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < std::min(cores, 8u); ++i) {
+            m_threads.emplace_back(&StripePool::workerLoop, this);
+        }
+    }
+
+    ~StripePool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void drain(Batch& batch) {
+        int index;
+        while ((index = batch.next.fetch_add(1)) < batch.count) {
+            (*batch.work)(index);
+            if (batch.done.fetch_add(1) + 1 == batch.count) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished.notify_all();
+            }
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stop || !m_batches.empty(); });
+            if (m_stop) return;
+            
+            Batch* batch = m_batches.front();
+            if (batch->next.load() >= batch->count) {
+                // Fully claimed; its owner removes it once the last stripe is done
+                m_batches.pop_front();
+                continue;
+            }
+            
+            ++batch->users;
+            lock.unlock();
+            drain(*batch);
+            lock.lock();
+            --batch->users;
+            m_finished.notify_all();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    std::deque<Batch*> m_batches;
+    bool m_stop = false;
+};
+
+YuvConverter::Isa detectIsa() {
+#ifdef ETHOWILD_YUV_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool avxState = (xcr0 & 0x6) == 0x6;
+    const bool avx512State = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = false;
+    bool avx512 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = avxState && (info[1] & (1 << 5)) != 0;
+        avx512 = avx512State && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0; // F + BW
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    if (avx512) return YuvConverter::Isa::Avx512;
+    if (avx2) return YuvConverter::Isa::Avx2;
+    if (sse41) return YuvConverter::Isa::Sse41;
+#endif
+    return YuvConverter::Isa::Scalar;
+}
+
+} // namespace
+
+YuvConverter::Isa YuvConverter::bestIsa() {
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+const char* YuvConverter::isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return "AVX-512";
+    case Isa::Avx2: return "AVX2";
+    case Isa::Sse41: return "SSE4.1";
+    case Isa::Scalar: break;
+    }
+    return "scalar";
+}
+
+bool YuvConverter::convert(const Request& request, int threads, Isa isa) {
+    const YuvFrame* frame = request.frame;
+    const int f = request.factor;
+    if (!frame || frame->isNull() || !request.dst) return false;
+    if (f != 1 && f != 2 && f != 4 && f != 8) return false;
+    if ((request.x | request.y) & 1 || request.x < 0 || request.y < 0) return false;
+    if (request.x + request.width > frame->width || request.y + request.height > frame->height) return false;
+    if (request.dstWidth <= 0 || request.dstHeight <= 0) return false;
+    if (request.dstWidth * f > request.width || request.dstHeight * f > request.height) return false;
+    
+    yuv::Rows rows;
+    rows.y = frame->planes[0] + static_cast<ptrdiff_t>(request.y) * frame->strides[0] + request.x;
+    rows.yStride = frame->strides[0];
+    rows.uvStride = frame->strides[1];
+    const ptrdiff_t chromaRow = static_cast<ptrdiff_t>(request.y / 2) * frame->strides[1];
+    if (frame->layout == YuvFrame::Layout::NV12) {
+        rows.u = frame->planes[1] + chromaRow + request.x;
+        rows.v = rows.u + 1;
+        rows.uvStep = 2;
+    } else {
+        rows.u = frame->planes[1] + chromaRow + request.x / 2;
+        rows.v = frame->planes[2] + static_cast<ptrdiff_t>(request.y / 2) * frame->strides[2] + request.x / 2;
+        rows.uvStep = 1;
+        if (frame->strides[2] != frame->strides[1]) return false;
+    }
+    rows.dst = request.dst;
+    rows.dstStride = request.dstStride;
+    rows.width = request.dstWidth;
+    rows.factor = f;
+    rows.k = coefficientsFor(frame->matrix, frame->fullRange);
+    
+    isa = std::min(isa, bestIsa());
+    void (*kernel)(const yuv::Rows&, int, int) = &yuv::convertRowsScalar;
+    if (f <= 2) {
+        switch (isa) {
+        case Isa::Avx512: kernel = &yuv::convertRowsAvx512; break;
+        case Isa::Avx2: kernel = &yuv::convertRowsAvx2; break;
+        case Isa::Sse41: kernel = &yuv::convertRowsSse41; break;
+        case Isa::Scalar: break;
+        }
+    }
+    
+    // Stripes of at least 32 output rows; more only help up to the core count
+    StripePool& pool = StripePool::instance();
+    if (threads <= 0) threads = pool.threadCount();
+    const int stripes = std::max(1, std::min(threads, request.dstHeight / 32));
+    const int rowsPerStripe = (request.dstHeight + stripes - 1) / stripes;
+    pool.run(stripes, [&](int stripe) {
+        int begin = stripe * rowsPerStripe;
+        int end = std::min(request.dstHeight, begin + rowsPerStripe);
+        if (begin < end) kernel(rows, begin, end);
+    });
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "YuvFrame.hpp"
+
+#include <cstdint>
+
+// Fused 4:2:0 YUV to 32-bit BGRA (QImage::Format_RGB32) conversion with an
+// optional power-of-two box downscale, in a single pass over the source.
+// Output rows are split into stripes converted in parallel; each stripe runs
+// the widest kernel the CPU supports (AVX-512, AVX2, SSE4.1) or portable
+// scalar code. All code paths produce bit-identical output.
+class YuvConverter {
+public:
+    enum class Isa { Scalar, Sse41, Avx2, Avx512 };
+
+    struct Request {
+        const YuvFrame* frame = nullptr;
+        // Source rect in luma pixels; x and y must be even
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        int factor = 1; // Box downscale: 1, 2, 4 or 8
+        // BGRA output; dstWidth * factor <= width, dstHeight * factor <= height
+        uint8_t* dst = nullptr;
+        int dstStride = 0;
+        int dstWidth = 0;
+        int dstHeight = 0;
+    };
+
+    // threads: stripes converted concurrently (0 = automatic).
+    // isa is clamped to what the CPU supports.
+    static bool convert(const Request& request, int threads = 0, Isa isa = bestIsa());
+
+    static Isa bestIsa();
+    static const char* isaName(Isa isa);
+};
@@ -0,0 +1,143 @@
+// AVX2 row kernels for YuvConverter (built with -mavx2)
+#include "YuvKernels.hpp"
+
+#include <immintrin.h>
+
+namespace yuv {
+
+namespace {
+
+struct Constants {
+    __m256i yOffset, cy, cbu, cgu, cgv, crv;
+    __m256i chromaBias, round, zero, maxByte, alpha, lowBytes, ones8, one16;
+
+    explicit Constants(const Coefficients& k)
+        : yOffset(_mm256_set1_epi16(k.yOffset)), cy(_mm256_set1_epi16(k.cy))
+        , cbu(_mm256_set1_epi16(k.cbu)), cgu(_mm256_set1_epi16(k.cgu))
+        , cgv(_mm256_set1_epi16(k.cgv)), crv(_mm256_set1_epi16(k.crv))
+        , chromaBias(_mm256_set1_epi16(128)), round(_mm256_set1_epi16(16))
+        , zero(_mm256_setzero_si256()), maxByte(_mm256_set1_epi16(255))
+        , alpha(_mm256_set1_epi16(static_cast<short>(0xFF00))), lowBytes(_mm256_set1_epi16(0x00FF))
+        , ones8(_mm256_set1_epi8(1)), one16(_mm256_set1_epi16(1)) {}
+};
+
+inline __m256i toByte(__m256i q5, const Constants& c) {
+    __m256i value = _mm256_srai_epi16(_mm256_add_epi16(q5, c.round), 5);
+    return _mm256_min_epi16(_mm256_max_epi16(value, c.zero), c.maxByte);
+}
+
+// 16 pixels from 16-bit Y, U, V lanes (in pixel order) to BGRA
+inline void storePixels(uint8_t* out, __m256i y, __m256i u, __m256i v, const Constants& c) {
+    __m256i luma = _mm256_mulhrs_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y, c.yOffset), 7), c.cy);
+    __m256i cb = _mm256_slli_epi16(_mm256_sub_epi16(u, c.chromaBias), 7);
+    __m256i cr = _mm256_slli_epi16(_mm256_sub_epi16(v, c.chromaBias), 7);
+    
+    __m256i b = toByte(_mm256_add_epi16(luma, _mm256_mulhrs_epi16(cb, c.cbu)), c);
+    __m256i g = toByte(_mm256_sub_epi16(_mm256_sub_epi16(luma, _mm256_mulhrs_epi16(cb, c.cgu)),
+                                        _mm256_mulhrs_epi16(cr, c.cgv)), c);
+    __m256i r = toByte(_mm256_add_epi16(luma, _mm256_mulhrs_epi16(cr, c.crv)), c);
+    
+    __m256i bg = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+    __m256i ra = _mm256_or_si256(r, c.alpha);
+    // Unpacks work per 128-bit lane: pixels 0-3|8-11 and 4-7|12-15
+    __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+    __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+inline __m256i load(const uint8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+inline __m128i load128(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// Eight 16-bit chroma samples, each repeated for two pixels
+inline __m256i duplicate(__m128i samples) {
+    return _mm256_set_m128i(_mm_unpackhi_epi16(samples, samples), _mm_unpacklo_epi16(samples, samples));
+}
+
+// 32 output pixels per step at full resolution
+int fullRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y = rows.y + row * rows.yStride;
+    const uint8_t* u = rows.u + (row / 2) * rows.uvStride;
+    const uint8_t* v = rows.v + (row / 2) * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    
+    int x = 0;
+    for (; x + 32 <= rows.width; x += 32) {
+        __m256i luma = load(y + x);
+        __m128i cbLo, cbHi, crLo, crHi;
+        if (rows.uvStep == 1) {
+            __m128i cb = load128(u + x / 2);
+            __m128i cr = load128(v + x / 2);
+            cbLo = _mm_cvtepu8_epi16(cb);
+            cbHi = _mm_cvtepu8_epi16(_mm_srli_si128(cb, 8));
+            crLo = _mm_cvtepu8_epi16(cr);
+            crHi = _mm_cvtepu8_epi16(_mm_srli_si128(cr, 8));
+        } else {
+            __m128i uvLo = load128(u + x);
+            __m128i uvHi = load128(u + x + 16);
+            cbLo = _mm_and_si128(uvLo, lowBytes);
+            crLo = _mm_srli_epi16(uvLo, 8);
+            cbHi = _mm_and_si128(uvHi, lowBytes);
+            crHi = _mm_srli_epi16(uvHi, 8);
+        }
+        storePixels(out + 4 * x, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(luma)),
+                    duplicate(cbLo), duplicate(crLo), c);
+        storePixels(out + 4 * x + 64, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(luma, 1)),
+                    duplicate(cbHi), duplicate(crHi), c);
+    }
+    return x;
+}
+
+// 32 output pixels per step from 2x2 luma blocks; chroma maps 1:1
+int halfRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y0 = rows.y + (2 * row) * rows.yStride;
+    const uint8_t* y1 = y0 + rows.yStride;
+    const uint8_t* u = rows.u + row * rows.uvStride;
+    const uint8_t* v = rows.v + row * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    
+    int x = 0;
+    for (; x + 32 <= rows.width; x += 32) {
+        // pmaddubsw pairs neighbours within each lane, so sums stay in pixel order
+        __m256i t0 = _mm256_avg_epu8(load(y0 + 2 * x), load(y1 + 2 * x));
+        __m256i t1 = _mm256_avg_epu8(load(y0 + 2 * x + 32), load(y1 + 2 * x + 32));
+        __m256i lumaLo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_maddubs_epi16(t0, c.ones8), c.one16), 1);
+        __m256i lumaHi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_maddubs_epi16(t1, c.ones8), c.one16), 1);
+        
+        __m256i cbLo, cbHi, crLo, crHi;
+        if (rows.uvStep == 1) {
+            cbLo = _mm256_cvtepu8_epi16(load128(u + x));
+            cbHi = _mm256_cvtepu8_epi16(load128(u + x + 16));
+            crLo = _mm256_cvtepu8_epi16(load128(v + x));
+            crHi = _mm256_cvtepu8_epi16(load128(v + x + 16));
+        } else {
+            __m256i uvLo = load(u + 2 * x);
+            __m256i uvHi = load(u + 2 * x + 32);
+            cbLo = _mm256_and_si256(uvLo, c.lowBytes);
+            crLo = _mm256_srli_epi16(uvLo, 8);
+            cbHi = _mm256_and_si256(uvHi, c.lowBytes);
+            crHi = _mm256_srli_epi16(uvHi, 8);
+        }
+        storePixels(out + 4 * x, lumaLo, cbLo, crLo, c);
+        storePixels(out + 4 * x + 64, lumaHi, cbHi, crHi, c);
+    }
+    return x;
+}
+
+} // namespace
+
+void convertRowsAvx2(const Rows& rows, int begin, int end) {
+    const Constants c(rows.k);
+    for (int row = begin; row < end; ++row) {
+        int done = rows.factor == 1 ? fullRow(rows, row, c) : halfRow(rows, row, c);
+        convertSpanScalar(rows, row, done, rows.width);
+    }
+}
+
+} // namespace yuv
@@ -0,0 +1,124 @@
+// AVX-512 (F + BW) row kernels for YuvConverter (built with -mavx512f -mavx512bw)
+#include "YuvKernels.hpp"
+
+#include <immintrin.h>
+
+namespace yuv {
+
+namespace {
+
+struct Constants {
+    __m512i yOffset, cy, cbu, cgu, cgv, crv;
+    __m512i chromaBias, round, zero, maxByte, alpha, lowBytes, ones8, one16;
+    __m512i duplicate, firstHalf, secondHalf;
+
+    explicit Constants(const Coefficients& k)
+        : yOffset(_mm512_set1_epi16(k.yOffset)), cy(_mm512_set1_epi16(k.cy))
+        , cbu(_mm512_set1_epi16(k.cbu)), cgu(_mm512_set1_epi16(k.cgu))
+        , cgv(_mm512_set1_epi16(k.cgv)), crv(_mm512_set1_epi16(k.crv))
+        , chromaBias(_mm512_set1_epi16(128)), round(_mm512_set1_epi16(16))
+        , zero(_mm512_setzero_si512()), maxByte(_mm512_set1_epi16(255))
+        , alpha(_mm512_set1_epi16(static_cast<short>(0xFF00))), lowBytes(_mm512_set1_epi16(0x00FF))
+        , ones8(_mm512_set1_epi8(1)), one16(_mm512_set1_epi16(1))
+        // Word i takes chroma sample i / 2
+        , duplicate(_mm512_set_epi16(15, 15, 14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8,
+                                     7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0))
+        // Quadwords that put the per-lane unpacks back in pixel order
+        , firstHalf(_mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0))
+        , secondHalf(_mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4)) {}
+};
+
+inline __m512i toByte(__m512i q5, const Constants& c) {
+    __m512i value = _mm512_srai_epi16(_mm512_add_epi16(q5, c.round), 5);
+    return _mm512_min_epi16(_mm512_max_epi16(value, c.zero), c.maxByte);
+}
+
+// 32 pixels from 16-bit Y, U, V lanes (in pixel order) to BGRA
+inline void storePixels(uint8_t* out, __m512i y, __m512i u, __m512i v, const Constants& c) {
+    __m512i luma = _mm512_mulhrs_epi16(_mm512_slli_epi16(_mm512_sub_epi16(y, c.yOffset), 7), c.cy);
+    __m512i cb = _mm512_slli_epi16(_mm512_sub_epi16(u, c.chromaBias), 7);
+    __m512i cr = _mm512_slli_epi16(_mm512_sub_epi16(v, c.chromaBias), 7);
+    
+    __m512i b = toByte(_mm512_add_epi16(luma, _mm512_mulhrs_epi16(cb, c.cbu)), c);
+    __m512i g = toByte(_mm512_sub_epi16(_mm512_sub_epi16(luma, _mm512_mulhrs_epi16(cb, c.cgu)),
+                                        _mm512_mulhrs_epi16(cr, c.cgv)), c);
+    __m512i r = toByte(_mm512_add_epi16(luma, _mm512_mulhrs_epi16(cr, c.crv)), c);
+    
+    __m512i bg = _mm512_or_si512(b, _mm512_slli_epi16(g, 8));
+    __m512i ra = _mm512_or_si512(r, c.alpha);
+    __m512i lo = _mm512_unpacklo_epi16(bg, ra);
+    __m512i hi = _mm512_unpackhi_epi16(bg, ra);
+    _mm512_storeu_si512(out, _mm512_permutex2var_epi64(lo, c.firstHalf, hi));
+    _mm512_storeu_si512(out + 64, _mm512_permutex2var_epi64(lo, c.secondHalf, hi));
+}
+
+inline __m512i load(const uint8_t* p) {
+    return _mm512_loadu_si512(p);
+}
+
+inline __m256i load256(const uint8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+// 32 output pixels per step at full resolution
+int fullRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y = rows.y + row * rows.yStride;
+    const uint8_t* u = rows.u + (row / 2) * rows.uvStride;
+    const uint8_t* v = rows.v + (row / 2) * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    
+    int x = 0;
+    for (; x + 32 <= rows.width; x += 32) {
+        __m512i cb, cr;
+        if (rows.uvStep == 1) {
+            cb = _mm512_castsi256_si512(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x / 2))));
+            cr = _mm512_castsi256_si512(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + x / 2))));
+        } else {
+            __m256i uv = load256(u + x);
+            cb = _mm512_castsi256_si512(_mm256_and_si256(uv, _mm256_set1_epi16(0x00FF)));
+            cr = _mm512_castsi256_si512(_mm256_srli_epi16(uv, 8));
+        }
+        storePixels(out + 4 * x, _mm512_cvtepu8_epi16(load256(y + x)),
+                    _mm512_permutexvar_epi16(c.duplicate, cb), _mm512_permutexvar_epi16(c.duplicate, cr), c);
+    }
+    return x;
+}
+
+// 32 output pixels per step from 2x2 luma blocks; chroma maps 1:1
+int halfRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y0 = rows.y + (2 * row) * rows.yStride;
+    const uint8_t* y1 = y0 + rows.yStride;
+    const uint8_t* u = rows.u + row * rows.uvStride;
+    const uint8_t* v = rows.v + row * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    
+    int x = 0;
+    for (; x + 32 <= rows.width; x += 32) {
+        __m512i t = _mm512_avg_epu8(load(y0 + 2 * x), load(y1 + 2 * x));
+        __m512i luma = _mm512_srli_epi16(_mm512_add_epi16(_mm512_maddubs_epi16(t, c.ones8), c.one16), 1);
+        
+        __m512i cb, cr;
+        if (rows.uvStep == 1) {
+            cb = _mm512_cvtepu8_epi16(load256(u + x));
+            cr = _mm512_cvtepu8_epi16(load256(v + x));
+        } else {
+            __m512i uv = load(u + 2 * x);
+            cb = _mm512_and_si512(uv, c.lowBytes);
+            cr = _mm512_srli_epi16(uv, 8);
+        }
+        storePixels(out + 4 * x, luma, cb, cr, c);
+    }
+    return x;
+}
+
+} // namespace
+
+void convertRowsAvx512(const Rows& rows, int begin, int end) {
+    const Constants c(rows.k);
+    for (int row = begin; row < end; ++row) {
+        int done = rows.factor == 1 ? fullRow(rows, row, c) : halfRow(rows, row, c);
+        convertSpanScalar(rows, row, done, rows.width);
+    }
+}
+
+} // namespace yuv
@@ -0,0 +1,124 @@
+// SSE4.1 row kernels for YuvConverter (built with -msse4.1)
+#include "YuvKernels.hpp"
+
+#include <immintrin.h>
+
+namespace yuv {
+
+namespace {
+
+struct Constants {
+    __m128i yOffset, cy, cbu, cgu, cgv, crv;
+    __m128i chromaBias, round, zero, maxByte, alpha, lowBytes, ones8, one16;
+
+    explicit Constants(const Coefficients& k)
+        : yOffset(_mm_set1_epi16(k.yOffset)), cy(_mm_set1_epi16(k.cy))
+        , cbu(_mm_set1_epi16(k.cbu)), cgu(_mm_set1_epi16(k.cgu))
+        , cgv(_mm_set1_epi16(k.cgv)), crv(_mm_set1_epi16(k.crv))
+        , chromaBias(_mm_set1_epi16(128)), round(_mm_set1_epi16(16))
+        , zero(_mm_setzero_si128()), maxByte(_mm_set1_epi16(255))
+        , alpha(_mm_set1_epi16(static_cast<short>(0xFF00))), lowBytes(_mm_set1_epi16(0x00FF))
+        , ones8(_mm_set1_epi8(1)), one16(_mm_set1_epi16(1)) {}
+};
+
+inline __m128i toByte(__m128i q5, const Constants& c) {
+    __m128i value = _mm_srai_epi16(_mm_add_epi16(q5, c.round), 5);
+    return _mm_min_epi16(_mm_max_epi16(value, c.zero), c.maxByte);
+}
+
+// 8 pixels from 16-bit Y, U, V lanes to BGRA
+inline void storePixels(uint8_t* out, __m128i y, __m128i u, __m128i v, const Constants& c) {
+    __m128i luma = _mm_mulhrs_epi16(_mm_slli_epi16(_mm_sub_epi16(y, c.yOffset), 7), c.cy);
+    __m128i cb = _mm_slli_epi16(_mm_sub_epi16(u, c.chromaBias), 7);
+    __m128i cr = _mm_slli_epi16(_mm_sub_epi16(v, c.chromaBias), 7);
+    
+    __m128i b = toByte(_mm_add_epi16(luma, _mm_mulhrs_epi16(cb, c.cbu)), c);
+    __m128i g = toByte(_mm_sub_epi16(_mm_sub_epi16(luma, _mm_mulhrs_epi16(cb, c.cgu)),
+                                     _mm_mulhrs_epi16(cr, c.cgv)), c);
+    __m128i r = toByte(_mm_add_epi16(luma, _mm_mulhrs_epi16(cr, c.crv)), c);
+    
+    __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    __m128i ra = _mm_or_si128(r, c.alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+inline __m128i load(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// 16 output pixels per step at full resolution
+int fullRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y = rows.y + row * rows.yStride;
+    const uint8_t* u = rows.u + (row / 2) * rows.uvStride;
+    const uint8_t* v = rows.v + (row / 2) * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    
+    int x = 0;
+    for (; x + 16 <= rows.width; x += 16) {
+        __m128i luma = load(y + x);
+        __m128i cb, cr;
+        if (rows.uvStep == 1) {
+            cb = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)));
+            cr = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)));
+        } else {
+            __m128i uv = load(u + x);
+            cb = _mm_and_si128(uv, c.lowBytes);
+            cr = _mm_srli_epi16(uv, 8);
+        }
+        storePixels(out + 4 * x, _mm_cvtepu8_epi16(luma),
+                    _mm_unpacklo_epi16(cb, cb), _mm_unpacklo_epi16(cr, cr), c);
+        storePixels(out + 4 * x + 32, _mm_unpackhi_epi8(luma, c.zero),
+                    _mm_unpackhi_epi16(cb, cb), _mm_unpackhi_epi16(cr, cr), c);
+    }
+    return x;
+}
+
+// 16 output pixels per step from 2x2 luma blocks; chroma maps 1:1
+int halfRow(const Rows& rows, int row, const Constants& c) {
+    const uint8_t* y0 = rows.y + (2 * row) * rows.yStride;
+    const uint8_t* y1 = y0 + rows.yStride;
+    const uint8_t* u = rows.u + row * rows.uvStride;
+    const uint8_t* v = rows.v + row * rows.uvStride;
+    uint8_t* out = rows.dst + row * rows.dstStride;
+    
+    int x = 0;
+    for (; x + 16 <= rows.width; x += 16) {
+        __m128i t0 = _mm_avg_epu8(load(y0 + 2 * x), load(y1 + 2 * x));
+        __m128i t1 = _mm_avg_epu8(load(y0 + 2 * x + 16), load(y1 + 2 * x + 16));
+        __m128i lumaLo = _mm_srli_epi16(_mm_add_epi16(_mm_maddubs_epi16(t0, c.ones8), c.one16), 1);
+        __m128i lumaHi = _mm_srli_epi16(_mm_add_epi16(_mm_maddubs_epi16(t1, c.ones8), c.one16), 1);
+        
+        __m128i cbLo, cbHi, crLo, crHi;
+        if (rows.uvStep == 1) {
+            __m128i cb = load(u + x);
+            __m128i cr = load(v + x);
+            cbLo = _mm_cvtepu8_epi16(cb);
+            cbHi = _mm_unpackhi_epi8(cb, c.zero);
+            crLo = _mm_cvtepu8_epi16(cr);
+            crHi = _mm_unpackhi_epi8(cr, c.zero);
+        } else {
+            __m128i uvLo = load(u + 2 * x);
+            __m128i uvHi = load(u + 2 * x + 16);
+            cbLo = _mm_and_si128(uvLo, c.lowBytes);
+            crLo = _mm_srli_epi16(uvLo, 8);
+            cbHi = _mm_and_si128(uvHi, c.lowBytes);
+            crHi = _mm_srli_epi16(uvHi, 8);
+        }
+        storePixels(out + 4 * x, lumaLo, cbLo, crLo, c);
+        storePixels(out + 4 * x + 32, lumaHi, cbHi, crHi, c);
+    }
+    return x;
+}
+
+} // namespace
+
+void convertRowsSse41(const Rows& rows, int begin, int end) {
+    const Constants c(rows.k);
+    for (int row = begin; row < end; ++row) {
+        int done = rows.factor == 1 ? fullRow(rows, row, c) : halfRow(rows, row, c);
+        convertSpanScalar(rows, row, done, rows.width);
+    }
+}
+
+} // namespace yuv
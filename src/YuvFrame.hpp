@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// A decoded picture in the decoder's native 4:2:0 layout.
+// The planes are borrowed from the decoder; owner keeps them alive for as
+// long as any copy of the frame exists, so frames can be queued without
+// copying pixels.
+struct YuvFrame {
+    enum class Layout {
+        I420, // Y plane, then quarter-size U and V planes
+        NV12  // Y plane, then one quarter-size interleaved UV plane
+    };
+
+    enum class Matrix {
+        Bt601, // SD
+        Bt709  // HD and up
+    };
+
+    Layout layout = Layout::I420;
+    Matrix matrix = Matrix::Bt709;
+    int width = 0;
+    int height = 0;
+    bool fullRange = false; // JPEG range (0-255) instead of video range (16-235)
+    const uint8_t* planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    std::shared_ptr<const void> owner;
+
+    bool isNull() const { return planes[0] == nullptr; }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// Internals of YuvConverter shared with the per-instruction-set kernels.
+// The SIMD translation units are built with wider -m flags than the rest of
+// the program, so everything they share is declared here and defined in
+// YuvConverter.cpp (no inline code that could be merged across flag sets).
+namespace yuv {
+
+// Fixed-point conversion constants. Luma and chroma are pre-shifted left by
+// 7 and multiplied with round-to-nearest high halves (pmulhrsw), giving Q5
+// results: out = clamp((sum + 16) >> 5, 0, 255).
+struct Coefficients {
+    int16_t yOffset; // 16 for video range, 0 for full range
+    int16_t cy;      // Luma scale, Q13
+    int16_t cbu;     // Q13 coefficients of U' and V'
+    int16_t cgu;
+    int16_t cgv;
+    int16_t crv;
+};
+
+// One conversion as seen by a row kernel. Plane pointers are already offset
+// to the source rect's origin; rows and widths are in output pixels.
+struct Rows {
+    const uint8_t* y;
+    int yStride;
+    const uint8_t* u;
+    const uint8_t* v;
+    int uvStride;
+    int uvStep; // 1 for I420 planes, 2 for interleaved NV12 (v == u + 1)
+    uint8_t* dst;
+    int dstStride;
+    int width;
+    int factor; // Box downscale: 1, 2, 4 or 8
+    Coefficients k;
+};
+
+// Portable reference; SIMD kernels use it for row tails
+void convertSpanScalar(const Rows& rows, int row, int begin, int end);
+void convertRowsScalar(const Rows& rows, int begin, int end);
+
+// SIMD kernels handle factors 1 and 2
+void convertRowsSse41(const Rows& rows, int begin, int end);
+void convertRowsAvx2(const Rows& rows, int begin, int end);
+void convertRowsAvx512(const Rows& rows, int begin, int end);
+
+} // namespace yuv